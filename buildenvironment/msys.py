@@ -46,10 +46,14 @@ localconf = {
     "clibraries"            : [ "lapack",
                                 "lapacke",
                                 "blas",
-                                "gfortran"
+                                "gfortran",
+                                "z",
+                                "bz2"
     ],
     
-    "cheaders"              : [ "omp.h"
+    "cheaders"              : [ "omp.h",
+                                "zlib.h",
+                                "bzlib.h"
     ],
     
     "cppheaders"            : [ "map",
@@ -326,6 +330,27 @@ if conf.env["withsymbolicmath"] :
     )
 
 
+if "xz" in conf.env["withcompression"] :
+    conf.env.AppendUnique(CPPDEFINES  = ["MACHINELEARNING_COMPRESSION_XZ"])
+    localconf["cheaders"].append("lzma.h")
+    localconf["clibraries"].append("lzma")
+
+if "zstd" in conf.env["withcompression"] :
+    conf.env.AppendUnique(CPPDEFINES  = ["MACHINELEARNING_COMPRESSION_ZSTD"])
+    localconf["cheaders"].append("zstd.h")
+    localconf["clibraries"].append("zstd")
+
+if "lz4" in conf.env["withcompression"] :
+    conf.env.AppendUnique(CPPDEFINES  = ["MACHINELEARNING_COMPRESSION_LZ4"])
+    localconf["cheaders"].append("lz4frame.h")
+    localconf["clibraries"].append("lz4")
+
+if "brotli" in conf.env["withcompression"] :
+    conf.env.AppendUnique(CPPDEFINES  = ["MACHINELEARNING_COMPRESSION_BROTLI"])
+    localconf["cheaders"].append(os.path.join("brotli", "encode.h"))
+    localconf["clibraries"].append("brotlienc")
+
+
 if conf.env["withlogger"] :
     conf.env.AppendUnique(CPPDEFINES  = ["MACHINELEARNING_LOGGER"])
     localconf["cpplibraries"].extend(["boost_thread-mt", "boost_system-mt"])     
@@ -36,8 +36,13 @@ namespace machinelearning {
 }
 
 
+#include "seeding.hpp"
+#include "convergence.hpp"
+#include "observer.hpp"
+
 #include "nonsupervised/clustering.hpp"
 #include "nonsupervised/neuralgas.hpp"
+#include "nonsupervised/online_neuralgas.hpp"
 #include "nonsupervised/relational_neuralgas.hpp"
 #include "nonsupervised/kmeans.hpp"
 #include "nonsupervised/spectralclustering.hpp"
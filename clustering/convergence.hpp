@@ -0,0 +1,343 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+#ifndef __MACHINELEARNING_CLUSTERING_CONVERGENCE_HPP
+#define __MACHINELEARNING_CLUSTERING_CONVERGENCE_HPP
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/storage.hpp>
+
+#include "../errorhandling/exception.hpp"
+
+
+namespace machinelearning { namespace clustering {
+    
+    #ifndef SWIG
+    namespace ublas = boost::numeric::ublas;
+    #endif
+    
+    
+    /** class for the stopping policy of the iterative training. The training stops before the maximum
+     * number of iterations, if one of the enabled criteria holds. The criteria are the maximum
+     * (euclidian) shift of the prototypes, the relative change of the quantization error and the number
+     * of datapoints, that change their prototype. All criteria are disabled by default, so the
+     * training runs all iterations. After training the object holds the number of iterations and
+     * the last values of the criteria
+     **/
+    template<typename T> class convergence
+    {
+        #ifndef SWIG
+        BOOST_STATIC_ASSERT( !boost::is_integral<T>::value );
+        #endif
+        
+        
+        public :
+        
+            convergence( void );
+            void setShift( const T& );
+            void setErrorChange( const T& );
+            void setAssignmentChanges( const std::size_t& );
+            void clear( void );
+            bool isEnabled( void ) const;
+            bool useShift( void ) const;
+            bool useErrorChange( void ) const;
+            bool useAssignmentChanges( void ) const;
+            std::size_t getIterations( void ) const;
+            T getShift( void ) const;
+            T getErrorChange( void ) const;
+            std::size_t getAssignmentChanges( void ) const;
+        
+            #ifndef SWIG
+            void reset( void );
+            bool isConverged( const ublas::matrix<T>&, const ublas::matrix<T>&, const T& = 0, const ublas::indirect_array<>& = ublas::indirect_array<>() );
+            bool isConverged( const ublas::vector<T>&, const T& = 0, const ublas::indirect_array<>& = ublas::indirect_array<>() );
+            #endif
+        
+        
+        private :
+        
+            /** bool for using the prototype shift **/
+            bool m_useshift;
+            /** bool for using the relative change of the quantization error **/
+            bool m_useerror;
+            /** bool for using the number of assignment changes **/
+            bool m_usechanges;
+            /** threshold of the maximum prototype shift **/
+            T m_shiftthreshold;
+            /** threshold of the relative quantization error change **/
+            T m_errorthreshold;
+            /** threshold of the number of assignment changes **/
+            std::size_t m_changesthreshold;
+        
+            /** number of iterations of the last training **/
+            std::size_t m_iterations;
+            /** maximum prototype shift of the last iteration **/
+            T m_shift;
+            /** relative quantization error change of the last iteration **/
+            T m_errorchange;
+            /** number of assignment changes of the last iteration **/
+            std::size_t m_changes;
+            /** quantization error of the previous iteration **/
+            T m_error;
+            /** assignment of the previous iteration **/
+            std::vector<std::size_t> m_assignment;
+        
+    };
+    
+    
+    
+    /** constructor, all criteria are disabled **/
+    template<typename T> inline convergence<T>::convergence( void ) :
+        m_useshift( false ),
+        m_useerror( false ),
+        m_usechanges( false ),
+        m_shiftthreshold( 0 ),
+        m_errorthreshold( 0 ),
+        m_changesthreshold( 0 ),
+        m_iterations( 0 ),
+        m_shift( 0 ),
+        m_errorchange( 0 ),
+        m_changes( 0 ),
+        m_error( 0 ),
+        m_assignment()
+    {}
+    
+    
+    /** enables the stopping, if the maximum prototype shift is less or equal the threshold
+     * @param p_threshold threshold
+     **/
+    template<typename T> inline void convergence<T>::setShift( const T& p_threshold )
+    {
+        if (p_threshold < 0)
+            throw exception::runtime(_("threshold must be greater or equal than zero"), *this);
+        
+        m_useshift       = true;
+        m_shiftthreshold = p_threshold;
+    }
+    
+    
+    /** enables the stopping, if the relative change of the quantization error is
+     * less or equal the threshold
+     * @param p_threshold threshold
+     **/
+    template<typename T> inline void convergence<T>::setErrorChange( const T& p_threshold )
+    {
+        if (p_threshold < 0)
+            throw exception::runtime(_("threshold must be greater or equal than zero"), *this);
+        
+        m_useerror       = true;
+        m_errorthreshold = p_threshold;
+    }
+    
+    
+    /** enables the stopping, if the number of datapoints, that change their prototype,
+     * is less or equal the threshold
+     * @param p_threshold threshold
+     **/
+    template<typename T> inline void convergence<T>::setAssignmentChanges( const std::size_t& p_threshold )
+    {
+        m_usechanges       = true;
+        m_changesthreshold = p_threshold;
+    }
+    
+    
+    /** disables all criteria **/
+    template<typename T> inline void convergence<T>::clear( void )
+    {
+        m_useshift   = false;
+        m_useerror   = false;
+        m_usechanges = false;
+    }
+    
+    
+    /** returns if any criterion is enabled
+     * @return bool
+     **/
+    template<typename T> inline bool convergence<T>::isEnabled( void ) const
+    {
+        return m_useshift || m_useerror || m_usechanges;
+    }
+    
+    
+    /** returns if the previous prototypes must be passed on each iteration, so the
+     * training copies the prototypes only if the shift criterion is enabled
+     * @return bool
+     **/
+    template<typename T> inline bool convergence<T>::useShift( void ) const
+    {
+        return m_useshift;
+    }
+    
+    
+    /** returns if the quantization error must be passed on each iteration
+     * @return bool
+     **/
+    template<typename T> inline bool convergence<T>::useErrorChange( void ) const
+    {
+        return m_useerror;
+    }
+    
+    
+    /** returns if the assignment must be passed on each iteration
+     * @return bool
+     **/
+    template<typename T> inline bool convergence<T>::useAssignmentChanges( void ) const
+    {
+        return m_usechanges;
+    }
+    
+    
+    /** returns the number of iterations of the last training
+     * @return iterations
+     **/
+    template<typename T> inline std::size_t convergence<T>::getIterations( void ) const
+    {
+        return m_iterations;
+    }
+    
+    
+    /** returns the maximum prototype shift of the last iteration
+     * (only set if the criterion is enabled)
+     * @return shift
+     **/
+    template<typename T> inline T convergence<T>::getShift( void ) const
+    {
+        return m_shift;
+    }
+    
+    
+    /** returns the relative change of the quantization error of the last
+     * iteration (only set if the criterion is enabled)
+     * @return relative change
+     **/
+    template<typename T> inline T convergence<T>::getErrorChange( void ) const
+    {
+        return m_errorchange;
+    }
+    
+    
+    /** returns the number of assignment changes of the last iteration
+     * (only set if the criterion is enabled)
+     * @return number of datapoints
+     **/
+    template<typename T> inline std::size_t convergence<T>::getAssignmentChanges( void ) const
+    {
+        return m_changes;
+    }
+    
+    
+    /** resets the values for a new training **/
+    template<typename T> inline void convergence<T>::reset( void )
+    {
+        m_iterations  = 0;
+        m_shift       = 0;
+        m_errorchange = 0;
+        m_changes     = 0;
+        m_error       = 0;
+        m_assignment.clear();
+    }
+    
+    
+    /** is called after each iteration, counts the iteration, determines the criteria
+     * and checks, if the training can be stopped. The first iteration never converges
+     * on the quantization error or assignment criterion, because there are no previous values.
+     * An assignment with another size than the previous one is also handled as the first one
+     * @param p_previous prototypes before the iteration (only used if the criterion is enabled)
+     * @param p_prototypes prototypes after the iteration
+     * @param p_error quantization error (only used if the criterion is enabled)
+     * @param p_assignment index of the nearest prototype of each datapoint (only used if the criterion is enabled)
+     * @return bool if the training can be stopped
+     **/
+    template<typename T> inline bool convergence<T>::isConverged( const ublas::matrix<T>& p_previous, const ublas::matrix<T>& p_prototypes, const T& p_error, const ublas::indirect_array<>& p_assignment )
+    {
+        ublas::vector<T> l_shift( m_useshift ? p_prototypes.size1() : 0 );
+        for(std::size_t i=0; i < l_shift.size(); ++i)
+            l_shift(i) = ublas::norm_2( ublas::row(p_prototypes, i) - ublas::row(p_previous, i) );
+        
+        return isConverged( l_shift, p_error, p_assignment );
+    }
+    
+    
+    /** is called after each iteration like the method with the previous prototypes, but gets the
+     * already calculated shifts of the prototypes, so the training need not copy the prototypes
+     * @param p_shift euclidian shift of each prototype (only used if the criterion is enabled)
+     * @param p_error quantization error (only used if the criterion is enabled)
+     * @param p_assignment index of the nearest prototype of each datapoint (only used if the criterion is enabled)
+     * @return bool if the training can be stopped
+     **/
+    template<typename T> inline bool convergence<T>::isConverged( const ublas::vector<T>& p_shift, const T& p_error, const ublas::indirect_array<>& p_assignment )
+    {
+        const bool l_first = m_iterations == 0;
+        m_iterations++;
+        
+        bool l_converged = false;
+        
+        if (m_useshift) {
+            m_shift = 0;
+            for(std::size_t i=0; i < p_shift.size(); ++i)
+                m_shift = std::max( m_shift, p_shift(i) );
+            
+            l_converged = m_shift <= m_shiftthreshold;
+        }
+        
+        if (m_useerror) {
+            m_errorchange = l_first ? std::numeric_limits<T>::max() : std::fabs(m_error - p_error) / std::max( std::fabs(m_error), std::numeric_limits<T>::epsilon() );
+            m_error       = p_error;
+            l_converged   = l_converged || (m_errorchange <= m_errorthreshold);
+        }
+        
+        if (m_usechanges) {
+            // an assignment of another size (e.g. a new data set) can not be compared, so it is handled like the first one
+            const bool l_firstassignment = l_first || (p_assignment.size() != m_assignment.size());
+            
+            if (l_firstassignment) {
+                m_changes = p_assignment.size();
+                m_assignment.resize( p_assignment.size() );
+            } else {
+                m_changes = 0;
+                for(std::size_t i=0; i < p_assignment.size(); ++i)
+                    if (m_assignment[i] != p_assignment(i))
+                        m_changes++;
+            }
+            
+            for(std::size_t i=0; i < p_assignment.size(); ++i)
+                m_assignment[i] = p_assignment(i);
+            
+            l_converged = l_converged || (!l_firstassignment && (m_changes <= m_changesthreshold));
+        }
+        
+        return l_converged;
+    }
+    
+    
+}}
+#endif
@@ -45,6 +45,8 @@
 %typemap(javaout)               std::size_t machinelearning::clustering::nonsupervised::clustering<double>::getPrototypeCount                                           ";"
 %typemap(javaout)               std::vector<double> machinelearning::clustering::nonsupervised::clustering<double>::getLoggedQuantizationError                          ";"
 %typemap(javaout)               ublas::indirect_array<> machinelearning::clustering::nonsupervised::clustering<double>::use                                             ";"
+%typemap(javaout)               void machinelearning::clustering::nonsupervised::clustering<double>::setConvergence                                                     ";"
+%typemap(javaout)               machinelearning::clustering::convergence<double> machinelearning::clustering::nonsupervised::clustering<double>::getConvergence          ";"
 
 
 %typemap(javaclassmodifiers)    machinelearning::clustering::nonsupervised::patchclustering<double>                                                                     "public interface"
@@ -26,8 +26,11 @@
 
 
 #include <omp.h>
+#include <limits>
+#include <algorithm>
 
 #include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
 #include <boost/numeric/ublas/matrix_sparse.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 
@@ -45,7 +48,14 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     #endif
     
     
-    /** class for calculate (batch) k-means
+    /** class for calculate (batch) k-means. The class supports also a mini-batch / online
+     * training, that updates the prototypes with chunks of data and a learning rate of
+     * 1 / number of assigned datapoints for each prototype, so datasets can be clustered
+     * with bounded memory
+     * @see http://www.eecs.tufts.edu/~dsculley/papers/fastkmeans.pdf
+     * The batch training can be accelerated with the triangle inequality (Hamerly's algorithm),
+     * so only distances of datapoints, that can change their prototype, are calculated
+     * @see http://cs.baylor.edu/~hamerly/papers/sdm_2010.pdf
      * @todo determine best k with variance analyse
      **/
     template<typename T> class kmeans : public clustering<T>
@@ -55,7 +65,13 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             
             kmeans( const distances::distance<T>&, const std::size_t&, const std::size_t& );
             void train( const ublas::matrix<T>&, const std::size_t& );
+            void train( const ublas::matrix<T>&, const std::size_t&, const std::size_t& );
+            void trainbatch( const ublas::matrix<T>& );
+            T getThroughput( void ) const;
+            void setAcceleration( const bool& );
+            bool getAcceleration( void ) const;
             ublas::matrix<T> getPrototypes( void ) const;
+            void setPrototypes( const ublas::matrix<T>& );
             void setLogging( const bool& );
             std::vector< ublas::matrix<T> > getLoggedPrototypes( void ) const;
             bool getLogging( void ) const;
@@ -63,6 +79,11 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             std::size_t getPrototypeCount( void ) const;
             std::vector<T> getLoggedQuantizationError( void ) const;
             ublas::indirect_array<> use( const ublas::matrix<T>& ) const;
+            void setConvergence( const convergence<T>& );
+            convergence<T> getConvergence( void ) const;
+            #ifndef SWIG
+            void setObserver( observer<T>* );
+            #endif
         
             
         private :
@@ -77,8 +98,22 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             std::vector< ublas::matrix<T> > m_logprototypes;
             /** std::vector for quantisation error in each iteration **/
             std::vector<T> m_quantizationerror;
+            /** number of assigned datapoints of each prototype for the mini-batch training **/
+            ublas::vector<std::size_t> m_prototypecounts;
+            /** number of datapoints, that are used by the mini-batch training **/
+            std::size_t m_batchsamples;
+            /** time in seconds of the mini-batch training **/
+            double m_batchtime;
+            /** bool for using the accelerated batch training **/
+            bool m_accelerated;
+            /** stopping criteria of the batch training **/
+            convergence<T> m_convergence;
+            /** observer of the training **/
+            observer<T>* m_observer;
             
             T calculateQuantizationError( const ublas::matrix<T>& ) const;
+            void trainAccelerated( const ublas::matrix<T>&, const std::size_t& );
+            void getNearestBounds( const ublas::vector<T>&, std::size_t&, T&, T& ) const;
         
     };
     
@@ -94,7 +129,13 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         m_prototypes( tools::matrix::random<T>(p_prototypes, p_prototypesize) ),
         m_logging( false ),
         m_logprototypes( std::vector< ublas::matrix<T> >() ),
-        m_quantizationerror( std::vector<T>() )
+        m_quantizationerror( std::vector<T>() ),
+        m_prototypecounts( p_prototypes, 0 ),
+        m_batchsamples( 0 ),
+        m_batchtime( 0 ),
+        m_accelerated( false ),
+        m_convergence(),
+        m_observer( NULL )
     {
         if (p_prototypesize == 0)
             throw exception::runtime(_("prototype size must be greater than zero"), *this);
@@ -113,6 +154,21 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     
     
     
+    /** sets the prototypes (e.g. with a data-driven seeding), the number and the
+     * dimension of the prototypes must not be changed
+     * @param p_prototypes prototype matrix (rows = number of prototypes)
+     **/
+    template<typename T> inline void kmeans<T>::setPrototypes( const ublas::matrix<T>& p_prototypes )
+    {
+        if ((p_prototypes.size1() != m_prototypes.size1()) || (p_prototypes.size2() != m_prototypes.size2()))
+            throw exception::runtime(_("prototype matrix dimensions are not equal"), *this);
+        
+        m_prototypes = p_prototypes;
+        m_prototypecounts.clear();
+    }
+    
+    
+    
     /** enabled logging for training
      * @param p_val bool
      **/
@@ -153,9 +209,39 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     }    
     
     
-    /** train the prototypes
+    /** sets the stopping criteria of the batch training
+     * @param p_convergence convergence object
+     **/
+    template<typename T> inline void kmeans<T>::setConvergence( const convergence<T>& p_convergence )
+    {
+        m_convergence = p_convergence;
+    }
+    
+    
+    /** returns the stopping criteria with the number of iterations
+     * and the values of the last batch training
+     * @return convergence object
+     **/
+    template<typename T> inline convergence<T> kmeans<T>::getConvergence( void ) const
+    {
+        return m_convergence;
+    }
+    
+    
+    /** sets the observer of the training, the observer is not copied,
+     * so it must exist during the training
+     * @param p_observer pointer to the observer (NULL disables observing)
+     **/
+    template<typename T> inline void kmeans<T>::setObserver( observer<T>* p_observer )
+    {
+        m_observer = p_observer;
+    }
+    
+    
+    /** train the prototypes, the training stops before the number of
+     * iterations, if the convergence criteria hold
      * @param p_data data matrix
-     * @param p_iterations number of iterations
+     * @param p_iterations maximum number of iterations
      **/
     template<typename T> inline void kmeans<T>::train( const ublas::matrix<T>& p_data, const std::size_t& p_iterations )
     {
@@ -176,31 +262,31 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         }
         
         
+        m_convergence.reset();
+        
+        if (m_accelerated) {
+            trainAccelerated( p_data, p_iterations );
+            return;
+        }
+        
+        
         // run kmeans       
-        ublas::matrix<T> l_distances( m_prototypes.size1(), p_data.size1() );
         // the matrix for adaption is a sparse matrix, because there are only 0 or 1 values
         ublas::mapped_matrix<T> l_adaptmatrix( m_prototypes.size1(), p_data.size1(), m_prototypes.size1()*p_data.size1() );
         
         for(std::size_t i=0; i < p_iterations; ++i) {
             
-            // calculate for every prototype the distance
-            #pragma omp parallel for shared(l_distances)
-            for(std::size_t n=0; n < m_prototypes.size1(); ++n)
-                ublas::row(l_distances, n)  = m_distance.getDistance( p_data,  ublas::row(m_prototypes, n) );
+            // determine for every datapoint the winner and set the winner to 1
+            // (the sparse matrix is not thread-safe on inserting, so the loop runs serial)
+            const ublas::indirect_array<> l_winner = m_distance.getNearest( p_data, m_prototypes );
             
-            // determine winner and set the winner to 1
-            // iterate over the columns and ranks every column
             l_adaptmatrix.clear();
-            #pragma omp parallel for shared(l_adaptmatrix)
-            for(std::size_t n=0; n < l_distances.size2(); ++n) {
-                ublas::vector<T> l_vec = ublas::column(l_distances, n);
-
-                // set winner
-                l_adaptmatrix(tools::vector::rankIndex( l_vec )(0), n) = static_cast<T>(1);
-            }
+            for(std::size_t n=0; n < l_winner.size(); ++n)
+                l_adaptmatrix(l_winner(n), n) = static_cast<T>(1);
             
             
             // adapt to prototypes and normalize the winner row (row orientated)
+            const ublas::matrix<T> l_previous( m_convergence.useShift() ? m_prototypes : ublas::matrix<T>() );
             m_prototypes = ublas::prod( l_adaptmatrix, p_data );
    
             #pragma omp parallel for
@@ -212,15 +298,290 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             }
             
             
-            // determine quantization error for logging
+            // determine quantization error for logging, observing and convergence check
+            const bool l_observed = m_observer && m_observer->isObserved(i);
+            T l_error = 0;
+            if (m_logging || m_convergence.useErrorChange() || (l_observed && m_observer->useError()))
+                l_error = calculateQuantizationError(p_data);
+            
+            if (m_logging) {
+                m_logprototypes.push_back( m_prototypes );
+                m_quantizationerror.push_back( l_error );
+            }
+            if (l_observed)
+                m_observer->notify( i, m_prototypes, l_error );
+            
+            if (m_convergence.isConverged( l_previous, m_prototypes, l_error, l_winner ))
+                break;
+        }
+    }
+    
+    
+    /** enables the accelerated batch training, that skips distance calculations
+     * with the triangle inequality, so the distance must be a metric
+     * @param p_val bool
+     **/
+    template<typename T> inline void kmeans<T>::setAcceleration( const bool& p_val )
+    {
+        if (p_val && (!m_distance.isMetric()))
+            throw exception::runtime(_("accelerated training can be used with metrics only"), *this);
+        
+        m_accelerated = p_val;
+    }
+    
+    
+    /** returns the status of the accelerated batch training
+     * @return bool
+     **/
+    template<typename T> inline bool kmeans<T>::getAcceleration( void ) const
+    {
+        return m_accelerated;
+    }
+    
+    
+    /** batch training with Hamerly's algorithm. Each datapoint holds an upper bound of
+     * the distance to its prototype and a lower bound of the distance to the second nearest
+     * prototype. Distances are only calculated, if the upper bound is greater than the lower
+     * bound and the half distance of the prototype to its nearest other prototype. The
+     * prototypes are calculated with the sums of the assigned datapoints, which are
+     * changed only for datapoints, that change their prototype
+     * @param p_data data matrix
+     * @param p_iterations number of iterations
+     **/
+    template<typename T> inline void kmeans<T>::trainAccelerated( const ublas::matrix<T>& p_data, const std::size_t& p_iterations )
+    {
+        std::vector<std::size_t> l_assign( p_data.size1() );
+        ublas::vector<T> l_upper( p_data.size1() );
+        ublas::vector<T> l_lower( p_data.size1() );
+        
+        // initial assignment, the bounds are calculated with the exact distance, because the
+        // pairwise distance (GEMM identity) can suffer from cancellation, so the bounds can be wrong
+        #pragma omp parallel for shared(l_assign, l_upper, l_lower)
+        for(std::size_t n=0; n < p_data.size1(); ++n)
+            getNearestBounds( m_distance.getDistance( m_prototypes, ublas::row(p_data, n) ), l_assign[n], l_upper(n), l_lower(n) );
+        
+        // sums and number of the datapoints of each prototype
+        ublas::matrix<T> l_sum( m_prototypes.size1(), m_prototypes.size2(), static_cast<T>(0) );
+        ublas::vector<std::size_t> l_count( m_prototypes.size1(), 0 );
+        for(std::size_t i=0; i < p_data.size1(); ++i) {
+            ublas::row(l_sum, l_assign[i]) += ublas::row(p_data, i);
+            l_count(l_assign[i])++;
+        }
+        
+        
+        std::vector<std::size_t> l_previous( p_data.size1() );
+        ublas::vector<T> l_half( m_prototypes.size1() );
+        ublas::vector<T> l_move( m_prototypes.size1() );
+        ublas::vector<T> l_shift( m_convergence.useShift() ? m_prototypes.size1() : 0 );
+        
+        for(std::size_t i=0; i < p_iterations; ++i) {
+            
+            // the first assignment is calculated on initialization
+            if (i > 0) {
+                
+                // half distance of each prototype to its nearest other prototype, calculated with the
+                // exact distance, because the pairwise distance can suffer from cancellation
+                #pragma omp parallel for shared(l_half)
+                for(std::size_t n=0; n < l_half.size(); ++n) {
+                    const ublas::vector<T> l_prototypedistance = m_distance.getDistance( m_prototypes, ublas::row(m_prototypes, n) );
+                    
+                    l_half(n) = std::numeric_limits<T>::max();
+                    for(std::size_t j=0; j < l_prototypedistance.size(); ++j)
+                        if (j != n)
+                            l_half(n) = std::min( l_half(n), static_cast<T>(0.5) * l_prototypedistance(j) );
+                }
+                
+                l_previous = l_assign;
+                
+                #pragma omp parallel for shared(l_assign, l_upper, l_lower, l_half)
+                for(std::size_t n=0; n < p_data.size1(); ++n) {
+                    const T l_bound = std::max( l_half(l_assign[n]), l_lower(n) );
+                    if (l_upper(n) <= l_bound)
+                        continue;
+                    
+                    // tighten the upper bound and check again
+                    l_upper(n) = m_distance.getDistance( ublas::row(p_data, n), ublas::row(m_prototypes, l_assign[n]) );
+                    if (l_upper(n) <= l_bound)
+                        continue;
+                    
+                    getNearestBounds( m_distance.getDistance( m_prototypes, ublas::row(p_data, n) ), l_assign[n], l_upper(n), l_lower(n) );
+                }
+                
+                // change the sums for datapoints, that change their prototype
+                for(std::size_t n=0; n < p_data.size1(); ++n)
+                    if (l_previous[n] != l_assign[n]) {
+                        ublas::row(l_sum, l_previous[n]) -= ublas::row(p_data, n);
+                        ublas::row(l_sum, l_assign[n])   += ublas::row(p_data, n);
+                        l_count(l_previous[n])--;
+                        l_count(l_assign[n])++;
+                    }
+            }
+            
+            
+            // move the prototypes to the mean of their datapoints and determine the moving distance
+            // (prototypes without datapoints are set to zero like in the training without acceleration),
+            // the euclidian shift for the convergence check is only calculated if it is used
+            #pragma omp parallel for shared(l_move, l_shift)
+            for(std::size_t n=0; n < m_prototypes.size1(); ++n) {
+                const ublas::vector<T> l_prototype = (l_count(n) == 0) ? ublas::vector<T>( ublas::zero_vector<T>(m_prototypes.size2()) ) : ublas::vector<T>( ublas::row(l_sum, n) / static_cast<T>(l_count(n)) );
+                
+                l_move(n) = m_distance.getDistance( l_prototype, ublas::row(m_prototypes, n) );
+                if (!l_shift.empty())
+                    l_shift(n) = ublas::norm_2( l_prototype - ublas::row(m_prototypes, n) );
+                ublas::row(m_prototypes, n) = l_prototype;
+            }
+            
+            // correct the bounds with the moving distances (the lower bound is
+            // decreased by the largest movement of all other prototypes)
+            std::size_t l_maxmove = 0;
+            T l_secondmove        = 0;
+            for(std::size_t n=1; n < l_move.size(); ++n)
+                if (l_move(n) > l_move(l_maxmove)) {
+                    l_secondmove = l_move(l_maxmove);
+                    l_maxmove    = n;
+                } else
+                    l_secondmove = std::max( l_secondmove, l_move(n) );
+            
+            #pragma omp parallel for shared(l_upper, l_lower)
+            for(std::size_t n=0; n < p_data.size1(); ++n) {
+                l_upper(n) += l_move(l_assign[n]);
+                l_lower(n) -= (l_assign[n] == l_maxmove) ? l_secondmove : l_move(l_maxmove);
+            }
+            
+            
+            // determine quantization error for logging, observing and convergence check
+            const bool l_observed = m_observer && m_observer->isObserved(i);
+            T l_error = 0;
+            if (m_logging || m_convergence.useErrorChange() || (l_observed && m_observer->useError()))
+                l_error = calculateQuantizationError(p_data);
+            
             if (m_logging) {
                 m_logprototypes.push_back( m_prototypes );
-                m_quantizationerror.push_back( calculateQuantizationError(p_data) );
-            }            
+                m_quantizationerror.push_back( l_error );
+            }
+            if (l_observed)
+                m_observer->notify( i, m_prototypes, l_error );
+            
+            if (m_convergence.isConverged( l_shift, l_error, m_convergence.useAssignmentChanges() ? tools::vector::toIndirectArray(l_assign) : ublas::indirect_array<>() ))
+                break;
         }
     }
     
     
+    /** determines the nearest prototype of a distance vector and sets the
+     * bounds to the nearest and second nearest distance
+     * @param p_distances distances to all prototypes
+     * @param p_idx index of the nearest prototype
+     * @param p_upper distance to the nearest prototype
+     * @param p_lower distance to the second nearest prototype
+     **/
+    template<typename T> inline void kmeans<T>::getNearestBounds( const ublas::vector<T>& p_distances, std::size_t& p_idx, T& p_upper, T& p_lower ) const
+    {
+        p_idx   = tools::vector::argmin( p_distances );
+        p_upper = p_distances(p_idx);
+        p_lower = std::numeric_limits<T>::max();
+        
+        for(std::size_t i=0; i < p_distances.size(); ++i)
+            if (i != p_idx)
+                p_lower = std::min( p_lower, p_distances(i) );
+    }
+    
+    
+    /** train the prototypes with mini-batches, that are sampled from the data. The per-prototype
+     * counts are reset, so each call runs a new mini-batch training
+     * @param p_data data matrix
+     * @param p_iterations number of iterations
+     * @param p_batchsize number of datapoints of each batch
+     **/
+    template<typename T> inline void kmeans<T>::train( const ublas::matrix<T>& p_data, const std::size_t& p_iterations, const std::size_t& p_batchsize )
+    {
+        if (p_iterations == 0)
+            throw exception::runtime(_("iterations must be greater than zero"), *this);
+        if (p_batchsize == 0)
+            throw exception::runtime(_("batch size must be greater than zero"), *this);
+        if (p_data.size2() != m_prototypes.size2())
+            throw exception::runtime(_("data and prototype dimension are not equal"), *this);
+        if (p_data.size1() < m_prototypes.size1())
+            throw exception::runtime(_("number of datapoints are less than prototypes"), *this);
+        
+        // creates logging
+        if (m_logging) {
+            m_logprototypes.clear();
+            m_quantizationerror.clear();
+            m_logprototypes.reserve(p_iterations);
+            m_quantizationerror.reserve(p_iterations);
+        }
+        
+        m_prototypecounts.clear();
+        m_batchsamples = 0;
+        m_batchtime    = 0;
+        
+        
+        tools::random l_rand;
+        ublas::matrix<T> l_batch( std::min(p_batchsize, p_data.size1()), p_data.size2() );
+        
+        for(std::size_t i=0; i < p_iterations; ++i) {
+            
+            // sample the batch from the data
+            for(std::size_t n=0; n < l_batch.size1(); ++n)
+                ublas::row(l_batch, n) = ublas::row(p_data, std::min( static_cast<std::size_t>(l_rand.get<T>( tools::random::uniform, 0, p_data.size1() )), p_data.size1()-1 ));
+            
+            trainbatch( l_batch );
+        }
+    }
+    
+    
+    /** updates the prototypes with one chunk of data (mini-batch / online step). The
+     * per-prototype counts are held between the calls, so the data can be streamed chunk
+     * by chunk (e.g. from a CSV or HDF file). On logging the quantization error is
+     * calculated on the chunk
+     * @param p_data data chunk
+     **/
+    template<typename T> inline void kmeans<T>::trainbatch( const ublas::matrix<T>& p_data )
+    {
+        if (p_data.size2() != m_prototypes.size2())
+            throw exception::runtime(_("data and prototype dimension are not equal"), *this);
+        if (p_data.size1() == 0)
+            return;
+        
+        const double l_start = omp_get_wtime();
+        
+        // determine the winners with the prototypes before the update (cached assignments)
+        const ublas::indirect_array<> l_winner = m_distance.getNearest( p_data, m_prototypes );
+        
+        // move the winner prototype to the datapoint with the per-prototype learning rate
+        for(std::size_t n=0; n < l_winner.size(); ++n) {
+            const std::size_t l_idx = l_winner(n);
+            m_prototypecounts(l_idx)++;
+            
+            const T l_rate = static_cast<T>(1) / static_cast<T>(m_prototypecounts(l_idx));
+            ublas::row(m_prototypes, l_idx) += l_rate * (ublas::row(p_data, n) - ublas::row(m_prototypes, l_idx));
+        }
+        
+        m_batchtime    += omp_get_wtime() - l_start;
+        m_batchsamples += p_data.size1();
+        
+        
+        // determine quantization error for logging
+        if (m_logging) {
+            m_logprototypes.push_back( m_prototypes );
+            m_quantizationerror.push_back( calculateQuantizationError(p_data) );
+        }
+    }
+    
+    
+    /** returns the throughput of the mini-batch training
+     * @return number of datapoints per second
+     **/
+    template<typename T> inline T kmeans<T>::getThroughput( void ) const
+    {
+        if (tools::function::isNumericalZero(m_batchtime))
+            return 0;
+        
+        return static_cast<T>( static_cast<double>(m_batchsamples) / m_batchtime );
+    }
+    
+    
     /** returns the dimension of prototypes
      * @return dimension of the prototypes
      **/
@@ -245,12 +606,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
      **/    
     template<typename T> inline T kmeans<T>::calculateQuantizationError( const ublas::matrix<T>& p_data ) const
     {
-        ublas::matrix<T> l_distances( m_prototypes.size1(), p_data.size1() );
-        
-        #pragma omp parallel for
-        for(std::size_t i=0; i < m_prototypes.size1(); ++i)
-            ublas::row(l_distances, i) = m_distance.getDistance( p_data, ublas::row(m_prototypes, i) );
-        
+        const ublas::matrix<T> l_distances = m_distance.getPairwiseDistance( m_prototypes, p_data );
         return 0.5 * ublas::sum(  m_distance.getAbs(tools::matrix::min(l_distances, tools::matrix::column))  );  
     }
     
@@ -265,24 +621,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         if (p_data.size1() < m_prototypes.size1())
             throw exception::runtime(_("number of datapoints are less than prototypes"), *this);        
         
-        ublas::indirect_array<> l_idx(p_data.size1());
-        ublas::matrix<T> l_distance(m_prototypes.size1(), p_data.size1());
-        
-        // calculate distance for every prototype
-        #pragma omp parallel for shared(l_distance)
-        for(std::size_t i=0; i < m_prototypes.size1(); ++i)
-            ublas::row(l_distance, i)  = m_distance.getDistance( p_data, ublas::row(m_prototypes, i) );
-        
-        // determine nearest prototype
-        #pragma omp parallel for shared(l_distance, l_idx)
-        for(std::size_t i=0; i < l_distance.size2(); ++i) {
-            ublas::vector<T> l_col                = ublas::column(l_distance, i);
-            const ublas::indirect_array<> l_rank  = tools::vector::rankIndex( l_col );
-            l_idx[i] = l_rank(0);
-        }
-        
-        return l_idx;
-        
+        return m_distance.getNearest( p_data, m_prototypes );
     }
 
     
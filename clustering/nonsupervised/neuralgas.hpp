@@ -28,8 +28,11 @@
 
 #include <omp.h>
 
+#include <cmath>
 #include <numeric>
+#include <algorithm>
 #include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/bindings/blas.hpp>
 #ifdef MACHINELEARNING_MPI
@@ -58,6 +61,12 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
      * data, so it is the task of the developer to use the correct ranges. Also the MPI
      * methods must be called in the correct order, so the MPI calls must be run
      * on each process.
+     * @note The non-MPI training stops before the number of iterations, if the
+     * criteria of the convergence object hold
+     * @note The batch training can be truncated, so each datapoint adapts only the k nearest
+     * prototypes, whose adaption value exp(-rank/lambda) is not less than a tolerance. The
+     * updates are accumulated directly over blocks of datapoints, so the dense
+     * prototypes x datapoints adaption matrix is not needed
      **/
     template<typename T> class neuralgas : public clustering<T>, public patchclustering<T>
         #ifdef MACHINELEARNING_MPI 
@@ -71,6 +80,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             void train( const ublas::matrix<T>&, const std::size_t& );
             void train( const ublas::matrix<T>&, const std::size_t&, const T& );
             ublas::matrix<T> getPrototypes( void ) const;
+            void setPrototypes( const ublas::matrix<T>& );
             void setLogging( const bool& );
             std::vector< ublas::matrix<T> > getLoggedPrototypes( void ) const;
             bool getLogging( void ) const;
@@ -78,6 +88,13 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             std::size_t getPrototypeCount( void ) const;
             std::vector<T> getLoggedQuantizationError( void ) const;
             ublas::indirect_array<> use( const ublas::matrix<T>& ) const;
+            void setConvergence( const convergence<T>& );
+            convergence<T> getConvergence( void ) const;
+            #ifndef SWIG
+            void setObserver( observer<T>* );
+            #endif
+            void setTruncation( const T& );
+            T getTruncation( void ) const;
         
             // derived from patch clustering
             ublas::vector<T> getPrototypeWeights( void ) const;
@@ -121,8 +138,15 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             std::vector< ublas::vector<T> > m_logprototypeWeights;
             /** bool for check initialized patch **/
             bool m_firstpatch;
+            /** stopping criteria of the training **/
+            convergence<T> m_convergence;
+            /** observer of the training **/
+            observer<T>* m_observer;
+            /** tolerance of the adaption values for the truncated training (zero disables) **/
+            T m_truncation;
             
             T calculateQuantizationError( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+            void trainTruncated( const ublas::matrix<T>&, const std::size_t&, const T& );
             
             #ifdef MACHINELEARNING_MPI
             /** map with information to every process and prototype**/
@@ -151,7 +175,10 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         m_quantizationerror( std::vector<T>() ),
         m_prototypeWeights( p_prototypes, 0 ),
         m_logprototypeWeights(),
-        m_firstpatch(true)
+        m_firstpatch(true),
+        m_convergence(),
+        m_observer( NULL ),
+        m_truncation( 0 )
         #ifdef MACHINELEARNING_MPI
         , m_processprototypinfo()
         #endif
@@ -171,6 +198,20 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     
     
     
+    /** sets the prototypes (e.g. with a data-driven seeding), the number and the
+     * dimension of the prototypes must not be changed
+     * @param p_prototypes prototype matrix (rows = number of prototypes)
+     **/
+    template<typename T> inline void neuralgas<T>::setPrototypes( const ublas::matrix<T>& p_prototypes )
+    {
+        if ((p_prototypes.size1() != m_prototypes.size1()) || (p_prototypes.size2() != m_prototypes.size2()))
+            throw exception::runtime(_("prototype matrix dimensions are not equal"), *this);
+        
+        m_prototypes = p_prototypes;
+    }
+    
+    
+    
     /** enabled logging for training
      * @param p_log bool
      **/
@@ -230,6 +271,57 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     }    
     
     
+    /** sets the stopping criteria of the training
+     * @param p_convergence convergence object
+     **/
+    template<typename T> inline void neuralgas<T>::setConvergence( const convergence<T>& p_convergence )
+    {
+        m_convergence = p_convergence;
+    }
+    
+    
+    /** returns the stopping criteria with the number of iterations
+     * and the values of the last training
+     * @return convergence object
+     **/
+    template<typename T> inline convergence<T> neuralgas<T>::getConvergence( void ) const
+    {
+        return m_convergence;
+    }
+    
+    
+    /** sets the observer of the training, the observer is not copied,
+     * so it must exist during the training
+     * @param p_observer pointer to the observer (NULL disables observing)
+     **/
+    template<typename T> inline void neuralgas<T>::setObserver( observer<T>* p_observer )
+    {
+        m_observer = p_observer;
+    }
+    
+    
+    /** sets the tolerance of the truncated batch training, each datapoint adapts only
+     * the prototypes, whose adaption value is not less than the tolerance
+     * @param p_tolerance tolerance in [0,1), zero disables the truncation
+     **/
+    template<typename T> inline void neuralgas<T>::setTruncation( const T& p_tolerance )
+    {
+        if ((p_tolerance < 0) || (p_tolerance >= 1))
+            throw exception::runtime(_("tolerance must be in [0,1)"), *this);
+        
+        m_truncation = p_tolerance;
+    }
+    
+    
+    /** returns the tolerance of the truncated batch training
+     * @return tolerance (zero on disabled truncation)
+     **/
+    template<typename T> inline T neuralgas<T>::getTruncation( void ) const
+    {
+        return m_truncation;
+    }
+    
+    
     /** train the prototypes
      * @param p_data data matrix
      * @param p_iterations number of iterations
@@ -282,22 +374,21 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             m_logprototypes.reserve(p_iterations);
             m_quantizationerror.reserve(p_iterations);
         }
+        
+        if (!tools::function::isNumericalZero(m_truncation)) {
+            trainTruncated( p_data, p_iterations, p_lambda );
+            return;
+        }
 
         
         // run neural gas       
         const T l_multi = 0.01/p_lambda;
         ublas::matrix<T> l_adaptmatrix( m_prototypes.size1(), p_data.size1() );
         ublas::vector<T> l_lambda(m_prototypes.size1());
+        m_convergence.reset();
         
         for(std::size_t i=0; i < p_iterations; ++i) {
             
-            // determine quantization error for logging
-            if (m_logging) {
-                m_logprototypes.push_back( m_prototypes );
-                m_quantizationerror.push_back( calculateQuantizationError(p_data, m_prototypes) );
-            }
-            
-            
             // create adapt values
             const T l_lambdahelp = p_lambda * std::pow(l_multi, static_cast<T>(i)/static_cast<T>(p_iterations));
 
@@ -307,9 +398,20 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
 
                                 
             // calculate for every prototype the distance
-            #pragma omp parallel for shared(l_adaptmatrix)
-            for(std::size_t n=0; n < m_prototypes.size1(); ++n)
-                ublas::row(l_adaptmatrix, n)  = m_distance.getDistance( p_data, ublas::row(m_prototypes, n) );
+            l_adaptmatrix = m_distance.getPairwiseDistance( m_prototypes, p_data );
+            
+            // determine quantization error of the current prototypes with the distances
+            // for logging and the convergence check
+            T l_error = 0;
+            if (m_logging || m_convergence.useErrorChange())
+                l_error = 0.5 * ublas::sum( m_distance.getAbs(tools::matrix::min(l_adaptmatrix, tools::matrix::column)) );
+            
+            if (m_logging) {
+                m_logprototypes.push_back( m_prototypes );
+                m_quantizationerror.push_back( l_error );
+            }
+            
+            const ublas::indirect_array<> l_winner = m_convergence.useAssignmentChanges() ? tools::matrix::argmin(l_adaptmatrix, tools::matrix::column) : ublas::indirect_array<>();
 
             
             // for every column ranks values and create adapts
@@ -328,6 +430,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             
 
             // create prototypes
+            const ublas::matrix<T> l_previous( m_convergence.useShift() ? m_prototypes : ublas::matrix<T>() );
             m_prototypes = ublas::prod( l_adaptmatrix, p_data );
             
             // normalize prototypes
@@ -338,6 +441,129 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
                 if (!tools::function::isNumericalZero(l_norm))
                     ublas::row(m_prototypes, n) /= l_norm;
             }
+            
+            // observing of the updated prototypes, so their quantization error is calculated on observed iterations only
+            if (m_observer && m_observer->isObserved(i))
+                m_observer->notify( i, m_prototypes, m_observer->useError() ? calculateQuantizationError(p_data, m_prototypes) : static_cast<T>(0) );
+            
+            if (m_convergence.isConverged( l_previous, m_prototypes, l_error, l_winner ))
+                break;
+        }
+    }
+    
+    
+    /** truncated batch training. For each datapoint only the k nearest prototypes are
+     * determined (partial ranking), k is the number of ranks, whose adaption value
+     * exp(-rank/lambda) is not less than the tolerance. The weighted datapoints are
+     * summed for each prototype, so only a block of distances is held in memory.
+     * Prototypes without any adaption are not moved
+     * @param p_data datapoints
+     * @param p_iterations iterations
+     * @param p_lambda max adapet size
+     **/
+    template<typename T> inline void neuralgas<T>::trainTruncated( const ublas::matrix<T>& p_data, const std::size_t& p_iterations, const T& p_lambda )
+    {
+        const T l_multi               = 0.01/p_lambda;
+        const std::size_t l_blocksize = 4096;
+        ublas::vector<T> l_lambda(m_prototypes.size1());
+        ublas::matrix<T> l_sum( m_prototypes.size1(), m_prototypes.size2() );
+        ublas::vector<T> l_weight( m_prototypes.size1() );
+        std::vector<std::size_t> l_assign( m_convergence.useAssignmentChanges() ? p_data.size1() : 0 );
+        
+        // different datapoints adapt the same prototype, so every thread sums into its own matrix,
+        // which is allocated once and cleared after it is added to the sum of the block
+        std::vector< ublas::matrix<T> > l_threadsum( omp_get_max_threads(), ublas::matrix<T>(l_sum.size1(), l_sum.size2(), static_cast<T>(0)) );
+        std::vector< ublas::vector<T> > l_threadweight( omp_get_max_threads(), ublas::vector<T>(l_weight.size(), static_cast<T>(0)) );
+        
+        m_convergence.reset();
+        
+        for(std::size_t i=0; i < p_iterations; ++i) {
+            
+            // create adapt values and the number of ranks, that are not truncated
+            const T l_lambdahelp = p_lambda * std::pow(l_multi, static_cast<T>(i)/static_cast<T>(p_iterations));
+            const std::size_t l_k = std::min( m_prototypes.size1(), static_cast<std::size_t>(std::floor( -l_lambdahelp * std::log(m_truncation) )) + 1 );
+            
+            #pragma omp parallel for shared(l_lambda)
+            for(std::size_t n=0; n < l_lambda.size(); ++n)
+                l_lambda(n) = std::exp( -static_cast<T>(n) / l_lambdahelp );
+            
+            
+            l_sum.clear();
+            l_weight.clear();
+            T l_error = 0;
+            
+            for(std::size_t n=0; n < p_data.size1(); n += l_blocksize) {
+                const ublas::matrix<T> l_block     = ublas::subrange( p_data, n, std::min(n+l_blocksize, p_data.size1()), 0, p_data.size2() );
+                const ublas::matrix<T> l_distances = m_distance.getPairwiseDistance( l_block, m_prototypes );
+                
+                // determine the k nearest prototypes of each datapoint
+                ublas::matrix<std::size_t> l_neighbour( l_distances.size1(), l_k );
+                
+                #pragma omp parallel for shared(l_neighbour)
+                for(std::size_t j=0; j < l_distances.size1(); ++j) {
+                    ublas::vector<T> l_row               = ublas::row(l_distances, j);
+                    const ublas::indirect_array<> l_rank = tools::vector::rankIndex(l_row, l_k);
+                    
+                    for(std::size_t r=0; r < l_k; ++r)
+                        l_neighbour(j, r) = l_rank(r);
+                }
+                
+                // sum the weighted datapoints into the matrix of the thread, the sums are added at the end
+                ublas::vector<T> l_nearest( l_neighbour.size1() );
+                
+                #pragma omp parallel shared(l_sum, l_weight, l_nearest, l_assign, l_threadsum, l_threadweight)
+                {
+                    ublas::matrix<T>& l_ownsum    = l_threadsum[omp_get_thread_num()];
+                    ublas::vector<T>& l_ownweight = l_threadweight[omp_get_thread_num()];
+                    
+                    #pragma omp for
+                    for(std::size_t j=0; j < l_neighbour.size1(); ++j) {
+                        for(std::size_t r=0; r < l_k; ++r) {
+                            ublas::row(l_ownsum, l_neighbour(j, r)) += l_lambda(r) * ublas::row(l_block, j);
+                            l_ownweight(l_neighbour(j, r))          += l_lambda(r);
+                        }
+                        
+                        l_nearest(j) = l_distances(j, l_neighbour(j, 0));
+                        if (!l_assign.empty())
+                            l_assign[n+j] = l_neighbour(j, 0);
+                    }
+                    
+                    #pragma omp critical
+                    {
+                        l_sum    += l_ownsum;
+                        l_weight += l_ownweight;
+                    }
+                    
+                    l_ownsum.clear();
+                    l_ownweight.clear();
+                }
+                
+                l_error += ublas::sum( m_distance.getAbs(l_nearest) );
+            }
+            l_error *= 0.5;
+            
+            
+            // logging of the current prototypes
+            if (m_logging) {
+                m_logprototypes.push_back( m_prototypes );
+                m_quantizationerror.push_back( l_error );
+            }
+            
+            
+            // create and normalize prototypes
+            const ublas::matrix<T> l_previous( m_convergence.useShift() ? m_prototypes : ublas::matrix<T>() );
+            
+            #pragma omp parallel for
+            for(std::size_t n=0; n < m_prototypes.size1(); ++n)
+                if (!tools::function::isNumericalZero(l_weight(n)))
+                    ublas::row(m_prototypes, n) = ublas::row(l_sum, n) / l_weight(n);
+            
+            // observing of the updated prototypes, so their quantization error is calculated on observed iterations only
+            if (m_observer && m_observer->isObserved(i))
+                m_observer->notify( i, m_prototypes, m_observer->useError() ? calculateQuantizationError(p_data, m_prototypes) : static_cast<T>(0) );
+            
+            if (m_convergence.isConverged( l_previous, m_prototypes, l_error, l_assign.empty() ? ublas::indirect_array<>() : tools::vector::toIndirectArray(l_assign) ))
+                break;
         }
     }
     
@@ -349,12 +575,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
      **/    
     template<typename T> inline T neuralgas<T>::calculateQuantizationError( const ublas::matrix<T>& p_data, const ublas::matrix<T>& p_prototypes ) const
     {
-        ublas::matrix<T> l_distances( p_prototypes.size1(), p_data.size1() );
-        
-        #pragma omp parallel for shared(l_distances)
-        for(std::size_t i=0; i < p_prototypes.size1(); ++i)
-            ublas::row(l_distances, i) = m_distance.getDistance( p_data, ublas::row(p_prototypes, i) );
-        
+        const ublas::matrix<T> l_distances = m_distance.getPairwiseDistance( p_prototypes, p_data );
         return 0.5 * ublas::sum(  m_distance.getAbs(tools::matrix::min(l_distances, tools::matrix::column))  );  
     }
     
@@ -371,23 +592,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         if (p_data.size2() != m_prototypes.size2())
             throw exception::runtime(_("data and prototype dimension are not equal"), *this);
         
-        ublas::indirect_array<> l_idx(p_data.size1());
-        ublas::matrix<T> l_distance(m_prototypes.size1(), p_data.size1());
-        
-        // calculate distance for every prototype
-        #pragma omp parallel for shared(l_distance)
-        for(std::size_t i=0; i < m_prototypes.size1(); ++i)
-            ublas::row(l_distance, i)  = m_distance.getDistance( p_data,  ublas::row(m_prototypes, i) );
-        
-        // determine nearest prototype
-        #pragma omp parallel for shared(l_idx)
-        for(std::size_t i=0; i < l_distance.size2(); ++i) {
-            ublas::vector<T> l_col                = ublas::column(l_distance, i);
-            const ublas::indirect_array<> l_rank  = tools::vector::rankIndex( l_col );
-            l_idx[i] = l_rank(0);
-         }
-        
-        return l_idx;
+        return m_distance.getNearest( p_data, m_prototypes );
     }
   
     
@@ -451,16 +656,10 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         const T l_multi = 0.01/p_lambda;
         ublas::matrix<T> l_adaptmatrix( m_prototypes.size1(), p_data.size1() );
         ublas::vector<T> l_lambda(m_prototypes.size1());
+        m_convergence.reset();
         
         for(std::size_t i=0; i < p_iterations; ++i) {
             
-            // determine quantization error for logging
-            if (m_logging) {
-                m_logprototypes.push_back( m_prototypes );
-                m_quantizationerror.push_back( calculateQuantizationError(l_data, m_prototypes) );
-            }
-            
-            
             // create adapt values
             const T l_lambdahelp = p_lambda * std::pow(l_multi, static_cast<T>(i)/static_cast<T>(p_iterations));
             
@@ -470,9 +669,20 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             
             
             // calculate for every prototype the distance
-            #pragma omp parallel for shared(l_adaptmatrix)
-            for(std::size_t n=0; n < m_prototypes.size1(); ++n)
-                ublas::row(l_adaptmatrix, n)  = m_distance.getDistance( l_data, ublas::row(m_prototypes, n) ) ;
+            l_adaptmatrix = m_distance.getPairwiseDistance( m_prototypes, l_data );
+            
+            // determine quantization error of the current prototypes with the distances
+            // for logging and the convergence check
+            T l_error = 0;
+            if (m_logging || m_convergence.useErrorChange())
+                l_error = 0.5 * ublas::sum( m_distance.getAbs(tools::matrix::min(l_adaptmatrix, tools::matrix::column)) );
+            
+            if (m_logging) {
+                m_logprototypes.push_back( m_prototypes );
+                m_quantizationerror.push_back( l_error );
+            }
+            
+            const ublas::indirect_array<> l_winner = m_convergence.useAssignmentChanges() ? tools::matrix::argmin(l_adaptmatrix, tools::matrix::column) : ublas::indirect_array<>();
             
             
             // for every column ranks values and create adapts
@@ -495,6 +705,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
                 ublas::row(l_adaptmatrix, n) = ublas::element_prod( ublas::row(l_adaptmatrix, n), l_multiplier );
             
             // create prototypes
+            const ublas::matrix<T> l_previous( m_convergence.useShift() ? m_prototypes : ublas::matrix<T>() );
             m_prototypes = ublas::prod( l_adaptmatrix, l_data );
             
             
@@ -506,6 +717,13 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
                 if (!tools::function::isNumericalZero(l_norm))
                     ublas::row(m_prototypes, n) /= l_norm;
             }
+            
+            // observing of the updated prototypes, so their quantization error is calculated on observed iterations only
+            if (m_observer && m_observer->isObserved(i))
+                m_observer->notify( i, m_prototypes, m_observer->useError() ? calculateQuantizationError(l_data, m_prototypes) : static_cast<T>(0) );
+            
+            if (m_convergence.isConverged( l_previous, m_prototypes, l_error, l_winner ))
+                break;
         }
         
         // determine size of receptive fields, but we use only the data points
@@ -712,9 +930,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             
             // calculate for every prototype the distance (of the actually prototypes).
             // within the adapt matrix, we must specify the position of the prototypes 
-            #pragma omp parallel for shared(l_adaptmatrix)
-            for(std::size_t n=0; n < l_prototypes.size1(); ++n)
-                ublas::row(l_adaptmatrix, n)  = m_distance.getDistance( p_data, ublas::row(l_prototypes, n) ) ;
+            l_adaptmatrix = m_distance.getPairwiseDistance( l_prototypes, p_data );
             
             
             // for every column ranks values and create adapts
@@ -826,21 +1042,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         //first we gathering all other prototypes
         const ublas::matrix<T> l_prototypes = gatherAllPrototypes( p_mpi );
         
-        ublas::indirect_array<> l_idx(p_data.size1());
-        ublas::matrix<T> l_distance(l_prototypes.size1(), p_data.size1());
-        
-        // calculate distance for every prototype
-        for(std::size_t i=0; i < l_prototypes.size1(); ++i)
-            ublas::row(l_distance, i)  = m_distance.getDistance( p_data, ublas::row(l_prototypes, i) ) ;
-        
-        // determine nearest prototype
-        for(std::size_t i=0; i < l_distance.size2(); ++i) {
-            ublas::vector<T> l_col                = ublas::column(l_distance, i);
-            const ublas::indirect_array<> l_rank  = tools::vector::rankIndex( l_col );
-            l_idx[i] = l_rank(0);
-        }
-        
-        return l_idx;
+        return m_distance.getNearest( p_data, l_prototypes );
     }
     
     
@@ -1033,9 +1235,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             
             
             // calculate for every prototype the distance
-            #pragma omp parallel for shared(l_adaptmatrix)
-            for(std::size_t n=0; n < l_prototypes.size1(); ++n)
-                ublas::row(l_adaptmatrix, n)  = m_distance.getDistance( l_data, ublas::row(l_prototypes, n) ) ;
+            l_adaptmatrix = m_distance.getPairwiseDistance( l_prototypes, l_data );
             
             
             // for every column ranks values and create adapts
@@ -0,0 +1,537 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+#ifndef __MACHINELEARNING_CLUSTERING_NONSUPERVISED_ONLINE_NEURALGAS_HPP
+#define __MACHINELEARNING_CLUSTERING_NONSUPERVISED_ONLINE_NEURALGAS_HPP
+
+
+#include <omp.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <boost/lambda/lambda.hpp>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+#include "clustering.hpp"
+#include "../../errorhandling/exception.hpp"
+#include "../../tools/tools.h"
+#include "../../distances/distances.h"
+
+
+
+namespace machinelearning { namespace clustering { namespace nonsupervised {
+    
+    #ifndef SWIG
+    namespace ublas = boost::numeric::ublas;
+    namespace lam   = boost::lambda;
+    #endif
+    
+    
+    /** class for calculate online (stochastic) neural gas. The prototypes are adapted with
+     * each mini-batch of datapoints (a batch size of one is the classic online neural gas),
+     * the learning rate and the neighborhood range are annealed exponentially over the number
+     * of datapoints of the schedule. The step counter is held between the patches, so data
+     * can be streamed chunk by chunk with trainpatch and only the prototypes and one
+     * mini-batch are held in memory
+     * @see http://www.ks.uiuc.edu/Publications/Papers/PDF/MART93B/MART93B.pdf
+     **/
+    template<typename T> class online_neuralgas : public clustering<T>, public patchclustering<T>
+    {
+        
+        public:
+            
+            online_neuralgas( const distances::distance<T>&, const std::size_t&, const std::size_t& );
+            void train( const ublas::matrix<T>&, const std::size_t& );
+            ublas::matrix<T> getPrototypes( void ) const;
+            void setPrototypes( const ublas::matrix<T>& );
+            void setLogging( const bool& );
+            std::vector< ublas::matrix<T> > getLoggedPrototypes( void ) const;
+            bool getLogging( void ) const;
+            std::size_t getPrototypeSize( void ) const;
+            std::size_t getPrototypeCount( void ) const;
+            std::vector<T> getLoggedQuantizationError( void ) const;
+            ublas::indirect_array<> use( const ublas::matrix<T>& ) const;
+            void setConvergence( const convergence<T>& );
+            convergence<T> getConvergence( void ) const;
+            #ifndef SWIG
+            void setObserver( observer<T>* );
+            #endif
+            void setSchedule( const T&, const T&, const T&, const T&, const std::size_t& = 0 );
+            void setBatchSize( const std::size_t& );
+            std::size_t getSteps( void ) const;
+        
+            // derived from patch clustering
+            ublas::vector<T> getPrototypeWeights( void ) const;
+            void trainpatch( const ublas::matrix<T>&, const std::size_t& );
+            std::vector< ublas::vector<T> > getLoggedPrototypeWeights( void ) const;
+        
+        
+        private :
+        
+            /** distance object **/
+            const distances::distance<T>& m_distance;        
+            /** prototypes **/
+            ublas::matrix<T> m_prototypes;                
+            /** bool for logging prototypes **/
+            bool m_logging;
+            /** std::vector for prototypes for each iteration **/
+            std::vector< ublas::matrix<T> > m_logprototypes;
+            /** std::vector for quantisation error in each iteration **/
+            std::vector<T> m_quantizationerror;
+            /** prototype weights for patch clustering **/
+            ublas::vector<T> m_prototypeWeights;
+            /** std::vector for logging the prototype weights **/
+            std::vector< ublas::vector<T> > m_logprototypeWeights;
+            /** stopping criteria of the training **/
+            convergence<T> m_convergence;
+            /** observer of the training **/
+            observer<T>* m_observer;
+            /** learning rate at the start and the end of the schedule **/
+            T m_ratestart;
+            T m_rateend;
+            /** neighborhood range at the start and the end of the schedule **/
+            T m_lambdastart;
+            T m_lambdaend;
+            /** number of datapoints of the schedule (zero uses the datapoints of the training call) **/
+            std::size_t m_samples;
+            /** number of datapoints of each mini-batch **/
+            std::size_t m_batchsize;
+            /** number of adapted datapoints **/
+            std::size_t m_steps;
+            /** index buffer for the ranking of the prototypes (one segment for each datapoint of the mini-batch) **/
+            std::vector<std::size_t> m_rankindex;
+            
+            void adapt( const ublas::matrix<T>&, const std::size_t& );
+            bool iterationEnd( const ublas::matrix<T>&, const ublas::matrix<T>&, const std::size_t& );
+            T calculateQuantizationError( const ublas::matrix<T>& ) const;
+        
+    };
+    
+    
+    
+    /** contructor for initialization the online neural gas, the default schedule anneals
+     * the learning rate from 0.5 to 0.005 and the neighborhood from half of the number of
+     * prototypes to 0.01
+     * @param p_distance distance object
+     * @param p_prototypes number of prototypes
+     * @param p_prototypesize size of each prototype (data dimension)
+     **/
+    template<typename T> inline online_neuralgas<T>::online_neuralgas( const distances::distance<T>& p_distance, const std::size_t& p_prototypes, const std::size_t& p_prototypesize ) :
+        m_distance( p_distance ),
+        m_prototypes( tools::matrix::random<T>(p_prototypes, p_prototypesize) ),
+        m_logging( false ),
+        m_logprototypes( std::vector< ublas::matrix<T> >() ),
+        m_quantizationerror( std::vector<T>() ),
+        m_prototypeWeights( p_prototypes, 0 ),
+        m_logprototypeWeights(),
+        m_convergence(),
+        m_observer( NULL ),
+        m_ratestart( 0.5 ),
+        m_rateend( 0.005 ),
+        m_lambdastart( p_prototypes * 0.5 ),
+        m_lambdaend( 0.01 ),
+        m_samples( 0 ),
+        m_batchsize( 1 ),
+        m_steps( 0 ),
+        m_rankindex()
+    {
+        if (p_prototypesize == 0)
+            throw exception::runtime(_("prototype size must be greater than zero"), *this);
+        if (p_prototypes == 0)
+            throw exception::runtime(_("number of prototypes must be greater than zero"), *this);
+    }
+    
+    
+    /** returns the prototype matrix
+     * @return matrix (rows = number of prototypes)
+     **/
+    template<typename T> inline ublas::matrix<T> online_neuralgas<T>::getPrototypes( void ) const
+    {
+        return m_prototypes;
+    }
+    
+    
+    /** sets the prototypes (e.g. with a data-driven seeding), the number and the
+     * dimension of the prototypes must not be changed
+     * @param p_prototypes prototype matrix (rows = number of prototypes)
+     **/
+    template<typename T> inline void online_neuralgas<T>::setPrototypes( const ublas::matrix<T>& p_prototypes )
+    {
+        if ((p_prototypes.size1() != m_prototypes.size1()) || (p_prototypes.size2() != m_prototypes.size2()))
+            throw exception::runtime(_("prototype matrix dimensions are not equal"), *this);
+        
+        m_prototypes = p_prototypes;
+    }
+    
+    
+    /** enabled logging for training
+     * @param p_log bool
+     **/
+    template<typename T> inline void online_neuralgas<T>::setLogging( const bool& p_log )
+    {
+        m_logging = p_log;
+        m_logprototypeWeights.clear();
+        m_logprototypes.clear();
+        m_quantizationerror.clear();
+    }
+    
+    
+    /** shows the logging status
+     * @return bool
+     **/
+    template<typename T> inline bool online_neuralgas<T>::getLogging( void ) const
+    {
+        return m_logging && (m_logprototypes.size() > 0);
+    }
+    
+    
+    /** returns every prototype step during training
+     * @return std::vector with prototype matrix
+     **/
+    template<typename T> inline std::vector< ublas::matrix<T> > online_neuralgas<T>::getLoggedPrototypes( void ) const
+    {
+        return m_logprototypes;
+    }
+    
+    
+    /** returns the dimension of prototypes
+     * @return dimension of the prototypes
+     **/
+    template<typename T> inline std::size_t online_neuralgas<T>::getPrototypeSize( void ) const 
+    {
+        return m_prototypes.size2();
+    }
+    
+    
+    /** returns the number of prototypes
+     * @return number of the prototypes / classes
+     **/
+    template<typename T> inline std::size_t online_neuralgas<T>::getPrototypeCount( void ) const 
+    {
+        return m_prototypes.size1();
+    }
+    
+    
+    /** returns the quantisation error 
+     * @return error for each iteration
+     **/
+    template<typename T> inline std::vector<T> online_neuralgas<T>::getLoggedQuantizationError( void ) const
+    {
+        return m_quantizationerror;
+    }
+    
+    
+    /** sets the stopping criteria of the training
+     * @param p_convergence convergence object
+     **/
+    template<typename T> inline void online_neuralgas<T>::setConvergence( const convergence<T>& p_convergence )
+    {
+        m_convergence = p_convergence;
+    }
+    
+    
+    /** returns the stopping criteria with the number of iterations
+     * and the values of the last training
+     * @return convergence object
+     **/
+    template<typename T> inline convergence<T> online_neuralgas<T>::getConvergence( void ) const
+    {
+        return m_convergence;
+    }
+    
+    
+    /** sets the observer of the training, the observer is not copied,
+     * so it must exist during the training
+     * @param p_observer pointer to the observer (NULL disables observing)
+     **/
+    template<typename T> inline void online_neuralgas<T>::setObserver( observer<T>* p_observer )
+    {
+        m_observer = p_observer;
+    }
+    
+    
+    /** sets the schedule of the learning rate and the neighborhood range, both are annealed
+     * with value(t) = start * (end/start)^(t/samples), after the number of datapoints the end
+     * values are used. The step counter is reset
+     * @param p_ratestart learning rate at the start
+     * @param p_rateend learning rate at the end
+     * @param p_lambdastart neighborhood range at the start
+     * @param p_lambdaend neighborhood range at the end
+     * @param p_samples number of datapoints of the schedule, on zero the number of datapoints and iterations
+     * of each train call is used, for streaming with trainpatch the value must be set
+     **/
+    template<typename T> inline void online_neuralgas<T>::setSchedule( const T& p_ratestart, const T& p_rateend, const T& p_lambdastart, const T& p_lambdaend, const std::size_t& p_samples )
+    {
+        if ((p_ratestart <= 0) || (p_rateend <= 0))
+            throw exception::runtime(_("learning rate must be greater than zero"), *this);
+        if ((p_lambdastart <= 0) || (p_lambdaend <= 0))
+            throw exception::runtime(_("lambda must be greater than zero"), *this);
+        
+        m_ratestart   = p_ratestart;
+        m_rateend     = p_rateend;
+        m_lambdastart = p_lambdastart;
+        m_lambdaend   = p_lambdaend;
+        m_samples     = p_samples;
+        m_steps       = 0;
+    }
+    
+    
+    /** sets the number of datapoints of each mini-batch
+     * @param p_batchsize batch size (one is the classic online training)
+     **/
+    template<typename T> inline void online_neuralgas<T>::setBatchSize( const std::size_t& p_batchsize )
+    {
+        if (p_batchsize == 0)
+            throw exception::runtime(_("batch size must be greater than zero"), *this);
+        
+        m_batchsize = p_batchsize;
+    }
+    
+    
+    /** returns the number of adapted datapoints of the schedule
+     * @return number of datapoints
+     **/
+    template<typename T> inline std::size_t online_neuralgas<T>::getSteps( void ) const
+    {
+        return m_steps;
+    }
+    
+    
+    /** returns the weights of prototypes on patch clustering
+     * @return weights vector
+     **/
+    template<typename T> inline ublas::vector<T> online_neuralgas<T>::getPrototypeWeights( void ) const
+    {
+        return m_prototypeWeights;
+    }
+    
+    
+    /** returns the logged prototype weights
+     * @return std::vector with weight vectors
+     **/
+    template<typename T> inline std::vector< ublas::vector<T> > online_neuralgas<T>::getLoggedPrototypeWeights( void ) const
+    {
+        return m_logprototypeWeights;
+    }
+    
+    
+    /** train the prototypes, each iteration adapts the prototypes with mini-batches, that
+     * are sampled from the data, until the number of datapoints is reached. The schedule
+     * restarts on each call
+     * @param p_data data matrix
+     * @param p_iterations number of iterations
+     **/
+    template<typename T> inline void online_neuralgas<T>::train( const ublas::matrix<T>& p_data, const std::size_t& p_iterations )
+    {
+        if (p_iterations == 0)
+            throw exception::runtime(_("iterations must be greater than zero"), *this);
+        if (p_data.size2() != m_prototypes.size2())
+            throw exception::runtime(_("data and prototype dimension are not equal"), *this);
+        if (p_data.size1() < m_prototypes.size1())
+            throw exception::runtime(_("number of datapoints are less than prototypes"), *this);
+        
+        // creates logging
+        if (m_logging) {
+            m_logprototypes.clear();
+            m_quantizationerror.clear();
+            m_logprototypes.reserve(p_iterations);
+            m_quantizationerror.reserve(p_iterations);
+        }
+        
+        m_steps = 0;
+        m_convergence.reset();
+        const std::size_t l_samples = (m_samples == 0) ? p_iterations * p_data.size1() : m_samples;
+        
+        tools::random l_rand;
+        ublas::matrix<T> l_batch( std::min(m_batchsize, p_data.size1()), p_data.size2() );
+        
+        for(std::size_t i=0; i < p_iterations; ++i) {
+            
+            const ublas::matrix<T> l_previous( m_convergence.useShift() ? m_prototypes : ublas::matrix<T>() );
+            
+            for(std::size_t n=0; n < p_data.size1(); n += l_batch.size1()) {
+                
+                // sample the batch from the data
+                for(std::size_t j=0; j < l_batch.size1(); ++j)
+                    ublas::row(l_batch, j) = ublas::row(p_data, std::min( static_cast<std::size_t>(l_rand.get<T>( tools::random::uniform, 0, p_data.size1() )), p_data.size1()-1 ));
+                
+                adapt( l_batch, l_samples );
+            }
+            
+            if (iterationEnd( p_data, l_previous, i ))
+                break;
+        }
+    }
+    
+    
+    /** train a patch (chunk of data), the datapoints are adapted in the order of the patch
+     * and the schedule continues over all patches, so the number of datapoints of the
+     * schedule must be set
+     * @param p_data datapoints
+     * @param p_iterations number of passes over the patch
+     **/
+    template<typename T> inline void online_neuralgas<T>::trainpatch( const ublas::matrix<T>& p_data, const std::size_t& p_iterations )
+    {
+        if (p_iterations == 0)
+            throw exception::runtime(_("iterations must be greater than zero"), *this);
+        if (p_data.size2() != m_prototypes.size2())
+            throw exception::runtime(_("data and prototype dimension are not equal"), *this);
+        if (m_samples == 0)
+            throw exception::runtime(_("number of datapoints of the schedule must be set for patch training"), *this);
+        
+        // creates logging
+        if (m_logging) {
+            m_logprototypes.clear();
+            m_quantizationerror.clear();
+            m_logprototypes.reserve(p_iterations);
+            m_quantizationerror.reserve(p_iterations);
+        }
+        
+        m_convergence.reset();
+        
+        for(std::size_t i=0; i < p_iterations; ++i) {
+            
+            const ublas::matrix<T> l_previous( m_convergence.useShift() ? m_prototypes : ublas::matrix<T>() );
+            
+            for(std::size_t n=0; n < p_data.size1(); n += m_batchsize)
+                adapt( ublas::subrange( p_data, n, std::min(n+m_batchsize, p_data.size1()), 0, p_data.size2() ), m_samples );
+            
+            if (iterationEnd( p_data, l_previous, i ))
+                break;
+        }
+        
+        // determine size of receptive fields
+        const ublas::indirect_array<> l_winner = use(p_data);
+        for(std::size_t i=0; i < l_winner.size(); ++i)
+            m_prototypeWeights( l_winner(i) )++;
+        
+        if (m_logging)
+            m_logprototypeWeights.push_back(m_prototypeWeights);
+    }
+    
+    
+    /** adapts the prototypes with one mini-batch. The ranks are determined with the
+     * prototypes before the adaption and the adaptions of the datapoints are averaged
+     * @param p_batch mini-batch
+     * @param p_samples number of datapoints of the schedule
+     **/
+    template<typename T> inline void online_neuralgas<T>::adapt( const ublas::matrix<T>& p_batch, const std::size_t& p_samples )
+    {
+        // annealed learning rate and neighborhood
+        const T l_time   = std::min( static_cast<T>(1), static_cast<T>(m_steps) / static_cast<T>(p_samples) );
+        const T l_rate   = m_ratestart   * std::pow( m_rateend / m_ratestart, l_time );
+        const T l_lambda = m_lambdastart * std::pow( m_lambdaend / m_lambdastart, l_time );
+        
+        // number of ranks, whose adaption value exp(-rank/lambda) is not below the machine precision
+        const std::size_t l_prototypes = m_prototypes.size1();
+        const T l_range                = std::floor( -l_lambda * std::log(std::numeric_limits<T>::epsilon()) ) + 1;
+        const std::size_t l_k          = (l_range < static_cast<T>(l_prototypes)) ? static_cast<std::size_t>(l_range) : l_prototypes;
+        
+        // adaption values of each datapoint (row) and prototype (column), only the
+        // k nearest prototypes are sorted and the other prototypes are not adapted
+        ublas::matrix<T> l_adapt = m_distance.getPairwiseDistance( p_batch, m_prototypes );
+        m_rankindex.resize( l_adapt.size1() * l_prototypes );
+        
+        #pragma omp parallel for shared(l_adapt)
+        for(std::size_t n=0; n < l_adapt.size1(); ++n) {
+            const T* l_distance                              = &l_adapt(n, 0);
+            const std::vector<std::size_t>::iterator l_index = m_rankindex.begin() + n * l_prototypes;
+            
+            for(std::size_t j=0; j < l_prototypes; ++j)
+                l_index[j] = j;
+            std::partial_sort( l_index, l_index+l_k, l_index+l_prototypes, lam::var(l_distance)[lam::_1] < lam::var(l_distance)[lam::_2] );
+            
+            for(std::size_t j=l_k; j < l_prototypes; ++j)
+                l_adapt(n, l_index[j]) = 0;
+            for(std::size_t j=0; j < l_k; ++j)
+                l_adapt(n, l_index[j]) = std::exp( -static_cast<T>(j) / l_lambda );
+        }
+        
+        // move the prototypes to the weighted mean of the differences
+        const ublas::matrix<T> l_sum = ublas::prod( ublas::trans(l_adapt), p_batch );
+        const T l_multi              = l_rate / static_cast<T>(p_batch.size1());
+        
+        #pragma omp parallel for
+        for(std::size_t n=0; n < m_prototypes.size1(); ++n) {
+            const T l_weight = ublas::sum( ublas::column(l_adapt, n) );
+            ublas::row(m_prototypes, n) += l_multi * (ublas::row(l_sum, n) - l_weight * ublas::row(m_prototypes, n));
+        }
+        
+        m_steps += p_batch.size1();
+    }
+    
+    
+    /** runs logging, observing and the convergence check at the end of an iteration
+     * @param p_data data matrix
+     * @param p_previous prototypes before the iteration
+     * @param p_iteration iteration
+     * @return bool if the training can be stopped
+     **/
+    template<typename T> inline bool online_neuralgas<T>::iterationEnd( const ublas::matrix<T>& p_data, const ublas::matrix<T>& p_previous, const std::size_t& p_iteration )
+    {
+        const bool l_observed = m_observer && m_observer->isObserved(p_iteration);
+        T l_error = 0;
+        if (m_logging || m_convergence.useErrorChange() || (l_observed && m_observer->useError()))
+            l_error = calculateQuantizationError(p_data);
+        
+        if (m_logging) {
+            m_logprototypes.push_back( m_prototypes );
+            m_quantizationerror.push_back( l_error );
+        }
+        if (l_observed)
+            m_observer->notify( p_iteration, m_prototypes, l_error );
+        
+        return m_convergence.isConverged( p_previous, m_prototypes, l_error, m_convergence.useAssignmentChanges() ? m_distance.getNearest(p_data, m_prototypes) : ublas::indirect_array<>() );
+    }
+    
+    
+    /** calculate the quantization error
+     * @param p_data matrix with data points
+     * @return quantization error
+     **/    
+    template<typename T> inline T online_neuralgas<T>::calculateQuantizationError( const ublas::matrix<T>& p_data ) const
+    {
+        const ublas::matrix<T> l_distances = m_distance.getPairwiseDistance( m_prototypes, p_data );
+        return 0.5 * ublas::sum(  m_distance.getAbs(tools::matrix::min(l_distances, tools::matrix::column))  );  
+    }
+    
+    
+    /** calulates distance between datapoints and prototypes and returns a indirect array
+     * with index of the nearest prototype
+     * @param p_data matrix
+     * @return index array of prototype indices
+     **/
+    template<typename T> inline ublas::indirect_array<> online_neuralgas<T>::use( const ublas::matrix<T>& p_data ) const
+    {
+        if (p_data.size2() != m_prototypes.size2())
+            throw exception::runtime(_("data and prototype dimension are not equal"), *this);
+        
+        return m_distance.getNearest( p_data, m_prototypes );
+    }
+    
+    
+}}}
+#endif
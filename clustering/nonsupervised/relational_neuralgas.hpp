@@ -30,6 +30,9 @@
 #include <numeric>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/bindings/blas.hpp>
+#include <boost/numeric/bindings/ublas/matrix.hpp>
 
 #ifdef MACHINELEARNING_MPI
 #include <boost/mpi.hpp>
@@ -38,6 +41,7 @@
 #include "clustering.hpp"
 #include "../../errorhandling/exception.hpp"
 #include "../../tools/tools.h"
+#include "../../distances/dissimilarity.hpp"
 #include "../../neighborhood/neighborhood.h"
 
 
@@ -46,6 +50,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     
     #ifndef SWIG
     namespace ublas = boost::numeric::ublas;
+    namespace blas  = boost::numeric::bindings::blas;
     #ifdef MACHINELEARNING_MPI
     namespace mpi   = boost::mpi;
     #endif
@@ -57,6 +62,10 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
      * data, so it is the task of the developer to use the correct ranges. Also the MPI
      * methods must be called in the correct order, so the MPI calls must be run
      * on each process.
+     * @note The non-MPI training stops before the number of iterations, if the
+     * criteria of the convergence object hold
+     * @note The training and use methods with a dissimilarity object do not hold
+     * the whole dissimilarity matrix in memory, the matrix is read blockwise
      * @todo thinking about relation calculating transform to a own distance class
      * @todo add patch-clustering:
      * @code
@@ -109,6 +118,14 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             std::size_t getPrototypeCount( void ) const;
             std::vector<T> getLoggedQuantizationError( void ) const;
             ublas::indirect_array<> use( const ublas::matrix<T>& ) const;
+            void setConvergence( const convergence<T>& );
+            convergence<T> getConvergence( void ) const;
+            #ifndef SWIG
+            void setObserver( observer<T>* );
+            void train( const distances::dissimilarity<T>&, const std::size_t& );
+            void train( const distances::dissimilarity<T>&, const std::size_t&, const T& );
+            ublas::indirect_array<> use( const distances::dissimilarity<T>& ) const;
+            #endif
         
         
             #ifdef MACHINELEARNING_MPI
@@ -132,9 +149,17 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             std::vector< ublas::matrix<T> > m_logprototypes;
             /** std::vector for quantisation error in each iteration **/
             std::vector<T> m_quantizationerror;
+            /** stopping criteria of the training **/
+            convergence<T> m_convergence;
+            /** observer of the training **/
+            observer<T>* m_observer;
         
             T calculateQuantizationError( const ublas::matrix<T>& ) const;
             ublas::matrix<T> calcDistance( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+            #ifndef SWIG
+            ublas::matrix<T> calcDistance( const ublas::matrix<T>&, const distances::dissimilarity<T>& ) const;
+            template<typename D> void runTraining( const D&, const std::size_t&, const T& );
+            #endif
         
             #ifdef MACHINELEARNING_MPI
             /** vector with information to every process and width of the prototype / data matrix **/
@@ -160,7 +185,9 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         m_prototypes( tools::matrix::random<T>(p_prototypes, p_prototypesize) ),
         m_logging( false ),
         m_logprototypes( std::vector< ublas::matrix<T> >() ),
-        m_quantizationerror( std::vector<T>() )
+        m_quantizationerror( std::vector<T>() ),
+        m_convergence(),
+        m_observer( NULL )
         #ifdef MACHINELEARNING_MPI
         , m_processdatainfo(),
         m_processprototypinfo()
@@ -256,6 +283,35 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     }
     
     
+    /** sets the stopping criteria of the training
+     * @param p_convergence convergence object
+     **/
+    template<typename T> inline void relational_neuralgas<T>::setConvergence( const convergence<T>& p_convergence )
+    {
+        m_convergence = p_convergence;
+    }
+    
+    
+    /** returns the stopping criteria with the number of iterations
+     * and the values of the last training
+     * @return convergence object
+     **/
+    template<typename T> inline convergence<T> relational_neuralgas<T>::getConvergence( void ) const
+    {
+        return m_convergence;
+    }
+    
+    
+    /** sets the observer of the training, the observer is not copied,
+     * so it must exist during the training
+     * @param p_observer pointer to the observer (NULL disables observing)
+     **/
+    template<typename T> inline void relational_neuralgas<T>::setObserver( observer<T>* p_observer )
+    {
+        m_observer = p_observer;
+    }
+    
+    
     /** training the prototypes
      * @param p_data datapoints
      * @param p_iterations iterations
@@ -276,7 +332,50 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         if (p_data.size1() != p_data.size2())
             throw exception::runtime(_("matrix must be square"), *this);
         
+        runTraining( p_data, p_iterations, p_lambda );
+    }
+    
+    
+    /** 
+     * train the prototypes with a blockwise read dissimilarity matrix
+     * @param p_data dissimilarity object
+     * @param p_iterations number of iterations
+     **/
+    template<typename T> inline void relational_neuralgas<T>::train( const distances::dissimilarity<T>& p_data, const std::size_t& p_iterations )
+    {
+        train(p_data, p_iterations, m_prototypes.size1() * 0.5);
+    }
+    
+    
+    /** training the prototypes with a blockwise read dissimilarity matrix
+     * @param p_data dissimilarity object
+     * @param p_iterations iterations
+     * @param p_lambda max adapet size
+     **/
+    template<typename T> inline void relational_neuralgas<T>::train( const distances::dissimilarity<T>& p_data, const std::size_t& p_iterations, const T& p_lambda )
+    {
+        if (m_prototypes.size1() == 0)
+            throw exception::runtime(_("number of prototypes must be greater than zero"), *this);
+        if (p_data.size() < m_prototypes.size1())
+            throw exception::runtime(_("number of datapoints are less than prototypes"), *this);
+        if (p_iterations == 0)
+            throw exception::runtime(_("iterations must be greater than zero"), *this);
+        if (p_data.size() != m_prototypes.size2())
+            throw exception::runtime(_("data and prototype dimension are not equal"), *this);
+        if (p_lambda <= 0)
+            throw exception::runtime(_("lambda must be greater than zero"), *this);
         
+        runTraining( p_data, p_iterations, p_lambda );
+    }
+    
+    
+    /** runs the training loop, the data type must be supported by calcDistance
+     * @param p_data datapoints (dissimilarity matrix or object)
+     * @param p_iterations iterations
+     * @param p_lambda max adapet size
+     **/
+    template<typename T> template<typename D> inline void relational_neuralgas<T>::runTraining( const D& p_data, const std::size_t& p_iterations, const T& p_lambda )
+    {
         // creates logging
         if (m_logging) {
             m_logprototypes.clear();
@@ -290,6 +389,7 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         // run neural gas       
         const T l_multi = 0.01/p_lambda;
         ublas::vector<T> l_lambda(m_prototypes.size1());
+        m_convergence.reset();
         
         for(std::size_t i=0; i < p_iterations; ++i) {
             
@@ -304,12 +404,19 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             ublas::matrix<T> l_adaptmatrix  = calcDistance( m_prototypes, p_data );
 
             
-            // determine quantization error for logging (adaption matrix)
+            // determine quantization error for logging and convergence check (adaption matrix)
+            T l_error = 0;
+            if (m_logging || m_convergence.useErrorChange())
+                l_error = calculateQuantizationError(l_adaptmatrix);
+            
             if (m_logging) {
-                m_quantizationerror.push_back( calculateQuantizationError(l_adaptmatrix) );
+                m_quantizationerror.push_back( l_error );
                 m_logprototypes.push_back( m_prototypes );
             }
             
+            // determine winners of the current prototypes for the convergence check
+            const ublas::indirect_array<> l_winner = m_convergence.useAssignmentChanges() ? tools::matrix::argmin(l_adaptmatrix, tools::matrix::column) : ublas::indirect_array<>();
+            
             
             // for every column ranks values and create adapts
             // we need rank and not randIndex, because we 
@@ -326,6 +433,8 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             
  
             // adapt values are the new prototypes (and run normalization)
+            const ublas::matrix<T> l_previous( m_convergence.useShift() ? m_prototypes : ublas::matrix<T>() );
+            
             #pragma omp parallel for
             for(std::size_t n=0; n < l_adaptmatrix.size1(); ++n) {
                 const T l_sum                = ublas::sum( ublas::row( l_adaptmatrix, n) );
@@ -334,6 +443,13 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
                 if (!tools::function::isNumericalZero(l_sum))
                     ublas::row( m_prototypes, n ) /= l_sum;
             }
+            
+            // observing of the updated prototypes, so their quantization error is calculated on observed iterations only
+            if (m_observer && m_observer->isObserved(i))
+                m_observer->notify( i, m_prototypes, m_observer->useError() ? calculateQuantizationError(calcDistance(m_prototypes, p_data)) : static_cast<T>(0) );
+            
+            if (m_convergence.isConverged( l_previous, m_prototypes, l_error, l_winner ))
+                break;
         }
     }
     
@@ -364,16 +480,29 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         const ublas::matrix<T> l_distance = ublas::prod( p_data, ublas::trans(m_prototypes) );
         
         #pragma omp parallel for shared(l_idx)
-        for(std::size_t i=0; i < l_distance.size1(); ++i) {
-            ublas::vector<T> l_col                = ublas::row(l_distance, i);
-            const ublas::indirect_array<> l_rank  = tools::vector::rankIndex( l_col );
-            l_idx[i] = l_rank(0);
-        }
+        for(std::size_t i=0; i < l_distance.size1(); ++i)
+            l_idx[i] = tools::vector::argmin( ublas::row(l_distance, i) );
         
         return l_idx;
     }
     
     
+    /** calulates distance between datapoints and prototypes and returns a indirect array
+     * with index of the nearest prototype
+     * @param p_data dissimilarity object
+     * @return index array of prototype indices
+     **/
+    template<typename T> inline ublas::indirect_array<> relational_neuralgas<T>::use( const distances::dissimilarity<T>& p_data ) const
+    {
+        if (m_prototypes.size1() == 0)
+            throw exception::runtime(_("number of prototypes must be greater than zero"), *this);
+        if (p_data.size() != m_prototypes.size2())
+            throw exception::runtime(_("data and prototype dimension are not equal"), *this);
+        
+        return tools::matrix::argmin( calcDistance(m_prototypes, p_data), tools::matrix::column );
+    }
+    
+    
     /** calculates the distance values between neurons and data.
      * @todo thinking for own distance class
      * @param p_prototypes prototype matrix
@@ -398,6 +527,43 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         return l_adaptmatrix;
     }
     
+    
+    /** calculates the distance values between neurons and data, the dissimilarity
+     * matrix is read in blocks, so only one block is held in memory
+     * @param p_prototypes prototype matrix
+     * @param p_data dissimilarity object
+     * @return matrix with distance values (number of prototypes X data dimension)
+     **/
+    template<typename T> inline ublas::matrix<T> relational_neuralgas<T>::calcDistance( const ublas::matrix<T>& p_prototypes, const distances::dissimilarity<T>& p_data ) const
+    {
+        // adapt matrix = alpha * D, each block of D adds alpha(:,rows) * D(rows,cols) to the columns of the adapt matrix
+        const std::size_t l_blocksize = 1024;
+        ublas::matrix<T> l_adaptmatrix(p_prototypes.size1(), p_data.size(), 0);
+        ublas::matrix<T> l_product;
+        
+        for(std::size_t i=0; i < p_data.size(); i += l_blocksize) {
+            const ublas::matrix<T> l_weights = ublas::subrange( p_prototypes, 0, p_prototypes.size1(), i, std::min(i+l_blocksize, p_data.size()) );
+            
+            for(std::size_t j=0; j < p_data.size(); j += l_blocksize) {
+                const ublas::matrix<T> l_block = p_data.getBlock(i, l_blocksize, j, l_blocksize);
+                
+                l_product.resize( l_weights.size1(), l_block.size2(), false );
+                blas::gemm( static_cast<T>(1), l_weights, l_block, static_cast<T>(0), l_product );
+                ublas::subrange( l_adaptmatrix, 0, l_adaptmatrix.size1(), j, j+l_block.size2() ) += l_product;
+            }
+        }
+        
+        #pragma omp parallel for shared(l_adaptmatrix)
+        for(std::size_t n=0; n < l_adaptmatrix.size1(); ++n) {
+            const T l_val = 0.5 * ublas::inner_prod( ublas::row(p_prototypes, n), ublas::row(l_adaptmatrix, n) );
+            
+            for(std::size_t j=0; j < l_adaptmatrix.size2(); ++j)
+                l_adaptmatrix(n, j) -= l_val;
+        }
+        
+        return l_adaptmatrix;
+    }
+    
     //======= MPI ==================================================================================================================================
     #ifdef MACHINELEARNING_MPI
     
@@ -668,11 +834,8 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         const ublas::matrix<T> l_distance = ublas::prod( p_data, l_prototypes );
 
         #pragma omp parallel for shared(l_idx)
-        for(std::size_t i=0; i < l_distance.size1(); ++i) {
-            ublas::vector<T> l_col                = ublas::row(l_distance, i);
-            const ublas::indirect_array<> l_rank  = tools::vector::rankIndex( l_col );
-            l_idx[i] = l_rank(0);
-        }
+        for(std::size_t i=0; i < l_distance.size1(); ++i)
+            l_idx[i] = tools::vector::argmin( ublas::row(l_distance, i) );
         
         return l_idx;
     }
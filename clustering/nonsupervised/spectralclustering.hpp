@@ -25,9 +25,13 @@
 #define __MACHINELEARNING_CLUSTERING_NONSUPERVISED_SPECTRALCLUSTERING_HPP
 
 #include <omp.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
 #include <boost/numeric/bindings/blas.hpp>
 
 #include "clustering.hpp"
@@ -47,8 +51,8 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     
     /** class for normalized spectral clustering. This class calculates only the graph laplacian
      * and creates the general eigenvector decomposition. A neuralgas algorithm with euclidian
-     * distancesis used for clustering the data
-     * @todo set all routines to sparse matrix if arpack can be used with boost
+     * distancesis used for clustering the data. Sparse adjacency matrices (eg kNN graphs) are
+     * decomposed with the Lanczos algorithm, so only the k eigenvectors must be stored
      * @todo create eigengap heurstic
      **/
     template<typename T> class spectralclustering : public clustering<T>
@@ -65,6 +69,15 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
             std::size_t getPrototypeCount( void ) const;
             std::vector<T> getLoggedQuantizationError( void ) const;
             ublas::indirect_array<> use( const ublas::matrix<T>& ) const;
+            #ifndef SWIG
+            void train( const ublas::compressed_matrix<T>&, const std::size_t& );
+            ublas::indirect_array<> use( const ublas::compressed_matrix<T>& ) const;
+            #endif
+            void setConvergence( const convergence<T>& );
+            convergence<T> getConvergence( void ) const;
+            #ifndef SWIG
+            void setObserver( observer<T>* );
+            #endif
             
             //static std::size_t getEigenGap( const ublas::matrix<T>& ) const;
 
@@ -72,6 +85,8 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         private :
         
             ublas::matrix<T> getEigenGraphLaplacian( const ublas::matrix<T>& p_adjacency ) const;
+            ublas::matrix<T> getEigenGraphLaplacian( const ublas::compressed_matrix<T>& p_adjacency ) const;
+            static void normalizeEigenVectors( const ublas::vector<T>&, ublas::matrix<T>& );
         
             /** distance object for clustering (we use euclidan distances) **/
             const distances::norm::euclid<T> m_distance;
@@ -156,29 +171,108 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
     }    
     
     
+    /** sets the stopping criteria of the k-means training
+     * @param p_convergence convergence object
+     **/
+    template<typename T> inline void spectralclustering<T>::setConvergence( const convergence<T>& p_convergence )
+    {
+        m_kmeans.setConvergence(p_convergence);
+    }
+    
+    
+    /** returns the stopping criteria with the values of the last k-means training
+     * @return convergence object
+     **/
+    template<typename T> inline convergence<T> spectralclustering<T>::getConvergence( void ) const
+    {
+        return m_kmeans.getConvergence();
+    }
+    
+    
+    /** sets the observer of the k-means training
+     * @param p_observer pointer to the observer (NULL disables observing)
+     **/
+    template<typename T> inline void spectralclustering<T>::setObserver( observer<T>* p_observer )
+    {
+        m_kmeans.setObserver(p_observer);
+    }
+    
+    
     /** creates the cluster matrix of the graph laplacian
      * @param p_adjacency adjacency matrix
      * @return data matrix for the k-means clustering
      **/
     template<typename T> inline ublas::matrix<T> spectralclustering<T>::getEigenGraphLaplacian( const ublas::matrix<T>& p_adjacency ) const
     {
-        // get the normalized graph laplacian
-        const ublas::matrix<T> l_laplacian = tools::lapack::normalizedGraphLaplacian( p_adjacency );
+        // get the symmetric normalized graph laplacian
+        const ublas::matrix<T> l_laplacian = tools::lapack::symmetricGraphLaplacian( p_adjacency );
         
-        // determine eigenvalues and -vector of the graph laplacian
+        // determine the eigenvectors of the k smallest eigenvalues of the graph laplacian
         ublas::vector<T> l_eigenvalue;
-        ublas::matrix<T> l_eigenvector;
-        tools::lapack::eigen( l_laplacian, l_eigenvalue, l_eigenvector );
+        ublas::matrix<T> l_eigenmatrix;
+        tools::lapack::eigensymmetric( l_laplacian, l_eigenvalue, l_eigenmatrix, m_kmeans.getPrototypeCount(), tools::lapack::smallest );
         
-        // ranking eigenvalues and get the k smallest for the eigenvectors
-        const ublas::indirect_array<> l_rank = tools::vector::rankIndex<T>(l_eigenvalue);
-        ublas::matrix<T> l_eigenmatrix( p_adjacency.size1(), m_kmeans.getPrototypeCount() );
-
-        for(std::size_t i=0; i < l_eigenmatrix.size2(); ++i)
-            ublas::column(l_eigenmatrix, i) = ublas::column(l_eigenvector, l_rank(i));
+        normalizeEigenVectors( tools::matrix::sum(p_adjacency), l_eigenmatrix );
+        return l_eigenmatrix;
+    }
+    
+    
+    /** creates the cluster matrix of the graph laplacian of a sparse adjacency matrix. The smallest
+     * eigenvalues of the laplacian I - D^-0.5 * A * D^-0.5 are the largest of D^-0.5 * A * D^-0.5, so
+     * the sparse matrix is scaled and the largest eigenvectors are calculated with the Lanczos algorithm,
+     * if it does not converge it is run again with a larger Krylov subspace and more restarts
+     * @param p_adjacency sparse adjacency matrix
+     * @return data matrix for the k-means clustering
+     **/
+    template<typename T> inline ublas::matrix<T> spectralclustering<T>::getEigenGraphLaplacian( const ublas::compressed_matrix<T>& p_adjacency ) const
+    {
+        if (p_adjacency.size1() != p_adjacency.size2())
+            throw exception::runtime(_("matrix must be square"), *this);
+        
+        // vertex degree and the inverted square root of it
+        ublas::vector<T> l_vertexdegree( p_adjacency.size1(), 0 );
+        for(typename ublas::compressed_matrix<T>::const_iterator1 l_row = p_adjacency.begin1(); l_row != p_adjacency.end1(); ++l_row)
+            for(typename ublas::compressed_matrix<T>::const_iterator2 l_col = l_row.begin(); l_col != l_row.end(); ++l_col)
+                l_vertexdegree(l_col.index1()) += *l_col;
         
+        ublas::vector<T> l_scale( l_vertexdegree.size() );
+        for(std::size_t i=0; i < l_scale.size(); ++i)
+            l_scale(i) = (l_vertexdegree(i) > 0) ? static_cast<T>(1) / std::sqrt(l_vertexdegree(i)) : 0;
+        
+        // D^-0.5 * A * D^-0.5
+        ublas::compressed_matrix<T> l_normalized( p_adjacency );
+        for(typename ublas::compressed_matrix<T>::iterator1 l_row = l_normalized.begin1(); l_row != l_normalized.end1(); ++l_row)
+            for(typename ublas::compressed_matrix<T>::iterator2 l_col = l_row.begin(); l_col != l_row.end(); ++l_col)
+                *l_col *= l_scale(l_col.index1()) * l_scale(l_col.index2());
+        
+        ublas::vector<T> l_eigenvalue;
+        ublas::matrix<T> l_eigenmatrix;
+        // if the Lanczos iteration does not converge, it is repeated with a larger subspace (the
+        // matrix is never converted to a dense matrix, because it can be too large for the memory)
+        const std::size_t l_count = m_kmeans.getPrototypeCount();
+        if (!tools::lanczos::eigen( l_normalized, l_eigenvalue, l_eigenmatrix, l_count, tools::lapack::largest ))
+            if (!tools::lanczos::eigen( l_normalized, l_eigenvalue, l_eigenmatrix, l_count, tools::lapack::largest, std::sqrt(std::numeric_limits<T>::epsilon()), 10000, 4*std::max(2*l_count, l_count+20) ))
+                throw exception::runtime(_("eigenvectors are not converged"), *this);
+        
+        normalizeEigenVectors( l_vertexdegree, l_eigenmatrix );
         return l_eigenmatrix;
     }
+    
+    
+    /** changes the eigenvectors u of the symmetric graph laplacian to the eigenvectors of the 
+     * normalized graph laplacian (D^-0.5 * u) and normalizes them
+     * @param p_vertexdegree vertex degree
+     * @param p_eigenmatrix eigenvector matrix (every column is a eigenvector)
+     **/
+    template<typename T> inline void spectralclustering<T>::normalizeEigenVectors( const ublas::vector<T>& p_vertexdegree, ublas::matrix<T>& p_eigenmatrix )
+    {
+        for(std::size_t i=0; i < p_eigenmatrix.size1(); ++i)
+            if (p_vertexdegree(i) > 0)
+                ublas::row(p_eigenmatrix, i) /= std::sqrt( p_vertexdegree(i) );
+        
+        for(std::size_t i=0; i < p_eigenmatrix.size2(); ++i)
+            ublas::column(p_eigenmatrix, i) /= blas::nrm2( static_cast< ublas::vector<T> >(ublas::column(p_eigenmatrix, i)) );
+    }
         
     
     /** cluster the graph with the <strong>normalized</strong> graph laplacian
@@ -200,6 +294,26 @@ namespace machinelearning { namespace clustering { namespace nonsupervised {
         return m_kmeans.use( getEigenGraphLaplacian(p_data) );
     }
     
+    
+    /** cluster the graph of a sparse adjacency matrix with the <strong>normalized</strong> graph laplacian
+     * @param p_adjacency sparse adjacency matrix
+     * @param p_iterations number of iterations
+     **/
+    template<typename T> inline void spectralclustering<T>::train( const ublas::compressed_matrix<T>& p_adjacency, const std::size_t& p_iterations )
+    {
+        m_kmeans.train( getEigenGraphLaplacian(p_adjacency), p_iterations );
+    }
+    
+    
+    /** returns the index for each vertex of the sparse adjacency matrix to the prototype
+     * @param p_adjacency sparse adjacency matrix
+     * @return array with index values
+     **/
+    template<typename T> inline ublas::indirect_array<> spectralclustering<T>::use( const ublas::compressed_matrix<T>& p_adjacency ) const
+    {
+        return m_kmeans.use( getEigenGraphLaplacian(p_adjacency) );
+    }
+    
         
 }}}
 #endif
@@ -0,0 +1,291 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+#ifndef __MACHINELEARNING_CLUSTERING_OBSERVER_HPP
+#define __MACHINELEARNING_CLUSTERING_OBSERVER_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+
+#if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+#include <boost/lexical_cast.hpp>
+#endif
+
+#include "../errorhandling/exception.hpp"
+#include "../tools/tools.h"
+
+
+namespace machinelearning { namespace clustering {
+    
+    #ifndef SWIG
+    namespace ublas = boost::numeric::ublas;
+    #endif
+    
+    
+    /** abstract class for observing the training of the clustering classes. The training
+     * calls notify only on observed iterations (every n-th iteration) and calculates the
+     * quantization error only if the observer uses it, so the observer can stream or
+     * subsample the prototypes instead of holding each iteration in memory. Each trainer
+     * calls notify at the end of the iteration, so it gets the updated prototypes of the
+     * iteration and their quantization error
+     **/
+    template<typename T> class observer
+    {
+        #ifndef SWIG
+        BOOST_STATIC_ASSERT( !boost::is_integral<T>::value );
+        #endif
+        
+        
+        public :
+        
+            observer( const std::size_t& = 1, const bool& = true, const bool& = true );
+            virtual ~observer( void ) {};
+            bool isObserved( const std::size_t& ) const;
+            bool usePrototypes( void ) const;
+            bool useError( void ) const;
+        
+            /** method that is called on each observed iteration with the prototypes after the update **/
+            virtual void notify( const std::size_t&, const ublas::matrix<T>&, const T& ) = 0;
+        
+        
+        protected :
+        
+            /** step size of the observed iterations **/
+            const std::size_t m_step;
+            /** bool for observing the prototypes **/
+            const bool m_prototypes;
+            /** bool for observing the quantization error **/
+            const bool m_error;
+        
+    };
+    
+    
+    /** observer, that holds the observed prototypes and quantization errors in memory **/
+    template<typename T> class memoryobserver : public observer<T>
+    {
+        
+        public :
+        
+            memoryobserver( const std::size_t& = 1, const bool& = true, const bool& = true );
+            void notify( const std::size_t&, const ublas::matrix<T>&, const T& );
+            void clear( void );
+            std::vector<std::size_t> getIterations( void ) const;
+            std::vector< ublas::matrix<T> > getPrototypes( void ) const;
+            std::vector<T> getQuantizationError( void ) const;
+        
+        
+        private :
+        
+            /** std::vector with the observed iterations **/
+            std::vector<std::size_t> m_iterations;
+            /** std::vector with the observed prototypes **/
+            std::vector< ublas::matrix<T> > m_logprototypes;
+            /** std::vector with the observed quantization errors **/
+            std::vector<T> m_quantizationerror;
+        
+    };
+    
+    
+    #if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+    
+    /** observer, that writes the observed prototypes and quantization errors directly
+     * to a HDF file, each iteration is stored under <path><iteration>/protos and
+     * <path><iteration>/error
+     **/
+    template<typename T> class hdfobserver : public observer<T>
+    {
+        
+        public :
+        
+            hdfobserver( const tools::files::hdf&, const std::string& = "/log", const tools::files::hdf::datatype& = tools::files::hdf::NATIVE_DOUBLE, const std::size_t& = 1, const bool& = true, const bool& = true );
+            void notify( const std::size_t&, const ublas::matrix<T>&, const T& );
+        
+        
+        private :
+        
+            /** target file **/
+            const tools::files::hdf& m_file;
+            /** path prefix of the datasets **/
+            const std::string m_path;
+            /** datatype of the datasets **/
+            const tools::files::hdf::datatype m_datatype;
+        
+    };
+    
+    #endif
+    
+    
+    
+    /** constructor
+     * @param p_step every n-th iteration is observed
+     * @param p_prototypes observing prototypes
+     * @param p_error observing the quantization error
+     **/
+    template<typename T> inline observer<T>::observer( const std::size_t& p_step, const bool& p_prototypes, const bool& p_error ) :
+        m_step( p_step ),
+        m_prototypes( p_prototypes ),
+        m_error( p_error )
+    {
+        if (p_step == 0)
+            throw exception::runtime(_("step size must be greater than zero"), *this);
+    }
+    
+    
+    /** checks if an iteration is observed
+     * @param p_iteration iteration
+     * @return bool
+     **/
+    template<typename T> inline bool observer<T>::isObserved( const std::size_t& p_iteration ) const
+    {
+        return (p_iteration % m_step) == 0;
+    }
+    
+    
+    /** returns if the prototypes are observed
+     * @return bool
+     **/
+    template<typename T> inline bool observer<T>::usePrototypes( void ) const
+    {
+        return m_prototypes;
+    }
+    
+    
+    /** returns if the quantization error is observed, so
+     * the training must calculate the error
+     * @return bool
+     **/
+    template<typename T> inline bool observer<T>::useError( void ) const
+    {
+        return m_error;
+    }
+    
+    
+    
+    /** constructor
+     * @param p_step every n-th iteration is observed
+     * @param p_prototypes observing prototypes
+     * @param p_error observing the quantization error
+     **/
+    template<typename T> inline memoryobserver<T>::memoryobserver( const std::size_t& p_step, const bool& p_prototypes, const bool& p_error ) :
+        observer<T>( p_step, p_prototypes, p_error ),
+        m_iterations(),
+        m_logprototypes(),
+        m_quantizationerror()
+    {}
+    
+    
+    /** stores the prototypes and the error of an iteration
+     * @param p_iteration iteration
+     * @param p_prototypes prototype matrix
+     * @param p_error quantization error (only set if the error is observed)
+     **/
+    template<typename T> inline void memoryobserver<T>::notify( const std::size_t& p_iteration, const ublas::matrix<T>& p_prototypes, const T& p_error )
+    {
+        m_iterations.push_back( p_iteration );
+        
+        if (this->m_prototypes)
+            m_logprototypes.push_back( p_prototypes );
+        if (this->m_error)
+            m_quantizationerror.push_back( p_error );
+    }
+    
+    
+    /** clears all stored data **/
+    template<typename T> inline void memoryobserver<T>::clear( void )
+    {
+        m_iterations.clear();
+        m_logprototypes.clear();
+        m_quantizationerror.clear();
+    }
+    
+    
+    /** returns the observed iterations
+     * @return std::vector with iterations
+     **/
+    template<typename T> inline std::vector<std::size_t> memoryobserver<T>::getIterations( void ) const
+    {
+        return m_iterations;
+    }
+    
+    
+    /** returns the observed prototypes
+     * @return std::vector with prototype matrix
+     **/
+    template<typename T> inline std::vector< ublas::matrix<T> > memoryobserver<T>::getPrototypes( void ) const
+    {
+        return m_logprototypes;
+    }
+    
+    
+    /** returns the observed quantization errors
+     * @return std::vector with errors
+     **/
+    template<typename T> inline std::vector<T> memoryobserver<T>::getQuantizationError( void ) const
+    {
+        return m_quantizationerror;
+    }
+    
+    
+    
+    #if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+    
+    /** constructor
+     * @param p_file HDF file object, that must be opened for writing
+     * @param p_path path prefix of the datasets
+     * @param p_datatype datatype of the datasets
+     * @param p_step every n-th iteration is observed
+     * @param p_prototypes observing prototypes
+     * @param p_error observing the quantization error
+     **/
+    template<typename T> inline hdfobserver<T>::hdfobserver( const tools::files::hdf& p_file, const std::string& p_path, const tools::files::hdf::datatype& p_datatype, const std::size_t& p_step, const bool& p_prototypes, const bool& p_error ) :
+        observer<T>( p_step, p_prototypes, p_error ),
+        m_file( p_file ),
+        m_path( p_path ),
+        m_datatype( p_datatype )
+    {}
+    
+    
+    /** writes the prototypes and the error of an iteration
+     * @param p_iteration iteration
+     * @param p_prototypes prototype matrix
+     * @param p_error quantization error (only set if the error is observed)
+     **/
+    template<typename T> inline void hdfobserver<T>::notify( const std::size_t& p_iteration, const ublas::matrix<T>& p_prototypes, const T& p_error )
+    {
+        const std::string l_path = m_path + boost::lexical_cast<std::string>(p_iteration);
+        
+        if (this->m_prototypes)
+            m_file.writeBlasMatrix<T>( l_path + "/protos", p_prototypes, m_datatype );
+        if (this->m_error)
+            m_file.writeValue<T>( l_path + "/error", p_error, m_datatype );
+    }
+    
+    #endif
+    
+    
+}}
+#endif
@@ -0,0 +1,276 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+#ifndef __MACHINELEARNING_CLUSTERING_SEEDING_HPP
+#define __MACHINELEARNING_CLUSTERING_SEEDING_HPP
+
+#include <omp.h>
+#include <map>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+#include "../errorhandling/exception.hpp"
+#include "../distances/distances.h"
+#include "../tools/tools.h"
+
+
+namespace machinelearning { namespace clustering {
+    
+    #ifndef SWIG
+    namespace ublas = boost::numeric::ublas;
+    #endif
+    
+    
+    /** class for data-driven initialization of prototypes. The returned
+     * prototype matrix can be set with setPrototypes of the clustering classes
+     * @see http://ilpubs.stanford.edu:8090/778/1/2006-13.pdf (k-means++)
+     * @see http://theory.stanford.edu/~sergei/papers/vldb12-kmpar.pdf (k-means||)
+     **/
+    class seeding
+    {
+        
+        public :
+        
+            template<typename T> static ublas::matrix<T> kmeansplusplus( const distances::distance<T>&, const ublas::matrix<T>&, const std::size_t& );
+            template<typename T> static ublas::matrix<T> kmeansparallel( const distances::distance<T>&, const ublas::matrix<T>&, const std::size_t&, const std::size_t& = 5, const T& = 2 );
+            template<typename T, typename L> static ublas::matrix<T> kmeansplusplus( const distances::distance<T>&, const ublas::matrix<T>&, const std::vector<L>&, const std::vector<L>& );
+        
+        
+        private :
+        
+            template<typename T> static ublas::matrix<T> kmeansplusplus( const distances::distance<T>&, const ublas::matrix<T>&, const ublas::vector<T>&, const std::size_t& );
+            template<typename T> static void updateDistances( const distances::distance<T>&, const ublas::matrix<T>&, const ublas::vector<T>&, ublas::vector<T>& );
+            template<typename T> static std::size_t sample( const ublas::vector<T>&, tools::random& );
+        
+    };
+    
+    
+    
+    /** k-means++ seeding: the first prototype is a random datapoint, every further
+     * prototype is a datapoint, that is drawn with a probability proportional
+     * to the squared distance to the nearest prototype chosen so far
+     * @param p_distance distance object
+     * @param p_data data matrix (rows are datapoints)
+     * @param p_prototypes number of prototypes
+     * @return prototype matrix
+     **/
+    template<typename T> inline ublas::matrix<T> seeding::kmeansplusplus( const distances::distance<T>& p_distance, const ublas::matrix<T>& p_data, const std::size_t& p_prototypes )
+    {
+        return kmeansplusplus( p_distance, p_data, ublas::vector<T>(p_data.size1(), static_cast<T>(1)), p_prototypes );
+    }
+    
+    
+    /** k-means++ seeding for supervised clustering: the prototypes of each label
+     * are seeded with the datapoints of the same label
+     * @param p_distance distance object
+     * @param p_data data matrix (rows are datapoints)
+     * @param p_datalabels labels of the datapoints
+     * @param p_prototypelabels labels of the prototypes
+     * @return prototype matrix (row order is equal to the prototype labels)
+     **/
+    template<typename T, typename L> inline ublas::matrix<T> seeding::kmeansplusplus( const distances::distance<T>& p_distance, const ublas::matrix<T>& p_data, const std::vector<L>& p_datalabels, const std::vector<L>& p_prototypelabels )
+    {
+        if (p_data.size1() != p_datalabels.size())
+            throw exception::runtime(_("data and label size are not equal"));
+        
+        // index positions of data and prototypes for each label
+        std::map<L, std::vector<std::size_t> > l_dataidx;
+        std::map<L, std::vector<std::size_t> > l_prototypeidx;
+        for(std::size_t i=0; i < p_datalabels.size(); ++i)
+            l_dataidx[p_datalabels[i]].push_back(i);
+        for(std::size_t i=0; i < p_prototypelabels.size(); ++i)
+            l_prototypeidx[p_prototypelabels[i]].push_back(i);
+        
+        ublas::matrix<T> l_prototypes( p_prototypelabels.size(), p_data.size2() );
+        for(typename std::map<L, std::vector<std::size_t> >::const_iterator it = l_prototypeidx.begin(); it != l_prototypeidx.end(); ++it) {
+            const std::vector<std::size_t>& l_idx = l_dataidx[it->first];
+            if (l_idx.size() < it->second.size())
+                throw exception::runtime(_("number of datapoints of a label are less than the prototypes of this label"));
+            
+            ublas::matrix<T> l_labeldata( l_idx.size(), p_data.size2() );
+            for(std::size_t i=0; i < l_idx.size(); ++i)
+                ublas::row(l_labeldata, i) = ublas::row(p_data, l_idx[i]);
+            
+            const ublas::matrix<T> l_seeds = kmeansplusplus( p_distance, l_labeldata, it->second.size() );
+            for(std::size_t i=0; i < it->second.size(); ++i)
+                ublas::row(l_prototypes, it->second[i]) = ublas::row(l_seeds, i);
+        }
+        
+        return l_prototypes;
+    }
+    
+    
+    /** k-means|| seeding: the datapoints are oversampled in a few rounds, each datapoint
+     * is drawn independently with a probability proportional to the squared distance to
+     * the candidates. The candidates are weighted with the number of their nearest datapoints
+     * and reduced to the prototypes with a weighted k-means++ seeding
+     * @param p_distance distance object
+     * @param p_data data matrix (rows are datapoints)
+     * @param p_prototypes number of prototypes
+     * @param p_rounds number of sampling rounds (default 5)
+     * @param p_oversampling oversampling factor, so each round draws p_oversampling * p_prototypes datapoints on average (default 2)
+     * @return prototype matrix
+     **/
+    template<typename T> inline ublas::matrix<T> seeding::kmeansparallel( const distances::distance<T>& p_distance, const ublas::matrix<T>& p_data, const std::size_t& p_prototypes, const std::size_t& p_rounds, const T& p_oversampling )
+    {
+        if (p_prototypes == 0)
+            throw exception::runtime(_("number of prototypes must be greater than zero"));
+        if (p_data.size1() < p_prototypes)
+            throw exception::runtime(_("number of datapoints are less than prototypes"));
+        if (p_oversampling <= 0)
+            throw exception::runtime(_("oversampling factor must be greater than zero"));
+        
+        tools::random l_rand;
+        std::vector<std::size_t> l_candidates;
+        std::vector<bool> l_chosen( p_data.size1(), false );
+        ublas::vector<T> l_mindistance( p_data.size1(), std::numeric_limits<T>::max() );
+        
+        // first candidate is a random datapoint
+        l_candidates.push_back( std::min(static_cast<std::size_t>(l_rand.get<T>(tools::random::uniform, 0, p_data.size1())), p_data.size1()-1) );
+        l_chosen[l_candidates.back()] = true;
+        updateDistances( p_distance, p_data, static_cast< ublas::vector<T> >(ublas::row(p_data, l_candidates.back())), l_mindistance );
+        
+        for(std::size_t i=0; i < p_rounds; ++i) {
+            const T l_sum = ublas::sum( l_mindistance );
+            if (tools::function::isNumericalZero(l_sum))
+                break;
+            
+            // draw the datapoints of this round (the distances are updated after the round)
+            const std::size_t l_first = l_candidates.size();
+            for(std::size_t n=0; n < p_data.size1(); ++n)
+                if ( (!l_chosen[n]) && (l_rand.get<T>(tools::random::uniform, 0, 1) < p_oversampling * static_cast<T>(p_prototypes) * l_mindistance(n) / l_sum) ) {
+                    l_candidates.push_back(n);
+                    l_chosen[n] = true;
+                }
+            
+            for(std::size_t n=l_first; n < l_candidates.size(); ++n)
+                updateDistances( p_distance, p_data, static_cast< ublas::vector<T> >(ublas::row(p_data, l_candidates[n])), l_mindistance );
+        }
+        
+        // fill up with random datapoints, if there are not enough candidates
+        while (l_candidates.size() < p_prototypes) {
+            const std::size_t l_idx = std::min(static_cast<std::size_t>(l_rand.get<T>(tools::random::uniform, 0, p_data.size1())), p_data.size1()-1);
+            if (!l_chosen[l_idx]) {
+                l_candidates.push_back(l_idx);
+                l_chosen[l_idx] = true;
+            }
+        }
+        
+        
+        // weight every candidate with the number of datapoints, that are nearest to it
+        ublas::matrix<T> l_candidatematrix( l_candidates.size(), p_data.size2() );
+        for(std::size_t i=0; i < l_candidates.size(); ++i)
+            ublas::row(l_candidatematrix, i) = ublas::row(p_data, l_candidates[i]);
+        
+        const ublas::indirect_array<> l_nearest = p_distance.getNearest( p_data, l_candidatematrix );
+        
+        ublas::vector<T> l_weights( l_candidates.size(), static_cast<T>(0) );
+        for(std::size_t i=0; i < l_nearest.size(); ++i)
+            l_weights(l_nearest(i)) += static_cast<T>(1);
+        
+        return kmeansplusplus( p_distance, l_candidatematrix, l_weights, p_prototypes );
+    }
+    
+    
+    /** weighted k-means++ seeding, the probability of each datapoint is
+     * multiplied with its weight
+     * @param p_distance distance object
+     * @param p_data data matrix (rows are datapoints)
+     * @param p_weights weight of each datapoint
+     * @param p_prototypes number of prototypes
+     * @return prototype matrix
+     **/
+    template<typename T> inline ublas::matrix<T> seeding::kmeansplusplus( const distances::distance<T>& p_distance, const ublas::matrix<T>& p_data, const ublas::vector<T>& p_weights, const std::size_t& p_prototypes )
+    {
+        if (p_prototypes == 0)
+            throw exception::runtime(_("number of prototypes must be greater than zero"));
+        if (p_data.size1() < p_prototypes)
+            throw exception::runtime(_("number of datapoints are less than prototypes"));
+        
+        tools::random l_rand;
+        ublas::matrix<T> l_prototypes( p_prototypes, p_data.size2() );
+        ublas::vector<T> l_mindistance( p_data.size1(), std::numeric_limits<T>::max() );
+        
+        // first prototype is drawn with the weights only
+        ublas::row(l_prototypes, 0) = ublas::row(p_data, sample(p_weights, l_rand));
+        
+        for(std::size_t i=1; i < p_prototypes; ++i) {
+            updateDistances( p_distance, p_data, static_cast< ublas::vector<T> >(ublas::row(l_prototypes, i-1)), l_mindistance );
+            ublas::row(l_prototypes, i) = ublas::row(p_data, sample( static_cast< ublas::vector<T> >(ublas::element_prod(p_weights, l_mindistance)), l_rand ));
+        }
+        
+        return l_prototypes;
+    }
+    
+    
+    /** updates the squared distances of every datapoint to the nearest prototype
+     * @param p_distance distance object
+     * @param p_data data matrix
+     * @param p_prototype new prototype
+     * @param p_mindistance squared distance of every datapoint to the nearest prototype
+     **/
+    template<typename T> inline void seeding::updateDistances( const distances::distance<T>& p_distance, const ublas::matrix<T>& p_data, const ublas::vector<T>& p_prototype, ublas::vector<T>& p_mindistance )
+    {
+        // the distances of all rows are calculated at once, so the rows are not copied
+        const ublas::vector<T> l_distance = p_distance.getDistance( p_data, p_prototype );
+        
+        #pragma omp parallel for shared(p_mindistance)
+        for(std::size_t i=0; i < p_data.size1(); ++i)
+            p_mindistance(i) = std::min( p_mindistance(i), l_distance(i) * l_distance(i) );
+    }
+    
+    
+    /** draws an index with a probability proportional to the weights
+     * (uniform if all weights are zero)
+     * @param p_weights weight vector
+     * @param p_rand random object
+     * @return index
+     **/
+    template<typename T> inline std::size_t seeding::sample( const ublas::vector<T>& p_weights, tools::random& p_rand )
+    {
+        const T l_sum = ublas::sum( p_weights );
+        if (tools::function::isNumericalZero(l_sum))
+            return std::min( static_cast<std::size_t>(p_rand.get<T>(tools::random::uniform, 0, p_weights.size())), p_weights.size()-1 );
+        
+        const T l_value = p_rand.get<T>(tools::random::uniform, 0, l_sum);
+        T l_cumulative  = 0;
+        for(std::size_t i=0; i < p_weights.size(); ++i) {
+            l_cumulative += p_weights(i);
+            if ((l_value < l_cumulative) && (p_weights(i) > 0))
+                return i;
+        }
+        
+        // rounding errors on the cumulative sum, so the last index with weight is used
+        for(std::size_t i=p_weights.size(); i > 0; --i)
+            if (p_weights(i-1) > 0)
+                return i-1;
+        
+        return p_weights.size()-1;
+    }
+    
+}}
+#endif
@@ -32,6 +32,8 @@
 #include "../../errorhandling/exception.hpp"
 #include "../../distances/distances.h"
 #include "../../tools/tools.h"
+#include "../convergence.hpp"
+#include "../observer.hpp"
 
 namespace machinelearning {  namespace clustering {
         
@@ -88,6 +90,17 @@ namespace machinelearning {  namespace clustering {
                     
                     /** index position for prototype or label **/
                     virtual ublas::indirect_array<> use( const ublas::matrix<T>& ) const = 0;
+                    
+                    /** sets the stopping criteria of the training **/
+                    virtual void setConvergence( const convergence<T>& ) = 0;
+                    
+                    /** returns the stopping criteria with the values of the last training **/
+                    virtual convergence<T> getConvergence( void ) const = 0;
+                    
+                    #ifndef SWIG
+                    /** sets the observer of the training **/
+                    virtual void setObserver( observer<T>* ) = 0;
+                    #endif
                 
             };
             
@@ -46,6 +46,8 @@
 %typemap(javaout)            std::size_t machinelearning::clustering::supervised::clustering<double, std::string>::getPrototypeCount                                ";"
 %typemap(javaout)            std::vector<double> machinelearning::clustering::supervised::clustering<double, std::string>::getLoggedQuantizationError               ";"
 %typemap(javaout)            ublas::indirect_array<> machinelearning::clustering::supervised::clustering<double, std::string>::use                                  ";"
+%typemap(javaout)            void machinelearning::clustering::supervised::clustering<double, std::string>::setConvergence                                          ";"
+%typemap(javaout)            machinelearning::clustering::convergence<double> machinelearning::clustering::supervised::clustering<double, std::string>::getConvergence       ";"
 
 
 %typemap(javaclassmodifiers) machinelearning::clustering::supervised::clustering<double, std::size_t>                                                               "public interface"
@@ -63,6 +65,8 @@
 %typemap(javaout)            std::size_t machinelearning::clustering::supervised::clustering<double, std::size_t>::getPrototypeCount                                ";"
 %typemap(javaout)            std::vector<double> machinelearning::clustering::supervised::clustering<double, std::size_t>::getLoggedQuantizationError               ";"
 %typemap(javaout)            ublas::indirect_array<> machinelearning::clustering::supervised::clustering<double, std::size_t>::use                                  ";"
+%typemap(javaout)            void machinelearning::clustering::supervised::clustering<double, std::size_t>::setConvergence                                          ";"
+%typemap(javaout)            machinelearning::clustering::convergence<double> machinelearning::clustering::supervised::clustering<double, std::size_t>::getConvergence       ";"
 #endif
 
 
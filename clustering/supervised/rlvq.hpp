@@ -59,6 +59,7 @@ namespace machinelearning { namespace clustering { namespace supervised {
             void train( const ublas::matrix<T>&, const std::vector<L>&, const std::size_t&, const T& );
             void train( const ublas::matrix<T>&, const std::vector<L>&, const std::size_t&, const T&, const T& );
             ublas::matrix<T> getPrototypes( void ) const;
+            void setPrototypes( const ublas::matrix<T>& );
             std::vector<L> getPrototypesLabel( void ) const;
             void setLogging( const bool& );
             bool getLogging( void ) const;
@@ -67,6 +68,11 @@ namespace machinelearning { namespace clustering { namespace supervised {
             std::size_t getPrototypeCount( void ) const;
             std::vector<T> getLoggedQuantizationError( void ) const;
             ublas::indirect_array<> use( const ublas::matrix<T>& ) const;
+            void setConvergence( const convergence<T>& );
+            convergence<T> getConvergence( void ) const;
+            #ifndef SWIG
+            void setObserver( observer<T>* );
+            #endif
         
         
         private :
@@ -83,6 +89,10 @@ namespace machinelearning { namespace clustering { namespace supervised {
             std::vector< ublas::matrix<T> > m_logprototypes;
             /** std::vector with quantisation error in each iteration **/
             std::vector<T> m_quantizationerror;
+            /** stopping criteria of the training **/
+            convergence<T> m_convergence;
+            /** observer of the training **/
+            observer<T>* m_observer;
         
             T calculateQuantizationError( const ublas::matrix<T>& ) const;
     };
@@ -99,10 +109,14 @@ namespace machinelearning { namespace clustering { namespace supervised {
         m_neuronlabels( p_neuronlabels ),
         m_logging( false ),
         m_logprototypes( std::vector< ublas::matrix<T> >() ),
-        m_quantizationerror( std::vector< T >() )
+        m_quantizationerror( std::vector< T >() ),
+        m_convergence(),
+        m_observer( NULL )
     {
         if (p_prototypesize == 0)
             throw exception::runtime(_("prototype size must be greater than zero"), *this);
+        if (!p_distance.isSeparable())
+            throw exception::runtime(_("relevance learning needs a distance, that can be split into the dimensions"), *this);
     }
     
     
@@ -115,6 +129,19 @@ namespace machinelearning { namespace clustering { namespace supervised {
     }
     
     
+    /** sets the prototypes (e.g. with a data-driven seeding of each label), the number and the
+     * dimension of the prototypes must not be changed
+     * @param p_prototypes prototype matrix (rows = prototypes)
+    **/
+    template<typename T, typename L> inline void rlvq<T, L>::setPrototypes( const ublas::matrix<T>& p_prototypes )
+    {
+        if ((p_prototypes.size1() != m_prototypes.size1()) || (p_prototypes.size2() != m_prototypes.size2()))
+            throw exception::runtime(_("prototype matrix dimensions are not equal"), *this);
+        
+        m_prototypes = p_prototypes;
+    }
+    
+    
     /** returns the prototypes labels
      * @return vector with label information
     **/
@@ -179,6 +206,35 @@ namespace machinelearning { namespace clustering { namespace supervised {
     }
     
     
+    /** sets the stopping criteria of the training
+     * @param p_convergence convergence object
+    **/
+    template<typename T, typename L> inline void rlvq<T, L>::setConvergence( const convergence<T>& p_convergence )
+    {
+        m_convergence = p_convergence;
+    }
+    
+    
+    /** returns the stopping criteria with the number of iterations
+     * and the values of the last training
+     * @return convergence object
+    **/
+    template<typename T, typename L> inline convergence<T> rlvq<T, L>::getConvergence( void ) const
+    {
+        return m_convergence;
+    }
+    
+    
+    /** sets the observer of the training, the observer is not copied,
+     * so it must exist during the training
+     * @param p_observer pointer to the observer (NULL disables observing)
+    **/
+    template<typename T, typename L> inline void rlvq<T, L>::setObserver( observer<T>* p_observer )
+    {
+        m_observer = p_observer;
+    }
+    
+    
     /** trains the prototypes from the data
      * @param p_data Matrix with data (rows are the vectors)
      * @param p_labels vector for labels
@@ -237,6 +293,10 @@ namespace machinelearning { namespace clustering { namespace supervised {
         }
         
         
+        // winner of each datapoint for the convergence check (only if the assignment criterion is enabled)
+        std::vector<std::size_t> l_assign( m_convergence.useAssignmentChanges() ? p_data.size1() : 0 );
+        m_convergence.reset();
+        
         for(std::size_t i=0; i < p_iterations; ++i) {
             
             // determine quantization error for logging
@@ -245,32 +305,60 @@ namespace machinelearning { namespace clustering { namespace supervised {
                 m_quantizationerror.push_back( calculateQuantizationError(p_data) );
             }
             
-            #pragma omp parallel for shared(l_lambda)
-            for (std::size_t j=0; j < p_data.size1(); ++j) {
-                
-                // calculate weighted distance and rank vector elements, the first element is the index of the winner prototype
-                ublas::vector<T> l_distance          = m_distance.getWeightedDistance( m_prototypes, ublas::row(p_data, j), l_lambda );
-                const ublas::indirect_array<> l_rank = tools::vector::rankIndex( l_distance );
-                
-                // calculate adapt values
-                const ublas::vector<T> l_winnerdelta    = p_lambda * (ublas::row(p_data, j) - ublas::row(m_prototypes, l_rank(0) ));
-                const ublas::vector<T> l_lambdaadapt    = p_eta    * ublas::element_prod(ublas::row(l_lambda, l_rank(0)), m_distance.getAbs(l_winnerdelta));
+            const ublas::matrix<T> l_previous( m_convergence.useShift() ? m_prototypes : ublas::matrix<T>() );
+            
+            #pragma omp parallel shared(l_lambda, l_assign)
+            {
+                // adapt buffers of each thread, so they are not allocated for each data point
+                ublas::vector<T> l_winnerdelta( p_data.size2() );
+                ublas::vector<T> l_lambdaadapt( p_data.size2() );
+                ublas::vector<T> l_lambdarow( p_data.size2() );
                 
-                // label checking and adaption for winner and lambda
-                #pragma omp critical
-                {
-                    if (  m_neuronlabels[l_rank(0)] == p_labels[j] ) {
-                        ublas::row(m_prototypes, l_rank(0) ) += l_winnerdelta;
-                        ublas::row(l_lambda, l_rank(0))      -= l_lambdaadapt;
-                    } else {
-                        ublas::row(m_prototypes, l_rank(0) ) -= l_winnerdelta;
-                        ublas::row(l_lambda, l_rank(0))      += l_lambdaadapt;
-                    }
+                #pragma omp for
+                for (std::size_t j=0; j < p_data.size1(); ++j) {
+                    
+                    // determine the index of the winner prototype with the weighted distance
+                    const std::size_t l_winner = m_distance.getWeightedNearest( p_data, j, m_prototypes, l_lambda );
+                    if (!l_assign.empty())
+                        l_assign[j] = l_winner;
+                    
+                    // calculate adapt values
+                    ublas::noalias(l_winnerdelta)   = ublas::row(p_data, j) - ublas::row(m_prototypes, l_winner );
+                    l_winnerdelta                  *= p_lambda;
+                    ublas::noalias(l_lambdaadapt)   = l_winnerdelta;
+                    m_distance.abs( l_lambdaadapt );
                     
-                    // normalize lambda (only one row, which has been changed)
-                    ublas::row(l_lambda, l_rank(0))  /= m_distance.getLength( static_cast< ublas::vector<T> >(ublas::row(l_lambda, l_rank(0))) );
+                    // label checking and adaption for winner and lambda
+                    #pragma omp critical
+                    {
+                        ublas::noalias(l_lambdaadapt) = p_eta * ublas::element_prod(ublas::row(l_lambda, l_winner), l_lambdaadapt);
+                        
+                        if (  m_neuronlabels[l_winner] == p_labels[j] ) {
+                            ublas::row(m_prototypes, l_winner ) += l_winnerdelta;
+                            ublas::row(l_lambda, l_winner)      -= l_lambdaadapt;
+                        } else {
+                            ublas::row(m_prototypes, l_winner ) -= l_winnerdelta;
+                            ublas::row(l_lambda, l_winner)      += l_lambdaadapt;
+                        }
+                        
+                        // normalize lambda (only one row, which has been changed)
+                        ublas::noalias(l_lambdarow)      = ublas::row(l_lambda, l_winner);
+                        ublas::row(l_lambda, l_winner)  /= m_distance.getLength( l_lambdarow );
+                    }
                 }
             }
+            
+            // determine quantization error for observing and convergence check
+            const bool l_observed = m_observer && m_observer->isObserved(i);
+            T l_error = 0;
+            if (m_convergence.useErrorChange() || (l_observed && m_observer->useError()))
+                l_error = calculateQuantizationError(p_data);
+            
+            if (l_observed)
+                m_observer->notify( i, m_prototypes, l_error );
+            
+            if (m_convergence.isConverged( l_previous, m_prototypes, l_error, l_assign.empty() ? ublas::indirect_array<>() : tools::vector::toIndirectArray(l_assign) ))
+                break;
         }
     }
     
@@ -282,12 +370,7 @@ namespace machinelearning { namespace clustering { namespace supervised {
      **/
     template<typename T, typename L> inline T rlvq<T, L>::calculateQuantizationError( const ublas::matrix<T>& p_data ) const
     {
-        ublas::matrix<T> l_distances( m_prototypes.size1(), p_data.size1() );
-        
-        #pragma omp parallel for shared(l_distances)
-        for(std::size_t i=0; i < m_prototypes.size1(); ++i)
-            ublas::row(l_distances, i) = m_distance.getDistance( p_data, ublas::row(m_prototypes, i) );
-        
+        const ublas::matrix<T> l_distances = m_distance.getPairwiseDistance( m_prototypes, p_data );
         return 0.5 * ublas::sum(  m_distance.getAbs(tools::matrix::min(l_distances, tools::matrix::column))  );  
     }
     
@@ -302,18 +385,7 @@ namespace machinelearning { namespace clustering { namespace supervised {
         if (p_data.size2() != m_prototypes.size2())
             throw exception::runtime( _("data and prototype dimension are not equal"), *this );
         
-        ublas::indirect_array<> l_idx(p_data.size1());
-        #pragma omp parallel for shared(l_idx)
-        for(std::size_t i=0; i < p_data.size1(); ++i) {
-            
-            // calculate distance from datapoint to all prototyps and rank position
-            ublas::vector<T> l_distance       = m_distance.getDistance( m_prototypes, ublas::row(p_data, i)  );
-            ublas::indirect_array<> l_rank    = tools::vector::rankIndex( l_distance );
-            
-            // add index
-            l_idx[i] = l_rank(0);
-        }
-        return l_idx;
+        return m_distance.getNearest( p_data, m_prototypes );
     }
 
 
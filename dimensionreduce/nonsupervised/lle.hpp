@@ -25,25 +25,28 @@
 #define __MACHINELEARNING_DIMENSIONREDUCE_NONSUPERVISED_LLE_HPP
 
 
+#include <limits>
+
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/matrix_sparse.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include "reduce.hpp"
 #include "../../neighborhood/neighborhood.h"
 #include "../../errorhandling/exception.hpp"
 #include "../../tools/tools.h"
 
-#include <iostream>
-#include <boost/numeric/ublas/io.hpp>
-
 
 namespace machinelearning { namespace dimensionreduce { namespace nonsupervised {
     
     namespace ublas  = boost::numeric::ublas;
     
     
-    /** create the local linear embedding (LLE) **/
+    /** create the local linear embedding (LLE). New datapoints are embedded with the
+     * reconstruction weights of their nearest fitted datapoints
+     * @see Saul & Roweis, Think Globally, Fit Locally: Unsupervised Learning of Low Dimensional Manifolds, JMLR 4, 2003
+     **/
     template<typename T> class lle : public reduce<T>
     {
         
@@ -51,6 +54,7 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
         
             lle( const neighborhood::neighborhood<T>&, const std::size_t& );
             ublas::matrix<T> map( const ublas::matrix<T>& );
+            ublas::matrix<T> transform( const ublas::matrix<T>& ) const;
             std::size_t getDimension( void ) const;
         
         
@@ -60,6 +64,13 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
             const neighborhood::neighborhood<T>& m_neighborhood;
             /** target dimension **/
             const std::size_t m_dim;
+            /** fitted data **/
+            ublas::matrix<T> m_data;
+            /** mapped fitted data **/
+            ublas::matrix<T> m_target;
+        
+        
+            ublas::matrix<T> getWeights( const ublas::matrix<T>&, const ublas::matrix<std::size_t>&, const ublas::matrix<T>&, const bool& ) const;
         
     };
 
@@ -71,7 +82,9 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
      **/
     template<typename T> inline lle<T>::lle( const neighborhood::neighborhood<T>& p_neighborhood, const std::size_t& p_dim ) :
         m_neighborhood( p_neighborhood ),
-        m_dim( p_dim )
+        m_dim( p_dim ),
+        m_data(),
+        m_target()
     {
         if (p_dim == 0)
             throw exception::runtime(_("dimension must be greater than zero"), *this);
@@ -89,7 +102,6 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
     
     /** caluate and project the input data
      * @todo project matrix change to a sparse matrix if arpack can used with boost
-     * @bug it is uncomplete
      * @param p_data input datamatrix
      * @return matrix with mapped points
      **/
@@ -97,37 +109,13 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
     {
         if (p_data.size2() <= m_dim)
             throw exception::runtime(_("data points are less than target dimension"), *this);
+        if (p_data.size1() <= m_dim)
+            throw exception::runtime(_("number of data points must be greater than target dimension"), *this);
         
-        // if number of neighborhood greate than data dimension (column size)
-        // regularize weight-matrix
-        const T l_tolerance = 1.0/10000.0;
-        const ublas::matrix<T> l_regular = tools::matrix::diag<T>( ublas::vector<T>(m_neighborhood.getNeighborCount(), l_tolerance) );
-        const bool l_regularize = m_neighborhood.getNeighborCount() > p_data.size2();
-        
-        // calculate neighborhood index and create some structires
-        const ublas::scalar_vector<T> l_ones(m_neighborhood.getNeighborCount(), 1);
+        // calculate neighborhood index and the weight matrix, if number of neighborhood
+        // greate than data dimension (column size) regularize weight-matrix
         const ublas::matrix<std::size_t> l_neighborhood = m_neighborhood.get( p_data );
-        ublas::matrix<T> l_weight(p_data.size1(), m_neighborhood.getNeighborCount());
-        
-        // calculate weight matrix
-        for(std::size_t i=0; i < p_data.size1(); ++i) {
-        
-            // subtract every point from their neighbors (centering neighbors to the point)
-            ublas::matrix<T> l_local( m_neighborhood.getNeighborCount(), p_data.size2() );
-            for(std::size_t j=0; j < m_neighborhood.getNeighborCount(); ++j)
-                ublas::row(l_local, j) = ublas::row(p_data, l_neighborhood(i, j)) - ublas::row(p_data, i);
-                    
-            // symmetrize matrix (add tolerance)
-            ublas::vector<T> l_result;
-            ublas::matrix<T> l_localweight = ublas::prod(l_local, ublas::trans(l_local));
-            
-            if (l_regularize)
-                l_localweight += l_regular * tools::matrix::trace<T>(l_localweight);
-
-            // solve the lineare equation and normalize
-            tools::lapack::solve<T>( l_localweight, l_ones, l_result );
-            ublas::row(l_weight, i) = l_result / ublas::sum(l_result);
-        }
+        const ublas::matrix<T> l_weight                 = getWeights( p_data, l_neighborhood, p_data, m_neighborhood.getNeighborCount() > p_data.size2() );
  
         
         // create weight matrix (I-W)' * (I-W) for the data
@@ -147,15 +135,88 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
             }
         }
         
-        // calculate the eigenvalues & -vectors
+        // calculate the eigenvectors of the smallest eigenvalues (the matrix is symmetric), the
+        // smallest eigenvector is the constant vector with eigenvalue zero, so it is not used
         ublas::vector<T> l_eigenvalues;
         ublas::matrix<T> l_eigenvectors;
-        tools::lapack::eigen<T>(l_project, l_eigenvalues, l_eigenvectors);
-         
-        std::cout << l_eigenvalues << std::endl;
+        tools::lapack::eigensymmetric<T>(l_project, l_eigenvalues, l_eigenvectors, m_dim+1, tools::lapack::smallest);
+        
+        // data and mapping are stored for the out-of-sample extension
+        m_data   = p_data;
+        m_target = ublas::subrange(l_eigenvectors, 0, l_eigenvectors.size1(), 1, l_eigenvectors.size2());
+        
+        return m_target;
+    }
+    
+    
+    /** maps new datapoints with the fitted model. Each new datapoint is reconstructed by the weights of
+     * its nearest fitted datapoints and the mapped points of these neighbors are combined with the same weights
+     * @param p_data input datamatrix
+     * @return matrix with mapped points
+     **/
+    template<typename T> inline ublas::matrix<T> lle<T>::transform( const ublas::matrix<T>& p_data ) const
+    {
+        if (m_target.size1() == 0)
+            throw exception::runtime(_("projection is not fitted"), *this);
+        if (p_data.size2() != m_data.size2())
+            throw exception::runtime(_("datapoint dimension must be equal to the fitted data"), *this);
+        
+        // the weights are always regularized, because a new point can be equal to a fitted point
+        const ublas::matrix<std::size_t> l_neighborhood = m_neighborhood.get( m_data, p_data );
+        const ublas::matrix<T> l_weight                 = getWeights( m_data, l_neighborhood, p_data, true );
+        
+        ublas::matrix<T> l_target( p_data.size1(), m_target.size2(), static_cast<T>(0) );
+        for(std::size_t i=0; i < l_target.size1(); ++i)
+            for(std::size_t j=0; j < l_weight.size2(); ++j)
+                ublas::row(l_target, i) += l_weight(i, j) * ublas::row(m_target, l_neighborhood(i, j));
+        
+        return l_target;
+    }
+    
+    
+    /** calculates the reconstruction weights of every point with their neighbors
+     * @param p_reference data, that is indexed by the neighborhood
+     * @param p_neighborhood neighborhood index for every point (rows = points)
+     * @param p_points datapoints, that are reconstructed
+     * @param p_regularize regularize the local covariance
+     * @note if all neighbors coincide with the point, the local covariance is zero and
+     * the point gets uniform weights
+     * @return weight matrix (rows = points, columns = neighbors)
+     **/
+    template<typename T> inline ublas::matrix<T> lle<T>::getWeights( const ublas::matrix<T>& p_reference, const ublas::matrix<std::size_t>& p_neighborhood, const ublas::matrix<T>& p_points, const bool& p_regularize ) const
+    {
+        const T l_tolerance = 1.0/10000.0;
+        const ublas::matrix<T> l_regular = tools::matrix::diag<T>( ublas::vector<T>(p_neighborhood.size2(), l_tolerance) );
+        const ublas::scalar_vector<T> l_ones(p_neighborhood.size2(), 1);
+        ublas::matrix<T> l_weight(p_points.size1(), p_neighborhood.size2());
+        
+        for(std::size_t i=0; i < p_points.size1(); ++i) {
         
-        return l_eigenvectors;
+            // subtract every point from their neighbors (centering neighbors to the point)
+            ublas::matrix<T> l_local( p_neighborhood.size2(), p_points.size2() );
+            for(std::size_t j=0; j < p_neighborhood.size2(); ++j)
+                ublas::row(l_local, j) = ublas::row(p_reference, p_neighborhood(i, j)) - ublas::row(p_points, i);
+                    
+            // symmetrize matrix (add tolerance)
+            ublas::vector<T> l_result;
+            ublas::matrix<T> l_localweight = ublas::prod(l_local, ublas::trans(l_local));
+            const T l_trace = tools::matrix::trace<T>(l_localweight);
+            
+            // the regularization is zero, so every neighbor reconstructs the point
+            if (l_trace <= std::numeric_limits<T>::epsilon()) {
+                ublas::row(l_weight, i) = ublas::scalar_vector<T>(p_neighborhood.size2(), static_cast<T>(1) / p_neighborhood.size2());
+                continue;
+            }
+            
+            if (p_regularize)
+                l_localweight += l_regular * l_trace;
+
+            // solve the lineare equation and normalize
+            tools::lapack::solve<T>( l_localweight, l_ones, l_result );
+            ublas::row(l_weight, i) = l_result / ublas::sum(l_result);
+        }
         
+        return l_weight;
     }
 
 }}}
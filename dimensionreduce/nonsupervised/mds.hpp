@@ -49,7 +49,12 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
     #endif
     
     
-    /** create the multidimensional scaling (MDS) with different algorithms **/
+    /** create the multidimensional scaling (MDS) with different algorithms. New datapoints (dissimilarities
+     * to the mapped datapoints) are embedded with the Nystroem extension (metric) or with the landmark
+     * triangulation (sammon / hit)
+     * @see Bengio et al., Out-of-Sample Extensions for LLE, Isomap, MDS, Eigenmaps, and Spectral Clustering, NIPS 2003
+     * @see de Silva & Tenenbaum, Sparse multidimensional scaling using landmark points, Technical report, Stanford, 2004
+     **/
     template<typename T> class mds : public reduce<T>
         #ifdef MACHINELEARNING_MPI
         , public reducempi<T>
@@ -77,6 +82,7 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
         
             mds( const std::size_t&, const project& = metric );
             ublas::matrix<T> map( const ublas::matrix<T>& );
+            ublas::matrix<T> transform( const ublas::matrix<T>& ) const;
             std::size_t getDimension( void ) const;
             void setIteration( const std::size_t& );
             void setStep( const std::size_t& );
@@ -102,8 +108,25 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
             const project m_type;
             /** centering **/
             centeroption m_centering;
-            
-            
+            /** centering option of the fitted data **/
+            centeroption m_fitcentering;
+            /** column mean of the fitted data (single centering) **/
+            ublas::vector<T> m_center;
+            /** diagonal of the fitted data (double centering) **/
+            ublas::vector<T> m_diagonal;
+            /** out-of-sample projection matrix (rows = number of fitted datapoints) **/
+            ublas::matrix<T> m_project;
+            /** mean squared distance of every mapped datapoint to all other (landmark triangulation) **/
+            ublas::vector<T> m_distancemean;
+            /** mean of the mapped datapoints (landmark triangulation) **/
+            ublas::vector<T> m_targetmean;
+            /** scale between the dissimilarities and the distances of the mapped datapoints (landmark triangulation) **/
+            T m_scale;
+            
+            
+            ublas::matrix<T> preprocess( const ublas::matrix<T>& ) const;
+            void setNystroem( const ublas::matrix<T>&, const ublas::matrix<T>& );
+            void setLandmark( const ublas::matrix<T>&, const ublas::matrix<T>& );
             ublas::matrix<T> project_metric( const ublas::matrix<T>& ) const;
             ublas::matrix<T> project_sammon( const ublas::matrix<T>& ) const;
             ublas::matrix<T> project_hit( const ublas::matrix<T>& ) const;
@@ -131,7 +154,14 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
         m_rate( 1 ),
         m_dim( p_dim ),
         m_type( p_type ),
-        m_centering( none )
+        m_centering( none ),
+        m_fitcentering( none ),
+        m_center(),
+        m_diagonal(),
+        m_project(),
+        m_distancemean(),
+        m_targetmean(),
+        m_scale( 1 )
     {
         if (p_dim == 0)
             throw exception::runtime(_("dimension must be greater than zero"), *this);
@@ -192,16 +222,19 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
         if (p_data.size2() <= m_dim)
             throw exception::runtime(_("datapoint dimension are less than target dimension"), *this);
                 
-        // do centering
+        // do centering (the centering values are stored for the out-of-sample extension)
         ublas::matrix<T> l_data = p_data;
+        m_fitcentering          = m_centering;
         switch (m_centering) {
                 
             case singlecenter :
-                l_data = tools::matrix::centering(l_data);
+                m_center = tools::matrix::mean(l_data, tools::matrix::column);
+                l_data   = tools::matrix::centering(l_data);
                 break;
                 
             case doublecenter :
-                l_data = tools::matrix::doublecentering(l_data);
+                m_diagonal = tools::matrix::diag(l_data);
+                l_data     = tools::matrix::doublecentering(l_data);
                 break;
                 
             default : break;
@@ -209,22 +242,163 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
         
         
         // do project
+        ublas::matrix<T> l_target;
         switch (m_type) {
                 
             case metric:
                 // we use a stable matrix for eigendecompsition
-                return project_metric( 1.0/l_data.size1() * ublas::prod(l_data, ublas::trans(l_data)) );
+                l_target = project_metric( 1.0/l_data.size1() * ublas::prod(l_data, ublas::trans(l_data)) );
+                setNystroem( l_data, l_target );
+                break;
             
             case sammon:
-                return project_sammon(l_data);
+                l_target = project_sammon(l_data);
+                setLandmark( l_data, l_target );
+                break;
                 
             case hit :
-                return project_hit(l_data);
+                l_target = project_hit(l_data);
+                setLandmark( l_data, l_target );
+                break;
                        
             default :
                 throw exception::runtime(_("project option is unkown"), *this);
 
         };
+        
+        return l_target;
+    }
+    
+    
+    /** maps new datapoints with the fitted model. Every row holds the dissimilarities of one new datapoint
+     * to all datapoints of the last map call (the dissimilarity of a datapoint to itself is zero)
+     * @param p_data dissimilarity matrix (rows = new datapoints, columns = fitted datapoints)
+     * @return mapped data
+     **/
+    template<typename T> inline ublas::matrix<T> mds<T>::transform( const ublas::matrix<T>& p_data ) const
+    {
+        if (m_project.size1() == 0)
+            throw exception::runtime(_("projection is not fitted"), *this);
+        if (p_data.size2() != m_project.size1())
+            throw exception::runtime(_("number of columns must be equal to the number of fitted datapoints"), *this);
+        
+        const ublas::matrix<T> l_data = preprocess(p_data);
+        
+        // Nystroem extension, the kernel row of a new point is projected onto the scaled eigenvectors
+        if (m_type == metric)
+            return ublas::prod(l_data, m_project);
+        
+        // landmark triangulation with the squared dissimilarities
+        ublas::matrix<T> l_delta( l_data.size1(), l_data.size2() );
+        #pragma omp parallel for shared(l_delta)
+        for(std::size_t i=0; i < l_delta.size1(); ++i)
+            for(std::size_t j=0; j < l_delta.size2(); ++j)
+                l_delta(i,j) = m_distancemean(j) - m_scale * m_scale * l_data(i,j) * l_data(i,j);
+        
+        ublas::matrix<T> l_target = ublas::prod(l_delta, m_project);
+        for(std::size_t i=0; i < l_target.size1(); ++i)
+            ublas::row(l_target, i) += m_targetmean;
+        
+        return l_target;
+    }
+    
+    
+    /** applies the centering of the fitted data to rows of new dissimilarities
+     * @param p_data dissimilarity matrix (rows = new datapoints, columns = fitted datapoints)
+     * @return centered matrix
+     **/
+    template<typename T> inline ublas::matrix<T> mds<T>::preprocess( const ublas::matrix<T>& p_data ) const
+    {
+        ublas::matrix<T> l_data( p_data );
+        
+        switch (m_fitcentering) {
+                
+            case singlecenter :
+                for(std::size_t i=0; i < l_data.size1(); ++i)
+                    ublas::row(l_data, i) -= m_center;
+                break;
+                
+            case doublecenter :
+                // D(i,i) + D(j,j) - (D(i,j) + D(j,i)) with D(i,i) = 0 for the new point and a symmetric dissimilarity
+                for(std::size_t i=0; i < l_data.size1(); ++i)
+                    ublas::row(l_data, i) = m_diagonal - static_cast<T>(2) * ublas::row(p_data, i);
+                break;
+                
+            default : break;
+        };
+        
+        return l_data;
+    }
+    
+    
+    /** creates the Nystroem projection of the metric MDS. The mapped points are Y = U * S^0.5 with the
+     * eigen decomposition U * S * U^T of the kernel K = 1/N * D * D^T, so a new kernel row k = 1/N * d * D^T
+     * is mapped with k * U * S^-0.5 = d * (1/N * D^T * Y * S^-1) and the eigenvalues are the squared column norms of Y
+     * @param p_data centered fitted data
+     * @param p_target mapped data
+     **/
+    template<typename T> inline void mds<T>::setNystroem( const ublas::matrix<T>& p_data, const ublas::matrix<T>& p_target )
+    {
+        m_project = ublas::prod( ublas::trans(p_data), p_target ) / static_cast<T>(p_data.size1());
+        
+        for(std::size_t i=0; i < m_project.size2(); ++i) {
+            const T l_eigenvalue = ublas::inner_prod( ublas::column(p_target, i), ublas::column(p_target, i) );
+            
+            if (l_eigenvalue > 0)
+                ublas::column(m_project, i) /= l_eigenvalue;
+            else
+                ublas::column(m_project, i) = ublas::zero_vector<T>( m_project.size1() );
+        }
+        
+        m_distancemean.resize( 0, false );
+        m_targetmean.resize( 0, false );
+    }
+    
+    
+    /** creates the landmark triangulation for the mapped points, every mapped point is used as landmark.
+     * A new point with the squared distances d to the landmarks is mapped to y = 0.5 * (d_mean - d) * Yc * (Yc^T * Yc)^-1 + mean,
+     * with the centered landmarks Yc and the mean squared distance d_mean of every landmark to the other landmarks.
+     * The dissimilarities are scaled to the mapped distances, because HIT-MDS preserves only the correlation
+     * @param p_data centered fitted data
+     * @param p_target mapped data
+     **/
+    template<typename T> inline void mds<T>::setLandmark( const ublas::matrix<T>& p_data, const ublas::matrix<T>& p_target )
+    {
+        // least-squares scale between the dissimilarities and the distances of the mapped points
+        T l_product = 0;
+        T l_square  = 0;
+        for(std::size_t i=0; i < p_target.size1(); ++i)
+            for(std::size_t j=0; j < p_target.size1(); ++j) {
+                l_product += p_data(i,j) * ublas::norm_2( ublas::row(p_target, i) - ublas::row(p_target, j) );
+                l_square  += p_data(i,j) * p_data(i,j);
+            }
+        m_scale = (l_square > 0) ? l_product / l_square : static_cast<T>(1);
+        
+        m_targetmean = tools::matrix::mean(p_target, tools::matrix::column);
+        
+        ublas::matrix<T> l_center( p_target );
+        for(std::size_t i=0; i < l_center.size1(); ++i)
+            ublas::row(l_center, i) -= m_targetmean;
+        
+        // squared distance of a centered point to all other points is |y_j|^2 + mean(|y_i|^2)
+        m_distancemean.resize( l_center.size1(), false );
+        for(std::size_t i=0; i < l_center.size1(); ++i)
+            m_distancemean(i) = ublas::inner_prod( ublas::row(l_center, i), ublas::row(l_center, i) );
+        m_distancemean += ublas::scalar_vector<T>( m_distancemean.size(), ublas::sum(m_distancemean) / m_distancemean.size() );
+        
+        // pseudo inverse of the symmetric matrix Yc^T * Yc
+        ublas::vector<T> l_eigenvalues;
+        ublas::matrix<T> l_eigenvectors;
+        tools::lapack::eigensymmetric<T>( ublas::prod(ublas::trans(l_center), l_center), l_eigenvalues, l_eigenvectors );
+        
+        ublas::matrix<T> l_scaled( l_eigenvectors );
+        for(std::size_t i=0; i < l_scaled.size2(); ++i)
+            if (l_eigenvalues(i) > std::numeric_limits<T>::epsilon() * l_eigenvalues(0) * l_scaled.size1())
+                ublas::column(l_scaled, i) /= l_eigenvalues(i);
+            else
+                ublas::column(l_scaled, i) = ublas::zero_vector<T>( l_scaled.size1() );
+        
+        m_project = static_cast<T>(0.5) * ublas::prod( l_center, ublas::matrix<T>(ublas::prod(l_scaled, ublas::trans(l_eigenvectors))) );
     }
     
     
@@ -235,20 +409,17 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
      **/
     template<typename T> inline ublas::matrix<T> mds<T>::project_metric( const ublas::matrix<T>& p_data ) const
     {
-        // calculate the eigenvalues & -vectors
+        // calculate the eigenvalues & -vectors of the largest eigenvalues (the matrix is symmetric)
         ublas::vector<T> l_eigenvalues;
         ublas::matrix<T> l_eigenvectors;
-        tools::lapack::eigen<T>(p_data, l_eigenvalues, l_eigenvectors);
-        
-        // rank the eigenvalues
-        const ublas::indirect_array<> l_rank = tools::vector::rankIndex( l_eigenvalues );
+        tools::lapack::eigensymmetric<T>(p_data, l_eigenvalues, l_eigenvectors, m_dim);
         
-        // create projection (largest eigenvectors correspondends with the largest eigenvalues -> last values in rank)
-        ublas::matrix<T> l_project( l_eigenvectors.size2(), m_dim );
+        // create projection (largest eigenvector is the last column)
+        ublas::matrix<T> l_project( l_eigenvectors.size1(), m_dim );
         ublas::matrix<T> l_values(m_dim, m_dim, 0);
         for(std::size_t i=0; i < m_dim; ++i) {
-            ublas::column(l_project, m_dim-i-1) = ublas::column(l_eigenvectors, l_rank(l_rank.size()-i-1));
-            l_values(m_dim-i-1, m_dim-i-1) = std::pow(l_eigenvalues(l_rank(l_rank.size()-i-1)), static_cast<T>(0.5));
+            ublas::column(l_project, m_dim-i-1) = ublas::column(l_eigenvectors, i);
+            l_values(m_dim-i-1, m_dim-i-1) = std::pow(l_eigenvalues(i), static_cast<T>(0.5));
         }
         
         return ublas::prod(l_project, l_values);
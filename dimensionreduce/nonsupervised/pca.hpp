@@ -24,8 +24,15 @@
 #ifndef __MACHINELEARNING_DIMENSIONREDUCE_NONSUPERVISED_PCA_HPP
 #define __MACHINELEARNING_DIMENSIONREDUCE_NONSUPERVISED_PCA_HPP
 
+#include <cmath>
+#include <limits>
+#include <algorithm>
 #include <boost/static_assert.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/bindings/blas.hpp>
+#include <boost/numeric/bindings/trans.hpp>
+#include <boost/numeric/bindings/ublas/matrix.hpp>
 
 #include "reduce.hpp"
 #include "../../errorhandling/exception.hpp"
@@ -36,10 +43,16 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
     
     #ifndef SWIG
     namespace ublas  = boost::numeric::ublas;
+    namespace blas   = boost::numeric::bindings::blas;
+    namespace bind   = boost::numeric::bindings;
     #endif
     
     
-    /** create the principal component analysis (PCA) **/
+    /** create the principal component analysis (PCA). The projection is calculated with a full
+     * eigen decomposition or with a randomized truncated SVD, that can read the data in row blocks.
+     * The model can be updated incrementally with data batches (incremental SVD)
+     * @see Ross, Lim, Lin & Yang, Incremental Learning for Robust Visual Tracking, IJCV 77, 2008
+     **/
     template<typename T> class pca : public reduce<T>
     {
         #ifndef SWIG
@@ -49,18 +62,46 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
         
         public :
             
-            pca( const std::size_t& );
+            enum method
+            {
+                full        = 0,
+                randomized  = 1
+            };
+            
+            
+            pca( const std::size_t&, const method& = full, const std::size_t& = 1, const std::size_t& = 10 );
             ublas::matrix<T> map( const ublas::matrix<T>& );
             std::size_t getDimension( void ) const;
             ublas::matrix<T> getProject( void ) const;
+            ublas::vector<T> getCenter( void ) const;
+            ublas::vector<T> getSingularValues( void ) const;
+            std::size_t getCount( void ) const;
+            void fitbatch( const ublas::matrix<T>& );
+            ublas::matrix<T> transform( const ublas::matrix<T>& ) const;
+        
+            #ifndef SWIG
+            void fit( const tools::rowblocks<T>&, const std::size_t& = 4096 );
+            #endif
         
         
         private :
             
             /** target dimension **/
             const std::size_t m_dim;
+            /** method for calculating the projection **/
+            const method m_method;
+            /** number of power iterations of the randomized method **/
+            const std::size_t m_iterations;
+            /** number of additional random vectors of the randomized method **/
+            const std::size_t m_oversampling;
             /** matrix with project vectors **/
             ublas::matrix<T> m_project;
+            /** mean of the data **/
+            ublas::vector<T> m_center;
+            /** singular values of the centered data **/
+            ublas::vector<T> m_singularvalues;
+            /** number of datapoints, that are used for the model **/
+            std::size_t m_count;
         
     };
     
@@ -68,10 +109,19 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
     
     /** constructor
      * @param p_dim target dimension
+     * @param p_method full eigen decomposition or randomized SVD
+     * @param p_iterations number of power iterations (only randomized method)
+     * @param p_oversampling number of additional random vectors (only randomized method)
     **/
-    template<typename T> inline pca<T>::pca( const std::size_t& p_dim ) :
+    template<typename T> inline pca<T>::pca( const std::size_t& p_dim, const method& p_method, const std::size_t& p_iterations, const std::size_t& p_oversampling ) :
         m_dim( p_dim ),
-        m_project()
+        m_method( p_method ),
+        m_iterations( p_iterations ),
+        m_oversampling( p_oversampling ),
+        m_project(),
+        m_center(),
+        m_singularvalues(),
+        m_count( 0 )
     {
         if (p_dim == 0)
             throw exception::runtime(_("dimension must be greater than zero"), *this);
@@ -96,6 +146,33 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
     }
     
     
+    /** returns the mean of the data, that is subtracted before projecting
+     * @return mean vector
+     **/
+    template<typename T> inline ublas::vector<T> pca<T>::getCenter( void ) const
+    {
+        return m_center;
+    }
+    
+    
+    /** returns the singular values of the centered data, that belong to the project vectors
+     * @return singular value vector
+     **/
+    template<typename T> inline ublas::vector<T> pca<T>::getSingularValues( void ) const
+    {
+        return m_singularvalues;
+    }
+    
+    
+    /** returns the number of datapoints, that are used for the model
+     * @return number of datapoints
+     **/
+    template<typename T> inline std::size_t pca<T>::getCount( void ) const
+    {
+        return m_count;
+    }
+    
+    
     /** caluate and project the input data
      * @param p_data input datamatrix
     **/
@@ -109,27 +186,156 @@ namespace machinelearning { namespace dimensionreduce { namespace nonsupervised
             throw exception::runtime(_("datapoint dimension are less than target dimension"), *this);
         
         // centering the data
+        m_center = tools::matrix::mean<T>(p_data, tools::matrix::column);
         ublas::matrix<T> l_center = tools::matrix::centering<T>(p_data);
         
-        // creates if needed the covarianz matrix or create matrix product
-        ublas::matrix<T> l_data;
-        if (l_center.size2() < l_center.size1())
-            l_data = tools::matrix::cov<T>(l_center);
-        else
-            l_data =  (1.0 / l_center.size1()) * ublas::prod(ublas::trans(l_center), l_center);
-        
-        // calculate the eigenvalues & -vectors
-        ublas::vector<T> l_eigenvalues;
-        ublas::matrix<T> l_eigenvectors;
-        tools::lapack::eigen<T>(l_data, l_eigenvalues, l_eigenvectors);
-               
-        // rank the eigenvalues
-        const ublas::indirect_array<> l_rank = tools::vector::rankIndex( l_eigenvalues );
-                
-        // create projection (largest eigenvectors correspondends with the largest eigenvalues -> last values in rank)
-        m_project = ublas::matrix<T>( l_eigenvectors.size2(), m_dim );
-        for(std::size_t i=0; i < m_dim; ++i)
-            ublas::column(m_project, i) = ublas::column(l_eigenvectors, l_rank(l_rank.size()-i-1));
+        if (m_method == randomized)
+            tools::lapack::randomizedsvd( tools::matrixrowblocks<T>(l_center), m_singularvalues, m_project, m_dim, m_iterations, m_oversampling );
+        else {
+            // creates if needed the covarianz matrix or create matrix product
+            ublas::matrix<T> l_data;
+            T l_norm = static_cast<T>(l_center.size1());
+            if (l_center.size2() < l_center.size1()) {
+                l_data = tools::matrix::cov<T>(l_center);
+                l_norm = static_cast<T>(l_center.size1()-1);
+            } else
+                l_data =  (1.0 / l_center.size1()) * ublas::prod(ublas::trans(l_center), l_center);
+            
+            // calculate the eigenvectors of the largest eigenvalues (the matrix is symmetric)
+            // and create the projection with them, the eigenvalues are changed to the singular values
+            tools::lapack::eigensymmetric<T>(l_data, m_singularvalues, m_project, m_dim);
+            for(std::size_t i=0; i < m_singularvalues.size(); ++i)
+                m_singularvalues(i) = std::sqrt( std::max(m_singularvalues(i), static_cast<T>(0)) * l_norm );
+        }
+        m_count = p_data.size1();
+        
+        return ublas::prod(l_center, m_project);
+    }
+    
+    
+    /** calculates the projection of a data matrix, that is read in row blocks, with the
+     * randomized SVD (independent of the method option). The data is read once for the mean
+     * and (power iterations + 1) times for the projection, the projected data is not returned
+     * @param p_data row blocks of the data matrix
+     * @param p_blocksize number of rows, that are read at once
+     **/
+    template<typename T> inline void pca<T>::fit( const tools::rowblocks<T>& p_data, const std::size_t& p_blocksize )
+    {
+        if (p_data.size1() == 0)
+            throw exception::runtime(_("row size must be greater than zero"), *this);
+        if (p_data.size2() <= m_dim)
+            throw exception::runtime(_("datapoint dimension are less than target dimension"), *this);
+        if (p_blocksize == 0)
+            throw exception::runtime(_("block size must be greater than zero"), *this);
+        
+        m_center = ublas::zero_vector<T>( p_data.size2() );
+        for(std::size_t i=0; i < p_data.size1(); i += p_blocksize)
+            m_center += tools::matrix::sum<T>( p_data.getRows(i, p_blocksize), tools::matrix::column );
+        m_center /= static_cast<T>(p_data.size1());
+        
+        tools::lapack::randomizedsvd( p_data, m_singularvalues, m_project, m_dim, m_iterations, m_oversampling, m_center, p_blocksize );
+        m_count = p_data.size1();
+    }
+    
+    
+    /** updates the model with a batch of data, so the data can be read chunk by chunk
+     * and the projection is available after each batch without refitting. The new batch is
+     * combined with the current model (singular values * project vectors) and the mean
+     * correction, the SVD of this small matrix is calculated with the eigen decomposition of
+     * its gram matrix. The first batch (or map / fit) creates the model
+     * @param p_data data batch (every row is a datapoint)
+     **/
+    template<typename T> inline void pca<T>::fitbatch( const ublas::matrix<T>& p_data )
+    {
+        if (p_data.size1() == 0)
+            throw exception::runtime(_("row size must be greater than zero"), *this);
+        if (p_data.size2() <= m_dim)
+            throw exception::runtime(_("datapoint dimension are less than target dimension"), *this);
+        if ((m_count > 0) && (p_data.size2() != m_center.size()))
+            throw exception::runtime(_("datapoint dimension must be equal to the fitted data"), *this);
+        
+        const ublas::vector<T> l_mean = tools::matrix::mean<T>(p_data, tools::matrix::column);
+        const std::size_t l_model     = (m_count > 0) ? m_singularvalues.size() : 0;
+        
+        // stack the model, the centered batch and the mean correction (the first batch has no model)
+        ublas::matrix<T> l_stack( l_model + p_data.size1() + ((m_count > 0) ? 1 : 0), p_data.size2() );
+        for(std::size_t i=0; i < l_model; ++i)
+            ublas::row(l_stack, i) = m_singularvalues(i) * ublas::column(m_project, i);
+        for(std::size_t i=0; i < p_data.size1(); ++i)
+            ublas::row(l_stack, l_model+i) = ublas::row(p_data, i) - l_mean;
+        
+        if (m_count > 0) {
+            const T l_count = static_cast<T>(m_count);
+            const T l_batch = static_cast<T>(p_data.size1());
+            
+            ublas::row(l_stack, l_stack.size1()-1) = std::sqrt(l_count * l_batch / (l_count + l_batch)) * (m_center - l_mean);
+            m_center = (l_count * m_center + l_batch * l_mean) / (l_count + l_batch);
+        } else
+            m_center = l_mean;
+        m_count += p_data.size1();
+        
+        
+        // SVD of the stacked matrix with the smaller gram matrix
+        const std::size_t l_count = std::min( m_dim, std::min(l_stack.size1(), l_stack.size2()) );
+        ublas::vector<T> l_eigval;
+        ublas::matrix<T> l_eigvec;
+        
+        if (l_stack.size1() < l_stack.size2()) {
+            ublas::matrix<T> l_gram( l_stack.size1(), l_stack.size1() );
+            blas::gemm( static_cast<T>(1), l_stack, bind::trans(l_stack), static_cast<T>(0), l_gram );
+            tools::lapack::eigensymmetric( l_gram, l_eigval, l_eigvec, l_count );
+            
+            // right singular vectors are v_i = Z^T * u_i / s_i
+            m_project.resize( l_stack.size2(), l_count, false );
+            blas::gemm( static_cast<T>(1), bind::trans(l_stack), l_eigvec, static_cast<T>(0), m_project );
+        } else {
+            ublas::matrix<T> l_gram( l_stack.size2(), l_stack.size2() );
+            blas::gemm( static_cast<T>(1), bind::trans(l_stack), l_stack, static_cast<T>(0), l_gram );
+            tools::lapack::eigensymmetric( l_gram, l_eigval, l_eigvec, l_count );
+            m_project = l_eigvec;
+        }
+        
+        // vectors with a numerical zero singular value are removed (the model grows with the next batches)
+        const T l_tolerance = std::numeric_limits<T>::epsilon() * std::max(l_stack.size1(), l_stack.size2()) * std::sqrt( std::max(l_eigval(0), static_cast<T>(0)) );
+        std::size_t l_rank  = 0;
+        m_singularvalues.resize( l_count, false );
+        for(std::size_t i=0; i < l_count; ++i) {
+            m_singularvalues(i) = std::sqrt( std::max(l_eigval(i), static_cast<T>(0)) );
+            if (m_singularvalues(i) <= l_tolerance)
+                break;
+            
+            if (l_stack.size1() < l_stack.size2())
+                ublas::column(m_project, i) /= m_singularvalues(i);
+            
+            // the sign of each vector is fixed (largest absolute entry is positive), so the projection does not flip between batches
+            ublas::vector<T> l_column = ublas::column(m_project, i);
+            if (l_column(ublas::index_norm_inf(l_column)) < 0)
+                ublas::column(m_project, i) *= static_cast<T>(-1);
+            
+            l_rank++;
+        }
+        
+        if (l_rank < l_count) {
+            m_singularvalues.resize( l_rank, true );
+            m_project.resize( m_project.size1(), l_rank, true );
+        }
+    }
+    
+    
+    /** projects new data with the fitted model
+     * @param p_data input datamatrix
+     * @return projected data
+     **/
+    template<typename T> inline ublas::matrix<T> pca<T>::transform( const ublas::matrix<T>& p_data ) const
+    {
+        if (m_count == 0)
+            throw exception::runtime(_("projection is not fitted"), *this);
+        if (p_data.size2() != m_center.size())
+            throw exception::runtime(_("datapoint dimension must be equal to the fitted data"), *this);
+        
+        ublas::matrix<T> l_center( p_data );
+        for(std::size_t i=0; i < l_center.size1(); ++i)
+            ublas::row(l_center, i) -= m_center;
         
         return ublas::prod(l_center, m_project);
     }
@@ -37,6 +37,7 @@
 %typemap(javadestruct)          machinelearning::dimensionreduce::nonsupervised::reduce<double>                             ""
 
 %typemap(javaout)               ublas::matrix<double> machinelearning::dimensionreduce::nonsupervised::reduce<double>::map  ";"
+%typemap(javaout)               ublas::matrix<double> machinelearning::dimensionreduce::nonsupervised::reduce<double>::transform  ";"
 %typemap(javaout)               std::size_t machinelearning::dimensionreduce::nonsupervised::reduce<double>::getDimension   ";"
 #endif
 
@@ -51,6 +51,7 @@ namespace machinelearning { namespace dimensionreduce { namespace supervised {
         
             lda( const std::size_t& );
             ublas::matrix<T> map( const ublas::matrix<T>&, const std::vector<L>& );
+            ublas::matrix<T> transform( const ublas::matrix<T>& ) const;
             std::size_t getDimension( void ) const;
             ublas::matrix<T> getProject( void ) const;
         
@@ -158,6 +159,21 @@ namespace machinelearning { namespace dimensionreduce { namespace supervised {
         return ublas::prod(p_data, m_project);
     }
     
+    
+    /** projects new data with the fitted projection vectors
+     * @param p_data input datamatrix
+     * @return matrix with mapped points
+     **/
+    template<typename T, typename L> inline ublas::matrix<T> lda<T, L>::transform( const ublas::matrix<T>& p_data ) const
+    {
+        if (m_project.size1() == 0)
+            throw exception::runtime(_("projection is not fitted"), *this);
+        if (p_data.size2() != m_project.size1())
+            throw exception::runtime(_("datapoint dimension must be equal to the fitted data"), *this);
+        
+        return ublas::prod(p_data, m_project);
+    }
+    
 
 
 }}}
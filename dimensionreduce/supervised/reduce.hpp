@@ -60,6 +60,9 @@ namespace machinelearning { namespace dimensionreduce {
                 /** maps data to target dimension **/
                 virtual ublas::matrix<T> map( const ublas::matrix<T>&, const std::vector<L>& ) = 0; 
             
+                /** maps new (unlabeled) data with the fitted model (without recalculating) **/
+                virtual ublas::matrix<T> transform( const ublas::matrix<T>& ) const = 0;
+            
                 /** returns the mapped dimension **/
                 virtual std::size_t getDimension( void ) const = 0; 
             
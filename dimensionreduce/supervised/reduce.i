@@ -37,6 +37,7 @@
 %typemap(javadestruct)       machinelearning::dimensionreduce::supervised::reduce<double, std::string>                               ""
 
 %typemap(javaout)            ublas::matrix<double> machinelearning::dimensionreduce::supervised::reduce<double, std::string>::map    ";"
+%typemap(javaout)            ublas::matrix<double> machinelearning::dimensionreduce::supervised::reduce<double, std::string>::transform    ";"
 %typemap(javaout)            std::size_t machinelearning::dimensionreduce::supervised::reduce<double, std::string>::getDimension     ";"
 
 
@@ -46,6 +47,7 @@
 %typemap(javadestruct)       machinelearning::dimensionreduce::supervised::reduce<double, std::size_t>                               ""
 
 %typemap(javaout)            ublas::matrix<double> machinelearning::dimensionreduce::supervised::reduce<double, std::size_t>::map    ";"
+%typemap(javaout)            ublas::matrix<double> machinelearning::dimensionreduce::supervised::reduce<double, std::size_t>::transform    ";"
 %typemap(javaout)            std::size_t machinelearning::dimensionreduce::supervised::reduce<double, std::size_t>::getDimension     ";"
 #endif
 
@@ -0,0 +1,1110 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_COMPRESSION_COMPRESSOR_HPP
+#define __MACHINELEARNING_DISTANCES_COMPRESSION_COMPRESSOR_HPP
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include <zlib.h>
+#include <bzlib.h>
+
+#ifdef MACHINELEARNING_COMPRESSION_XZ
+#include <lzma.h>
+#endif
+
+#ifdef MACHINELEARNING_COMPRESSION_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef MACHINELEARNING_COMPRESSION_LZ4
+#include <lz4frame.h>
+#endif
+
+#ifdef MACHINELEARNING_COMPRESSION_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#include "../../errorhandling/exception.hpp"
+
+
+
+namespace machinelearning { namespace distances { namespace compression {
+    
+    
+    /** compression level, each algorithm maps the level to its own parameter, the
+     * native level of an algorithm can be passed as integer to the constructor
+     **/
+    enum level
+    {
+        defaultcompression,
+        bestspeed,
+        bestcompression
+    };
+    
+    
+    
+    /** abstract class of a compressor backend. A compressor holds the state
+     * of the algorithm and the buffers, so it can be reused for each deflate
+     * call, but it can not be shared between threads. The compressed data is
+     * discarded, only the number of bytes is returned. A compressor can be
+     * primed with a buffer x, so the size of the concatenation x+y can be
+     * estimated for many buffers y without compressing x again (backends,
+     * that does not support dictionaries, compress the concatenation)
+     **/
+    class compressor
+    {
+        
+        public :
+            
+            /** compresses the concatenation of both buffers and returns the number of compressed bytes without header & footer **/
+            virtual std::size_t deflate( const char*, const std::size_t&, const char* = NULL, const std::size_t& = 0 ) = 0;
+            
+            virtual std::size_t prime( const char*, const std::size_t& );
+            virtual std::size_t deflatePrimed( const char*, const std::size_t& );
+            
+            virtual ~compressor( void ) {};
+        
+        
+        protected :
+            
+            /** output buffer **/
+            std::vector<char> m_output;
+            /** primed buffer **/
+            const char* m_prime;
+            /** size of the primed buffer **/
+            std::size_t m_primesize;
+            /** compressed size of the primed buffer **/
+            std::size_t m_primecompressed;
+            
+            compressor( const std::size_t& = 65536 );
+        
+        
+        private :
+            
+            compressor( const compressor& );
+            compressor& operator=( const compressor& );
+        
+    };
+    
+    
+    
+    /** gzip compressor (raw deflate stream of the zlib, so the size is equal to
+     * the gzip size without the 10 bytes of header and the 8 bytes of footer)
+     **/
+    class gzipcompressor : public compressor
+    {
+        
+        public :
+            
+            gzipcompressor( const level& = defaultcompression );
+            gzipcompressor( const int& );
+            std::size_t deflate( const char*, const std::size_t&, const char* = NULL, const std::size_t& = 0 );
+            std::size_t deflatePrimed( const char*, const std::size_t& );
+            ~gzipcompressor( void );
+        
+        
+        private :
+            
+            /** zlib stream (is reset on each call) **/
+            z_stream m_stream;
+            
+            void initialize( const int& );
+            void process( const char*, const std::size_t&, const int& );
+        
+    };
+    
+    
+    
+    /** bzip2 compressor **/
+    class bzip2compressor : public compressor
+    {
+        
+        public :
+            
+            bzip2compressor( const level& = defaultcompression );
+            bzip2compressor( const int& );
+            std::size_t deflate( const char*, const std::size_t&, const char* = NULL, const std::size_t& = 0 );
+        
+        
+        private :
+            
+            /** block size (1-9) **/
+            const int m_blocksize;
+            
+            void process( bz_stream&, const char*, const std::size_t&, const int& );
+        
+    };
+    
+    
+    
+    #ifdef MACHINELEARNING_COMPRESSION_XZ
+    
+    /** xz compressor (raw LZMA2 stream of the liblzma) **/
+    class xzcompressor : public compressor
+    {
+        
+        public :
+            
+            xzcompressor( const level& = defaultcompression );
+            xzcompressor( const int& );
+            std::size_t deflate( const char*, const std::size_t&, const char* = NULL, const std::size_t& = 0 );
+            std::size_t deflatePrimed( const char*, const std::size_t& );
+            ~xzcompressor( void );
+        
+        
+        private :
+            
+            /** lzma stream (the allocated memory is reused on each call) **/
+            lzma_stream m_stream;
+            /** LZMA2 options **/
+            lzma_options_lzma m_options;
+            /** filter chain **/
+            lzma_filter m_filter[2];
+            
+            void initialize( const uint32_t& );
+            void process( const char*, const std::size_t&, const lzma_action& );
+        
+    };
+    
+    #endif
+    
+    
+    
+    #ifdef MACHINELEARNING_COMPRESSION_ZSTD
+    
+    /** zstd compressor **/
+    class zstdcompressor : public compressor
+    {
+        
+        public :
+            
+            zstdcompressor( const level& = defaultcompression );
+            zstdcompressor( const int& );
+            std::size_t deflate( const char*, const std::size_t&, const char* = NULL, const std::size_t& = 0 );
+            std::size_t prime( const char*, const std::size_t& );
+            std::size_t deflatePrimed( const char*, const std::size_t& );
+            ~zstdcompressor( void );
+        
+        
+        private :
+            
+            /** compression level **/
+            const int m_level;
+            /** compression context (is reset on each call) **/
+            ZSTD_CCtx* m_context;
+            /** digested dictionary of the primed buffer **/
+            ZSTD_CDict* m_dictionary;
+            /** size of the frame header of the current frame **/
+            std::size_t m_header;
+            
+            void initialize( void );
+            std::size_t process( const char*, const std::size_t&, const ZSTD_EndDirective& );
+            static std::size_t getFrameHeaderSize( const char*, const std::size_t& );
+        
+    };
+    
+    #endif
+    
+    
+    
+    #ifdef MACHINELEARNING_COMPRESSION_LZ4
+    
+    /** lz4 compressor (frame format with linked blocks) **/
+    class lz4compressor : public compressor
+    {
+        
+        public :
+            
+            lz4compressor( const level& = defaultcompression );
+            lz4compressor( const int& );
+            std::size_t deflate( const char*, const std::size_t&, const char* = NULL, const std::size_t& = 0 );
+            ~lz4compressor( void );
+        
+        
+        private :
+            
+            /** size of the input blocks **/
+            static const std::size_t m_blocksize = 65536;
+            /** compression context **/
+            LZ4F_cctx* m_context;
+            /** frame preferences **/
+            LZ4F_preferences_t m_preferences;
+            
+            void initialize( const int& );
+            std::size_t process( const char*, const std::size_t& );
+        
+    };
+    
+    #endif
+    
+    
+    
+    #ifdef MACHINELEARNING_COMPRESSION_BROTLI
+    
+    /** brotli compressor. The encoder can not be reset, so the encoder is created
+     * on each call with an allocator of the compressor, that keeps the memory blocks
+     * of the previous encoder, so the encoder memory is allocated once per compressor
+     **/
+    class brotlicompressor : public compressor
+    {
+        
+        public :
+            
+            brotlicompressor( const level& = defaultcompression );
+            brotlicompressor( const int& );
+            std::size_t deflate( const char*, const std::size_t&, const char* = NULL, const std::size_t& = 0 );
+            ~brotlicompressor( void );
+        
+        
+        private :
+            
+            /** quality (0-11) **/
+            const int m_quality;
+            /** unused memory blocks of the encoder with their size **/
+            std::multimap<std::size_t, void*> m_free;
+            /** used memory blocks of the encoder with their size **/
+            std::map<void*, std::size_t> m_used;
+            
+            std::size_t process( BrotliEncoderState*, const char*, const std::size_t&, const BrotliEncoderOperation& );
+            static void* allocate( void*, std::size_t );
+            static void release( void*, void* );
+        
+    };
+    
+    #endif
+    
+    
+    
+    
+    /** constructor
+     * @param p_size size of the output buffer
+     **/
+    inline compressor::compressor( const std::size_t& p_size ) :
+        m_output( p_size ),
+        m_prime( NULL ),
+        m_primesize( 0 ),
+        m_primecompressed( 0 )
+    {}
+    
+    
+    /** primes the compressor with a buffer, the buffer is not copied,
+     * so it must exist until the compressor is primed again
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @return compressed size of the buffer (zero for an empty buffer like on the unprimed deflate of the NCD)
+     **/
+    inline std::size_t compressor::prime( const char* p_data, const std::size_t& p_size )
+    {
+        m_prime           = p_data;
+        m_primesize       = p_size;
+        m_primecompressed = (p_size == 0) ? 0 : deflate( p_data, p_size );
+        
+        return m_primecompressed;
+    }
+    
+    
+    /** returns the compressed size of the concatenation of the
+     * primed buffer and the argument buffer
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @return number of bytes (the size of the primed buffer for an empty buffer)
+     **/
+    inline std::size_t compressor::deflatePrimed( const char* p_data, const std::size_t& p_size )
+    {
+        if (p_size == 0)
+            return m_primecompressed;
+        
+        return deflate( m_prime, m_primesize, p_data, p_size );
+    }
+    
+    
+    
+    
+    /** constructor
+     * @param p_level compression level
+     **/
+    inline gzipcompressor::gzipcompressor( const level& p_level ) :
+        compressor()
+    {
+        int l_level = Z_DEFAULT_COMPRESSION;
+        switch (p_level) {
+            case defaultcompression : l_level = Z_DEFAULT_COMPRESSION;  break;
+            case bestspeed          : l_level = Z_BEST_SPEED;           break;
+            case bestcompression    : l_level = Z_BEST_COMPRESSION;     break;
+        }
+        
+        initialize( l_level );
+    }
+    
+    
+    /** constructor
+     * @param p_level zlib compression level (0-9 or -1 for the default level)
+     **/
+    inline gzipcompressor::gzipcompressor( const int& p_level ) :
+        compressor()
+    {
+        if ((p_level < Z_DEFAULT_COMPRESSION) || (p_level > Z_BEST_COMPRESSION))
+            throw exception::runtime(_("compression level is out of range"));
+        
+        initialize( p_level );
+    }
+    
+    
+    /** initializes the zlib stream
+     * @param p_level zlib compression level
+     **/
+    inline void gzipcompressor::initialize( const int& p_level )
+    {
+        m_stream.zalloc = Z_NULL;
+        m_stream.zfree  = Z_NULL;
+        m_stream.opaque = Z_NULL;
+        
+        // negative window bits creates a raw deflate stream without the gzip header & footer
+        if (deflateInit2(&m_stream, p_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw exception::runtime(_("compressor can not be initialized"));
+    }
+    
+    
+    /** destructor **/
+    inline gzipcompressor::~gzipcompressor( void )
+    {
+        deflateEnd(&m_stream);
+    }
+    
+    
+    /** compresses the concatenation of both buffers
+     * @param p_data1 first buffer
+     * @param p_size1 size of the first buffer
+     * @param p_data2 second buffer
+     * @param p_size2 size of the second buffer
+     * @return number of bytes
+     **/
+    inline std::size_t gzipcompressor::deflate( const char* p_data1, const std::size_t& p_size1, const char* p_data2, const std::size_t& p_size2 )
+    {
+        deflateReset(&m_stream);
+        process( p_data1, p_size1, Z_NO_FLUSH );
+        process( p_data2, p_size2, Z_FINISH );
+        
+        return static_cast<std::size_t>(m_stream.total_out);
+    }
+    
+    
+    /** returns the compressed size of the concatenation, the buffer is
+     * compressed with the end of the primed buffer as dictionary (the
+     * dictionary is the deflate window, so it is the same data that is
+     * seen by the deflate stream of the concatenation)
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @return number of bytes
+     **/
+    inline std::size_t gzipcompressor::deflatePrimed( const char* p_data, const std::size_t& p_size )
+    {
+        if (p_size == 0)
+            return m_primecompressed;
+        
+        const std::size_t l_dictionary = std::min( m_primesize, static_cast<std::size_t>(1) << MAX_WBITS );
+        
+        deflateReset(&m_stream);
+        if (l_dictionary > 0)
+            deflateSetDictionary(&m_stream, reinterpret_cast<const Bytef*>(m_prime + m_primesize - l_dictionary), static_cast<uInt>(l_dictionary));
+        process( p_data, p_size, Z_FINISH );
+        
+        return m_primecompressed + static_cast<std::size_t>(m_stream.total_out);
+    }
+    
+    
+    /** passes a buffer to the zlib stream
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @param p_flush zlib flush flag
+     **/
+    inline void gzipcompressor::process( const char* p_data, const std::size_t& p_size, const int& p_flush )
+    {
+        std::size_t l_pos = 0;
+        int l_state       = Z_OK;
+        
+        do {
+            // zlib counts with 32 bit, so large buffers are passed in parts
+            const std::size_t l_part = std::min(p_size-l_pos, static_cast<std::size_t>(std::numeric_limits<uInt>::max()));
+            const int l_flush        = (l_pos+l_part < p_size) ? Z_NO_FLUSH : p_flush;
+            
+            m_stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(p_data)) + l_pos;
+            m_stream.avail_in = static_cast<uInt>(l_part);
+            l_pos            += l_part;
+            
+            do {
+                m_stream.next_out  = reinterpret_cast<Bytef*>(&m_output[0]);
+                m_stream.avail_out = static_cast<uInt>(m_output.size());
+                l_state            = ::deflate(&m_stream, l_flush);
+            } while ( (m_stream.avail_out == 0) || ((l_flush == Z_FINISH) && (l_state != Z_STREAM_END)) );
+            
+        } while (l_pos < p_size);
+    }
+    
+    
+    
+    
+    /** constructor
+     * @param p_level compression level
+     **/
+    inline bzip2compressor::bzip2compressor( const level& p_level ) :
+        compressor(),
+        m_blocksize( (p_level == bestspeed) ? 1 : ((p_level == bestcompression) ? 9 : 6) )
+    {}
+    
+    
+    /** constructor
+     * @param p_level block size in 100kB (1-9)
+     **/
+    inline bzip2compressor::bzip2compressor( const int& p_level ) :
+        compressor(),
+        m_blocksize( p_level )
+    {
+        if ((p_level < 1) || (p_level > 9))
+            throw exception::runtime(_("compression level is out of range"));
+    }
+    
+    
+    /** compresses the concatenation of both buffers, bzip2 can not
+     * be reset, so the stream is initialized on each call
+     * @see http://en.wikipedia.org/wiki/Bzip2#File_format
+     * @param p_data1 first buffer
+     * @param p_size1 size of the first buffer
+     * @param p_data2 second buffer
+     * @param p_size2 size of the second buffer
+     * @return number of bytes
+     **/
+    inline std::size_t bzip2compressor::deflate( const char* p_data1, const std::size_t& p_size1, const char* p_data2, const std::size_t& p_size2 )
+    {
+        bz_stream l_stream;
+        l_stream.bzalloc = NULL;
+        l_stream.bzfree  = NULL;
+        l_stream.opaque  = NULL;
+        if (BZ2_bzCompressInit(&l_stream, m_blocksize, 0, 0) != BZ_OK)
+            throw exception::runtime(_("compressor can not be initialized"));
+        
+        process( l_stream, p_data1, p_size1, BZ_RUN );
+        process( l_stream, p_data2, p_size2, BZ_FINISH );
+        
+        const std::size_t l_size = (static_cast<std::size_t>(l_stream.total_out_hi32) << 32) | l_stream.total_out_lo32;
+        BZ2_bzCompressEnd(&l_stream);
+        
+        // remove stream header ("BZh" and block size, 4 bytes) and stream footer (48 bit magic
+        // number and 32 bit checksum, 10 bytes), so an empty stream has got a size of zero
+        return (l_size >= 14) ? l_size-14 : 0;
+    }
+    
+    
+    /** passes a buffer to the bzip2 stream
+     * @param p_stream bzip2 stream
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @param p_action bzip2 action flag
+     **/
+    inline void bzip2compressor::process( bz_stream& p_stream, const char* p_data, const std::size_t& p_size, const int& p_action )
+    {
+        // bzip2 returns a parameter error, if it is run without input
+        if ((p_size == 0) && (p_action == BZ_RUN))
+            return;
+
+        std::size_t l_pos = 0;
+        int l_state       = BZ_RUN_OK;
+        
+        do {
+            // bzip2 counts with 32 bit, so large buffers are passed in parts
+            const std::size_t l_part = std::min(p_size-l_pos, static_cast<std::size_t>(std::numeric_limits<unsigned int>::max()));
+            const int l_action       = (l_pos+l_part < p_size) ? BZ_RUN : p_action;
+            
+            p_stream.next_in  = const_cast<char*>(p_data) + l_pos;
+            p_stream.avail_in = static_cast<unsigned int>(l_part);
+            l_pos            += l_part;
+            
+            do {
+                p_stream.next_out  = &m_output[0];
+                p_stream.avail_out = static_cast<unsigned int>(m_output.size());
+                l_state            = BZ2_bzCompress(&p_stream, l_action);
+                if (l_state < 0)
+                    throw exception::runtime(_("compression error"));
+            } while ( (p_stream.avail_out == 0) || ((l_action == BZ_FINISH) && (l_state != BZ_STREAM_END)) );
+            
+        } while (l_pos < p_size);
+    }
+    
+    
+    
+    
+    #ifdef MACHINELEARNING_COMPRESSION_XZ
+    
+    /** constructor
+     * @param p_level compression level
+     **/
+    inline xzcompressor::xzcompressor( const level& p_level ) :
+        compressor()
+    {
+        initialize( (p_level == bestspeed) ? 0 : ((p_level == bestcompression) ? 9 : LZMA_PRESET_DEFAULT) );
+    }
+    
+    
+    /** constructor
+     * @param p_level LZMA preset (0-9)
+     **/
+    inline xzcompressor::xzcompressor( const int& p_level ) :
+        compressor()
+    {
+        if ((p_level < 0) || (p_level > 9))
+            throw exception::runtime(_("compression level is out of range"));
+        
+        initialize( static_cast<uint32_t>(p_level) );
+    }
+    
+    
+    /** initializes the stream and the filter chain
+     * @param p_preset LZMA preset
+     **/
+    inline void xzcompressor::initialize( const uint32_t& p_preset )
+    {
+        const lzma_stream l_init = LZMA_STREAM_INIT;
+        m_stream = l_init;
+        
+        if (lzma_lzma_preset(&m_options, p_preset))
+            throw exception::runtime(_("compressor can not be initialized"));
+        
+        m_filter[0].id      = LZMA_FILTER_LZMA2;
+        m_filter[0].options = &m_options;
+        m_filter[1].id      = LZMA_VLI_UNKNOWN;
+        m_filter[1].options = NULL;
+    }
+    
+    
+    /** destructor **/
+    inline xzcompressor::~xzcompressor( void )
+    {
+        lzma_end(&m_stream);
+    }
+    
+    
+    /** compresses the concatenation of both buffers, the raw encoder
+     * has no container header & footer
+     * @param p_data1 first buffer
+     * @param p_size1 size of the first buffer
+     * @param p_data2 second buffer
+     * @param p_size2 size of the second buffer
+     * @return number of bytes
+     **/
+    inline std::size_t xzcompressor::deflate( const char* p_data1, const std::size_t& p_size1, const char* p_data2, const std::size_t& p_size2 )
+    {
+        // the initialization reuses the memory of the previous call
+        if (lzma_raw_encoder(&m_stream, m_filter) != LZMA_OK)
+            throw exception::runtime(_("compressor can not be initialized"));
+        
+        process( p_data1, p_size1, LZMA_RUN );
+        process( p_data2, p_size2, LZMA_FINISH );
+        
+        return static_cast<std::size_t>(m_stream.total_out);
+    }
+    
+    
+    /** returns the compressed size of the concatenation, the buffer is
+     * compressed with the end of the primed buffer as preset dictionary
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @return number of bytes
+     **/
+    inline std::size_t xzcompressor::deflatePrimed( const char* p_data, const std::size_t& p_size )
+    {
+        if (p_size == 0)
+            return m_primecompressed;
+        
+        const std::size_t l_dictionary = std::min( m_primesize, static_cast<std::size_t>(m_options.dict_size) );
+        
+        m_options.preset_dict      = reinterpret_cast<const uint8_t*>(m_prime + m_primesize - l_dictionary);
+        m_options.preset_dict_size = static_cast<uint32_t>(l_dictionary);
+        const lzma_ret l_init      = lzma_raw_encoder(&m_stream, m_filter);
+        m_options.preset_dict      = NULL;
+        m_options.preset_dict_size = 0;
+        
+        if (l_init != LZMA_OK)
+            throw exception::runtime(_("compressor can not be initialized"));
+        
+        process( p_data, p_size, LZMA_FINISH );
+        
+        return m_primecompressed + static_cast<std::size_t>(m_stream.total_out);
+    }
+    
+    
+    /** passes a buffer to the lzma stream
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @param p_action lzma action
+     **/
+    inline void xzcompressor::process( const char* p_data, const std::size_t& p_size, const lzma_action& p_action )
+    {
+        m_stream.next_in  = reinterpret_cast<const uint8_t*>(p_data);
+        m_stream.avail_in = p_size;
+        
+        lzma_ret l_state = LZMA_OK;
+        do {
+            m_stream.next_out  = reinterpret_cast<uint8_t*>(&m_output[0]);
+            m_stream.avail_out = m_output.size();
+            l_state            = lzma_code(&m_stream, p_action);
+            
+            if ((l_state != LZMA_OK) && (l_state != LZMA_STREAM_END))
+                throw exception::runtime(_("compression error"));
+        } while ( (m_stream.avail_in > 0) || (m_stream.avail_out == 0) || ((p_action == LZMA_FINISH) && (l_state != LZMA_STREAM_END)) );
+    }
+    
+    #endif
+    
+    
+    
+    
+    #ifdef MACHINELEARNING_COMPRESSION_ZSTD
+    
+    /** constructor
+     * @param p_level compression level
+     **/
+    inline zstdcompressor::zstdcompressor( const level& p_level ) :
+        compressor( ZSTD_CStreamOutSize() ),
+        m_level( (p_level == bestspeed) ? 1 : ((p_level == bestcompression) ? 19 : ZSTD_CLEVEL_DEFAULT) ),
+        m_context( NULL ),
+        m_dictionary( NULL ),
+        m_header( 0 )
+    {
+        initialize();
+    }
+    
+    
+    /** constructor
+     * @param p_level zstd compression level (ZSTD_minCLevel() up to ZSTD_maxCLevel(), negative
+     * values are the fast levels and zero is the default level)
+     **/
+    inline zstdcompressor::zstdcompressor( const int& p_level ) :
+        compressor( ZSTD_CStreamOutSize() ),
+        m_level( p_level ),
+        m_context( NULL ),
+        m_dictionary( NULL ),
+        m_header( 0 )
+    {
+        if ((p_level < ZSTD_minCLevel()) || (p_level > ZSTD_maxCLevel()))
+            throw exception::runtime(_("compression level is out of range"));
+        
+        initialize();
+    }
+    
+    
+    /** creates the compression context **/
+    inline void zstdcompressor::initialize( void )
+    {
+        m_context = ZSTD_createCCtx();
+        if (!m_context)
+            throw exception::runtime(_("compressor can not be initialized"));
+        
+        // the frame header should be as small as possible
+        ZSTD_CCtx_setParameter(m_context, ZSTD_c_compressionLevel, m_level);
+        ZSTD_CCtx_setParameter(m_context, ZSTD_c_contentSizeFlag, 0);
+        ZSTD_CCtx_setParameter(m_context, ZSTD_c_checksumFlag, 0);
+        ZSTD_CCtx_setParameter(m_context, ZSTD_c_dictIDFlag, 0);
+    }
+    
+    
+    /** destructor **/
+    inline zstdcompressor::~zstdcompressor( void )
+    {
+        ZSTD_freeCDict(m_dictionary);
+        ZSTD_freeCCtx(m_context);
+    }
+    
+    
+    /** compresses the concatenation of both buffers
+     * @param p_data1 first buffer
+     * @param p_size1 size of the first buffer
+     * @param p_data2 second buffer
+     * @param p_size2 size of the second buffer
+     * @return number of bytes
+     **/
+    inline std::size_t zstdcompressor::deflate( const char* p_data1, const std::size_t& p_size1, const char* p_data2, const std::size_t& p_size2 )
+    {
+        // reset the session only, so the parameters are kept
+        ZSTD_CCtx_reset(m_context, ZSTD_reset_session_only);
+        m_header = 0;
+        const std::size_t l_size = process( p_data1, p_size1, ZSTD_e_continue ) + process( p_data2, p_size2, ZSTD_e_end );
+        
+        // remove the frame header, that is read from the frame
+        return l_size - m_header;
+    }
+    
+    
+    /** primes the compressor, the buffer is digested once into
+     * a dictionary, that is used for each following call (an empty
+     * buffer creates no dictionary)
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @return compressed size of the buffer
+     **/
+    inline std::size_t zstdcompressor::prime( const char* p_data, const std::size_t& p_size )
+    {
+        ZSTD_freeCDict(m_dictionary);
+        m_dictionary = NULL;
+        
+        if (p_size > 0) {
+            m_dictionary = ZSTD_createCDict(p_data, p_size, m_level);
+            if (!m_dictionary)
+                throw exception::runtime(_("dictionary can not be created"));
+        }
+        
+        return compressor::prime( p_data, p_size );
+    }
+    
+    
+    /** returns the compressed size of the concatenation, the buffer is
+     * compressed with the dictionary of the primed buffer
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @return number of bytes
+     **/
+    inline std::size_t zstdcompressor::deflatePrimed( const char* p_data, const std::size_t& p_size )
+    {
+        if (p_size == 0)
+            return m_primecompressed;
+        
+        ZSTD_CCtx_reset(m_context, ZSTD_reset_session_only);
+        ZSTD_CCtx_refCDict(m_context, m_dictionary);
+        m_header = 0;
+        const std::size_t l_size = process( p_data, p_size, ZSTD_e_end );
+        ZSTD_CCtx_refCDict(m_context, NULL);
+        
+        // remove the frame header like on deflate
+        return m_primecompressed + l_size - m_header;
+    }
+    
+    
+    /** passes a buffer to the zstd context, the frame header is written
+     * with the first output of the frame, so its size is read there
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @param p_directive end directive
+     * @return number of written bytes
+     **/
+    inline std::size_t zstdcompressor::process( const char* p_data, const std::size_t& p_size, const ZSTD_EndDirective& p_directive )
+    {
+        std::size_t l_count = 0;
+        ZSTD_inBuffer l_input = { p_data, p_size, 0 };
+        
+        for(bool l_run = true; l_run; ) {
+            ZSTD_outBuffer l_output = { &m_output[0], m_output.size(), 0 };
+            const std::size_t l_remain = ZSTD_compressStream2(m_context, &l_output, &l_input, p_directive);
+            if (ZSTD_isError(l_remain))
+                throw exception::runtime(_("compression error"));
+            
+            if ((m_header == 0) && (l_output.pos > 0))
+                m_header = getFrameHeaderSize( static_cast<const char*>(l_output.dst), l_output.pos );
+            
+            l_count += l_output.pos;
+            l_run    = (p_directive == ZSTD_e_end) ? (l_remain != 0) : (l_input.pos < l_input.size);
+        }
+        
+        return l_count;
+    }
+    
+    
+    /** returns the size of the frame header, that is build of the magic number (4 bytes),
+     * the frame header descriptor (1 byte), the window descriptor (1 byte, not used on single
+     * segment frames), the dictionary id (0-4 bytes) and the frame content size (0-8 bytes)
+     * @see https://github.com/facebook/zstd/blob/dev/doc/zstd_compression_format.md#frame_header
+     * @param p_frame begin of the frame
+     * @param p_size number of available bytes
+     * @return number of bytes
+     **/
+    inline std::size_t zstdcompressor::getFrameHeaderSize( const char* p_frame, const std::size_t& p_size )
+    {
+        if (p_size < 5)
+            throw exception::runtime(_("compression error"));
+        
+        static const std::size_t l_dictionaryid[] = { 0, 1, 2, 4 };
+        static const std::size_t l_contentsize[]  = { 0, 2, 4, 8 };
+        
+        const unsigned char l_descriptor = static_cast<unsigned char>(p_frame[4]);
+        const bool l_singlesegment       = (l_descriptor & 0x20) != 0;
+        const std::size_t l_contentflag  = l_descriptor >> 6;
+        
+        return 5 + (l_singlesegment ? 0 : 1) + l_dictionaryid[l_descriptor & 0x03] + (((l_contentflag == 0) && l_singlesegment) ? 1 : l_contentsize[l_contentflag]);
+    }
+    
+    #endif
+    
+    
+    
+    
+    #ifdef MACHINELEARNING_COMPRESSION_LZ4
+    
+    /** constructor
+     * @param p_level compression level
+     **/
+    inline lz4compressor::lz4compressor( const level& p_level ) :
+        compressor(),
+        m_context( NULL )
+    {
+        initialize( (p_level == bestspeed) ? -1 : ((p_level == bestcompression) ? LZ4F_compressionLevel_max() : 0) );
+    }
+    
+    
+    /** constructor
+     * @param p_level lz4 compression level (up to LZ4F_compressionLevel_max(), negative
+     * values are the acceleration of the fast mode, values greater than 2 use the HC mode)
+     **/
+    inline lz4compressor::lz4compressor( const int& p_level ) :
+        compressor(),
+        m_context( NULL )
+    {
+        if (p_level > LZ4F_compressionLevel_max())
+            throw exception::runtime(_("compression level is out of range"));
+        
+        initialize( p_level );
+    }
+    
+    
+    /** creates the context and the output buffer
+     * @param p_level lz4 compression level
+     **/
+    inline void lz4compressor::initialize( const int& p_level )
+    {
+        // default preferences are linked blocks of 64kB without checksums and content size
+        std::memset(&m_preferences, 0, sizeof(m_preferences));
+        m_preferences.compressionLevel = p_level;
+        
+        if (LZ4F_isError(LZ4F_createCompressionContext(&m_context, LZ4F_VERSION)))
+            throw exception::runtime(_("compressor can not be initialized"));
+        
+        m_output.resize( LZ4F_compressBound(m_blocksize, &m_preferences) );
+    }
+    
+    
+    /** destructor **/
+    inline lz4compressor::~lz4compressor( void )
+    {
+        LZ4F_freeCompressionContext(m_context);
+    }
+    
+    
+    /** compresses the concatenation of both buffers
+     * @param p_data1 first buffer
+     * @param p_size1 size of the first buffer
+     * @param p_data2 second buffer
+     * @param p_size2 size of the second buffer
+     * @return number of bytes
+     **/
+    inline std::size_t lz4compressor::deflate( const char* p_data1, const std::size_t& p_size1, const char* p_data2, const std::size_t& p_size2 )
+    {
+        // the frame header is written completely on begin, so it is not counted
+        const std::size_t l_header = LZ4F_compressBegin(m_context, &m_output[0], m_output.size(), &m_preferences);
+        if (LZ4F_isError(l_header))
+            throw exception::runtime(_("compression error"));
+        
+        std::size_t l_size = process( p_data1, p_size1 );
+        l_size            += process( p_data2, p_size2 );
+        
+        const std::size_t l_end = LZ4F_compressEnd(m_context, &m_output[0], m_output.size(), NULL);
+        if (LZ4F_isError(l_end))
+            throw exception::runtime(_("compression error"));
+        
+        // the end writes the buffered blocks and the end mark (4 bytes, the content checksum is disabled)
+        return l_size + l_end - 4;
+    }
+    
+    
+    /** passes a buffer in blocks to the lz4 context
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @return number of written bytes
+     **/
+    inline std::size_t lz4compressor::process( const char* p_data, const std::size_t& p_size )
+    {
+        std::size_t l_count = 0;
+        
+        for(std::size_t i=0; i < p_size; i += m_blocksize) {
+            const std::size_t l_written = LZ4F_compressUpdate(m_context, &m_output[0], m_output.size(), p_data+i, std::min(static_cast<std::size_t>(m_blocksize), p_size-i), NULL);
+            if (LZ4F_isError(l_written))
+                throw exception::runtime(_("compression error"));
+            
+            l_count += l_written;
+        }
+        
+        return l_count;
+    }
+    
+    #endif
+    
+    
+    
+    
+    #ifdef MACHINELEARNING_COMPRESSION_BROTLI
+    
+    /** constructor
+     * @param p_level compression level
+     **/
+    inline brotlicompressor::brotlicompressor( const level& p_level ) :
+        compressor(),
+        m_quality( (p_level == bestspeed) ? BROTLI_MIN_QUALITY : ((p_level == bestcompression) ? BROTLI_MAX_QUALITY : 6) ),
+        m_free(),
+        m_used()
+    {}
+    
+    
+    /** constructor
+     * @param p_level brotli quality (0-11)
+     **/
+    inline brotlicompressor::brotlicompressor( const int& p_level ) :
+        compressor(),
+        m_quality( p_level ),
+        m_free(),
+        m_used()
+    {
+        if ((p_level < BROTLI_MIN_QUALITY) || (p_level > BROTLI_MAX_QUALITY))
+            throw exception::runtime(_("compression level is out of range"));
+    }
+    
+    
+    /** destructor, that frees the memory blocks of the encoder **/
+    inline brotlicompressor::~brotlicompressor( void )
+    {
+        for(std::multimap<std::size_t, void*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+            std::free(it->second);
+        for(std::map<void*, std::size_t>::iterator it = m_used.begin(); it != m_used.end(); ++it)
+            std::free(it->first);
+    }
+    
+    
+    /** compresses the concatenation of both buffers, brotli can not
+     * be reset, so the encoder is created on each call, but it gets
+     * the memory blocks of the previous encoder
+     * @param p_data1 first buffer
+     * @param p_size1 size of the first buffer
+     * @param p_data2 second buffer
+     * @param p_size2 size of the second buffer
+     * @return number of bytes
+     **/
+    inline std::size_t brotlicompressor::deflate( const char* p_data1, const std::size_t& p_size1, const char* p_data2, const std::size_t& p_size2 )
+    {
+        BrotliEncoderState* l_state = BrotliEncoderCreateInstance(&brotlicompressor::allocate, &brotlicompressor::release, this);
+        if (!l_state)
+            throw exception::runtime(_("compressor can not be initialized"));
+        BrotliEncoderSetParameter(l_state, BROTLI_PARAM_QUALITY, m_quality);
+        
+        std::size_t l_size = 0;
+        try {
+            l_size += process( l_state, p_data1, p_size1, BROTLI_OPERATION_PROCESS );
+            l_size += process( l_state, p_data2, p_size2, BROTLI_OPERATION_FINISH );
+        } catch (...) {
+            BrotliEncoderDestroyInstance(l_state);
+            throw;
+        }
+        
+        BrotliEncoderDestroyInstance(l_state);
+        return l_size;
+    }
+    
+    
+    /** passes a buffer to the brotli encoder
+     * @param p_state encoder state
+     * @param p_data buffer
+     * @param p_size size of the buffer
+     * @param p_operation encoder operation
+     * @return number of written bytes
+     **/
+    inline std::size_t brotlicompressor::process( BrotliEncoderState* p_state, const char* p_data, const std::size_t& p_size, const BrotliEncoderOperation& p_operation )
+    {
+        std::size_t l_availablein = p_size;
+        const uint8_t* l_nextin   = reinterpret_cast<const uint8_t*>(p_data);
+        std::size_t l_count       = 0;
+        
+        do {
+            std::size_t l_availableout = m_output.size();
+            uint8_t* l_nextout         = reinterpret_cast<uint8_t*>(&m_output[0]);
+            
+            if (!BrotliEncoderCompressStream(p_state, p_operation, &l_availablein, &l_nextin, &l_availableout, &l_nextout, NULL))
+                throw exception::runtime(_("compression error"));
+            
+            l_count += m_output.size() - l_availableout;
+        } while ( (l_availablein > 0) || BrotliEncoderHasMoreOutput(p_state) || ((p_operation == BROTLI_OPERATION_FINISH) && !BrotliEncoderIsFinished(p_state)) );
+        
+        return l_count;
+    }
+    
+    
+    /** allocator of the encoder, that returns an unused block with the same
+     * size or allocates a new block
+     * @param p_compressor compressor object
+     * @param p_size size of the block
+     * @return memory block
+     **/
+    inline void* brotlicompressor::allocate( void* p_compressor, std::size_t p_size )
+    {
+        brotlicompressor* const l_compressor           = static_cast<brotlicompressor*>(p_compressor);
+        std::multimap<std::size_t, void*>::iterator it = l_compressor->m_free.find(p_size);
+        
+        void* l_block = NULL;
+        if (it != l_compressor->m_free.end()) {
+            l_block = it->second;
+            l_compressor->m_free.erase(it);
+        } else {
+            l_block = std::malloc(p_size);
+            if (!l_block)
+                return NULL;
+        }
+        
+        l_compressor->m_used[l_block] = p_size;
+        return l_block;
+    }
+    
+    
+    /** release function of the encoder, that keeps the block for the next encoder
+     * @param p_compressor compressor object
+     * @param p_block memory block
+     **/
+    inline void brotlicompressor::release( void* p_compressor, void* p_block )
+    {
+        if (!p_block)
+            return;
+        
+        brotlicompressor* const l_compressor    = static_cast<brotlicompressor*>(p_compressor);
+        std::map<void*, std::size_t>::iterator it = l_compressor->m_used.find(p_block);
+        if (it == l_compressor->m_used.end())
+            return;
+        
+        l_compressor->m_free.insert( std::make_pair(it->second, p_block) );
+        l_compressor->m_used.erase(it);
+    }
+    
+    #endif
+    
+    
+}}}
+#endif
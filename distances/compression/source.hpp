@@ -0,0 +1,310 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_COMPRESSION_SOURCE_HPP
+#define __MACHINELEARNING_DISTANCES_COMPRESSION_SOURCE_HPP
+
+#include <string>
+#include <fstream>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#ifdef _WIN32
+#include <boost/iostreams/device/mapped_file.hpp>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "../../errorhandling/exception.hpp"
+
+
+
+namespace machinelearning { namespace distances { namespace compression {
+    
+    #if !defined(SWIG) && defined(_WIN32)
+    namespace bio = boost::iostreams;
+    #endif
+    
+    
+    /** input data of the compressors. Strings are referenced directly and
+     * files are memory-mapped once, so the data of each element can be passed
+     * to a compressor without opening or copying it on each call. The mappings
+     * exist during the lifetime of the object
+     * @note on POSIX systems the file handle is closed after the file is mapped,
+     * so the number of files is not limited by the number of open files (but by
+     * the number of mappings of a process, e.g. vm.max_map_count on Linux)
+     **/
+    class source
+    {
+        
+        public :
+            
+            source( const std::vector<std::string>&, const bool& );
+            source( const std::vector<std::string>&, const std::size_t&, const std::size_t&, const bool& );
+            source( const char*, const std::vector<std::size_t>& );
+            std::size_t size( void ) const;
+            const char* getData( const std::size_t& ) const;
+            std::size_t getSize( const std::size_t& ) const;
+        
+        
+        private :
+            
+            /** pointer to the data of each element **/
+            std::vector<const char*> m_data;
+            /** number of bytes of each element **/
+            std::vector<std::size_t> m_size;
+            
+            /** read-only mapping of a file **/
+            class mapping
+            {
+                public :
+                    
+                    mapping( const std::string& );
+                    ~mapping( void );
+                    const char* data( void ) const;
+                    std::size_t size( void ) const;
+                
+                private :
+                    
+                    #ifdef _WIN32
+                    /** file mapping **/
+                    bio::mapped_file_source m_file;
+                    #else
+                    /** address of the mapping **/
+                    void* m_data;
+                    /** number of mapped bytes **/
+                    std::size_t m_size;
+                    #endif
+                    
+                    mapping( const mapping& );
+                    mapping& operator=( const mapping& );
+            };
+            
+            /** file mappings **/
+            std::vector< boost::shared_ptr<mapping> > m_files;
+            
+            source( const source& );
+            source& operator=( const source& );
+            
+            void initialize( const std::vector<std::string>&, const std::size_t&, const std::size_t&, const bool& );
+        
+    };
+    
+    
+    
+    /** constructor
+     * @param p_data data vector (the vector must exist during the lifetime of the object, if it holds strings)
+     * @param p_isfile data vector holds filenames
+     **/
+    inline source::source( const std::vector<std::string>& p_data, const bool& p_isfile ) :
+        m_data(),
+        m_size(),
+        m_files()
+    {
+        initialize( p_data, 0, p_data.size(), p_isfile );
+    }
+    
+    
+    /** constructor for a range of the data vector, so a block of a large vector
+     * can be used without copying the strings
+     * @param p_data data vector (the vector must exist during the lifetime of the object, if it holds strings)
+     * @param p_start index of the first element
+     * @param p_end index behind the last element
+     * @param p_isfile data vector holds filenames
+     **/
+    inline source::source( const std::vector<std::string>& p_data, const std::size_t& p_start, const std::size_t& p_end, const bool& p_isfile ) :
+        m_data(),
+        m_size(),
+        m_files()
+    {
+        if ((p_start > p_end) || (p_end > p_data.size()))
+            throw exception::runtime(_("index range is out of range"), *this);
+        
+        initialize( p_data, p_start, p_end, p_isfile );
+    }
+    
+    
+    /** sets the data of a range of the data vector
+     * @param p_data data vector
+     * @param p_start index of the first element
+     * @param p_end index behind the last element
+     * @param p_isfile data vector holds filenames
+     **/
+    inline void source::initialize( const std::vector<std::string>& p_data, const std::size_t& p_start, const std::size_t& p_end, const bool& p_isfile )
+    {
+        m_data.resize( p_end-p_start, NULL );
+        m_size.resize( p_end-p_start, 0 );
+        
+        for(std::size_t i=0; i < m_data.size(); ++i) {
+            const std::string& l_data = p_data[p_start+i];
+            if (l_data.empty())
+                throw exception::runtime(_("string size must be greater than zero"), *this);
+            
+            if (!p_isfile) {
+                m_data[i] = l_data.data();
+                m_size[i] = l_data.size();
+                continue;
+            }
+            
+            // empty files can not be mapped, so they are skipped
+            std::ifstream l_file(l_data.c_str(), std::ifstream::binary | std::ifstream::ate);
+            if (!l_file.is_open())
+                throw exception::runtime(_("file can not be opened"), *this);
+            if (static_cast<std::size_t>(l_file.tellg()) == 0)
+                continue;
+            l_file.close();
+            
+            const boost::shared_ptr<mapping> l_mapping( new mapping(l_data) );
+            m_files.push_back( l_mapping );
+            m_data[i] = l_mapping->data();
+            m_size[i] = l_mapping->size();
+        }
+    }
+    
+    
+    /** maps a file read-only, on POSIX systems the mapping holds its own reference
+     * to the file, so the file handle is closed after the file is mapped
+     * @param p_file filename (the file must not be empty)
+     **/
+    inline source::mapping::mapping( const std::string& p_file )
+        #ifdef _WIN32
+        : m_file()
+        #else
+        : m_data( MAP_FAILED ),
+          m_size( 0 )
+        #endif
+    {
+        #ifdef _WIN32
+        try {
+            m_file.open( p_file );
+        } catch (const std::exception&) {
+            throw exception::runtime(_("file can not be mapped"), *this);
+        }
+        #else
+        const int l_handle = ::open( p_file.c_str(), O_RDONLY );
+        if (l_handle < 0)
+            throw exception::runtime(_("file can not be opened"), *this);
+        
+        struct stat l_stat;
+        if (::fstat(l_handle, &l_stat) == 0) {
+            m_size = static_cast<std::size_t>(l_stat.st_size);
+            m_data = ::mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, l_handle, 0 );
+        }
+        ::close( l_handle );
+        
+        if (m_data == MAP_FAILED)
+            throw exception::runtime(_("file can not be mapped"), *this);
+        #endif
+    }
+    
+    
+    /** destructor, removes the mapping **/
+    inline source::mapping::~mapping( void )
+    {
+        #ifndef _WIN32
+        ::munmap( m_data, m_size );
+        #endif
+    }
+    
+    
+    /** returns the data of the mapping
+     * @return pointer to the data
+     **/
+    inline const char* source::mapping::data( void ) const
+    {
+        #ifdef _WIN32
+        return m_file.data();
+        #else
+        return static_cast<const char*>(m_data);
+        #endif
+    }
+    
+    
+    /** returns the number of mapped bytes
+     * @return number of bytes
+     **/
+    inline std::size_t source::mapping::size( void ) const
+    {
+        #ifdef _WIN32
+        return m_file.size();
+        #else
+        return m_size;
+        #endif
+    }
+    
+    
+    /** constructor for a flat buffer, which holds the concatenated elements
+     * @param p_data buffer (the buffer must exist during the lifetime of the object)
+     * @param p_length number of bytes of each element
+     **/
+    inline source::source( const char* p_data, const std::vector<std::size_t>& p_length ) :
+        m_data( p_length.size(), NULL ),
+        m_size( p_length ),
+        m_files()
+    {
+        std::size_t l_offset = 0;
+        for(std::size_t i=0; i < m_size.size(); ++i) {
+            if (m_size[i])
+                m_data[i] = p_data + l_offset;
+            l_offset += m_size[i];
+        }
+    }
+    
+    
+    /** returns the number of elements
+     * @return number of elements
+     **/
+    inline std::size_t source::size( void ) const
+    {
+        return m_data.size();
+    }
+    
+    
+    /** returns the data of an element
+     * @param p_index index of the element
+     * @return pointer to the data (null on empty files)
+     **/
+    inline const char* source::getData( const std::size_t& p_index ) const
+    {
+        return m_data[p_index];
+    }
+    
+    
+    /** returns the number of bytes of an element
+     * @param p_index index of the element
+     * @return number of bytes
+     **/
+    inline std::size_t source::getSize( const std::size_t& p_index ) const
+    {
+        return m_size[p_index];
+    }
+    
+    
+}}}
+#endif
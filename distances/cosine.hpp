@@ -0,0 +1,274 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_COSINE_HPP
+#define __MACHINELEARNING_DISTANCES_COSINE_HPP
+
+#include <cmath>
+#include <algorithm>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/bindings/blas.hpp>
+#include <boost/numeric/bindings/trans.hpp>
+#include <boost/numeric/bindings/ublas/vector.hpp>
+#include <boost/numeric/bindings/ublas/matrix.hpp>
+
+#include "vectordistance.hpp"
+#include "../errorhandling/exception.hpp"
+#include "../tools/tools.h"
+
+
+namespace machinelearning { namespace distances {
+    
+    
+    #ifndef SWIG
+    namespace ublas  = boost::numeric::ublas;
+    namespace blas   = boost::numeric::bindings::blas;
+    namespace bind   = boost::numeric::bindings;
+    #endif
+    
+    
+    /** class for calculating the cosine distance beween datapoints [ 1 - a*b' / (||a|| * ||b||) ].
+     * The length and the normalization use the euclidian norm, a vector with zero length
+     * has got the distance 1 to every other vector. The values are in [0,2] and the
+     * triangle inequality does not hold, so the distance is not a metric. The data must
+     * not be normalized before, because the vector length is removed by the distance
+     **/
+    template<typename T> class cosine : public vectordistance<T>
+    {
+        
+        public:
+        
+            bool isMetric( void ) const;
+            T getInvert( const T& ) const;
+            #ifndef SWIG
+            void abs( ublas::vector<T>& ) const;
+            #endif
+        
+            ublas::matrix<T> getPairwiseDistance( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+            ublas::indirect_array<> getNearest( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+        
+        
+        #ifndef SWIG
+        protected :
+        
+            T kernel( const T*, const T*, const std::size_t& ) const;
+            T weightedKernel( const T*, const T*, const T*, const std::size_t& ) const;
+            T lengthKernel( const T*, const std::size_t& ) const;
+        
+        
+        private :
+        
+            static T getProductDistance( const T&, const T&, const T& );
+        #endif
+        
+    };
+    
+    
+    
+    /** the cosine distance is not a metric
+     * @return false
+     **/
+    template<typename T> inline bool cosine<T>::isMetric( void ) const
+    {
+        return false;
+    }
+    
+    
+    
+    /** returns a invertet value
+     * @param p_val value
+     * @return inverted value
+     **/
+    template<typename T> inline T cosine<T>::getInvert( const T& p_val ) const
+    {
+        return static_cast<T>(1) / p_val;
+    }
+    
+    
+    
+    /** calculate absolut values for every element of the vector like |vec|
+     * @param p_vec vector
+     **/
+    template<typename T> inline void cosine<T>::abs( ublas::vector<T>& p_vec ) const
+    {
+        for(std::size_t i=0; i < p_vec.size(); ++i)
+            p_vec(i) = std::fabs(p_vec(i));
+    }
+    
+    
+    
+    /** calculates the cosine distance of the inner product and the squared length values
+     * @param p_product inner product
+     * @param p_first squared length of the first vector
+     * @param p_second squared length of the second vector
+     * @return distance
+     **/
+    template<typename T> inline T cosine<T>::getProductDistance( const T& p_product, const T& p_first, const T& p_second )
+    {
+        if ((p_first <= 0) || (p_second <= 0))
+            return 1;
+        
+        return std::min( static_cast<T>(2), std::max( static_cast<T>(0), static_cast<T>(1) - p_product / std::sqrt(p_first * p_second) ) );
+    }
+    
+    
+    
+    /** distance kernel, the inner product and the both lengths are calculated within one pass
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_size number of elements
+     * @return distance
+     **/
+    template<typename T> inline T cosine<T>::kernel( const T* p_first, const T* p_second, const std::size_t& p_size ) const
+    {
+        T l_product = 0;
+        T l_first   = 0;
+        T l_second  = 0;
+        
+        #pragma omp simd reduction(+:l_product,l_first,l_second)
+        for(std::size_t i=0; i < p_size; ++i) {
+            l_product += p_first[i]  * p_second[i];
+            l_first   += p_first[i]  * p_first[i];
+            l_second  += p_second[i] * p_second[i];
+        }
+        
+        return getProductDistance( l_product, l_first, l_second );
+    }
+    
+    
+    
+    /** weighted distance kernel, the cosine distance between w .* a and w .* b
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_weight weight array
+     * @param p_size number of elements
+     * @return distance
+     **/
+    template<typename T> inline T cosine<T>::weightedKernel( const T* p_first, const T* p_second, const T* p_weight, const std::size_t& p_size ) const
+    {
+        T l_product = 0;
+        T l_first   = 0;
+        T l_second  = 0;
+        
+        #pragma omp simd reduction(+:l_product,l_first,l_second)
+        for(std::size_t i=0; i < p_size; ++i) {
+            const T l_weight = p_weight[i] * p_weight[i];
+            l_product += l_weight * p_first[i]  * p_second[i];
+            l_first   += l_weight * p_first[i]  * p_first[i];
+            l_second  += l_weight * p_second[i] * p_second[i];
+        }
+        
+        return getProductDistance( l_product, l_first, l_second );
+    }
+    
+    
+    
+    /** length kernel (euclidian length)
+     * @param p_data array
+     * @param p_size number of elements
+     * @return length
+     **/
+    template<typename T> inline T cosine<T>::lengthKernel( const T* p_data, const std::size_t& p_size ) const
+    {
+        T l_sum = 0;
+        
+        #pragma omp simd reduction(+:l_sum)
+        for(std::size_t i=0; i < p_size; ++i)
+            l_sum += p_data[i] * p_data[i];
+        
+        return std::sqrt(l_sum);
+    }
+    
+    
+    
+    /** calculates the distances between every row of the first and every row of the second matrix. The
+     * rows are normalized to unit length, so the main work is one BLAS-3 gemm call
+     * @param p_first first matrix
+     * @param p_second second matrix
+     * @return distance matrix (rows = rows of the first matrix, columns = rows of the second matrix)
+     **/
+    template<typename T> inline ublas::matrix<T> cosine<T>::getPairwiseDistance( const ublas::matrix<T>& p_first, const ublas::matrix<T>& p_second ) const
+    {
+        if (p_first.size2() != p_second.size2())
+            throw exception::runtime(_("matrix column size must be equal"), *this);
+        
+        // rows with zero length stay zero, so their similarity is zero and the distance is one
+        const ublas::matrix<T> l_first  = this->getNormalize(p_first);
+        const ublas::matrix<T> l_second = this->getNormalize(p_second);
+        
+        ublas::matrix<T> l_distances( p_first.size1(), p_second.size1() );
+        blas::gemm( static_cast<T>(-1), l_first, bind::trans(l_second), static_cast<T>(0), l_distances );
+        
+        #pragma omp parallel for shared(l_distances)
+        for(std::size_t i=0; i < l_distances.size1(); ++i)
+            for(std::size_t j=0; j < l_distances.size2(); ++j)
+                l_distances(i,j) = std::min( static_cast<T>(2), std::max( static_cast<T>(0), static_cast<T>(1) + l_distances(i,j) ) );
+        
+        return l_distances;
+    }
+    
+    
+    
+    /** determines for every row of the data matrix the index of the nearest row of the prototype matrix.
+     * The data is processed in row blocks, the length of the data row is equal for all prototypes,
+     * so only the prototypes must be normalized and the winner is the maximum of x*w'
+     * @param p_data data matrix
+     * @param p_prototypes prototype matrix
+     * @return index array with the nearest prototype of every data row
+     **/
+    template<typename T> inline ublas::indirect_array<> cosine<T>::getNearest( const ublas::matrix<T>& p_data, const ublas::matrix<T>& p_prototypes ) const
+    {
+        if (p_data.size2() != p_prototypes.size2())
+            throw exception::runtime(_("matrix column size must be equal"), *this);
+        if (p_prototypes.size1() == 0)
+            throw exception::runtime(_("prototype matrix must have one or more rows"), *this);
+        
+        // number of data rows, that are calculated with one gemm call
+        const std::size_t l_blocksize = 4096;
+        
+        const ublas::matrix<T> l_prototypes = this->getNormalize(p_prototypes);
+        ublas::indirect_array<> l_idx( p_data.size1() );
+        ublas::matrix<T> l_product;
+        
+        for(std::size_t n=0; n < p_data.size1(); n += l_blocksize) {
+            const std::size_t l_end = std::min( n+l_blocksize, p_data.size1() );
+            const ublas::matrix<T> l_block = ublas::subrange( p_data, n, l_end, 0, p_data.size2() );
+            
+            l_product.resize( l_block.size1(), l_prototypes.size1(), false );
+            blas::gemm( static_cast<T>(-1), l_block, bind::trans(l_prototypes), static_cast<T>(0), l_product );
+            
+            #pragma omp parallel for shared(l_product, l_idx)
+            for(std::size_t i=0; i < l_product.size1(); ++i)
+                l_idx[n+i] = tools::vector::argmin( ublas::row(l_product, i) );
+        }
+        
+        return l_idx;
+    }
+    
+    
+} }
+#endif
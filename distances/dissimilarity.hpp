@@ -0,0 +1,436 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_DISSIMILARITY_HPP
+#define __MACHINELEARNING_DISTANCES_DISSIMILARITY_HPP
+
+#include <map>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <boost/static_assert.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "../errorhandling/exception.hpp"
+#include "ncd.hpp"
+
+#if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+#include "../tools/files/hdf.hpp"
+#endif
+
+
+
+namespace machinelearning { namespace distances {
+    
+    #ifndef SWIG
+    namespace ublas = boost::numeric::ublas;
+    namespace bio   = boost::iostreams;
+    #endif
+    
+    
+    /** abstract class for a square dissimilarity matrix, which is not held
+     * in memory. The data is read in blocks (tiles), so algorithms, that
+     * work on relational data, can use large datasets
+     **/
+    template<typename T> class dissimilarity
+    {
+        #ifndef SWIG
+        BOOST_STATIC_ASSERT( !boost::is_integral<T>::value );
+        #endif
+        
+        
+        public :
+            
+            /** returns the number of rows / columns of the matrix **/
+            virtual std::size_t size( void ) const = 0;
+            
+            /** returns a block of the matrix (start row, number of rows, start column, number of columns) **/
+            virtual ublas::matrix<T> getBlock( const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t& ) const = 0;
+            
+            virtual ~dissimilarity( void ) {};
+        
+    };
+    
+    
+    
+    /** dissimilarity for a matrix, that is held in memory **/
+    template<typename T> class matrixdissimilarity : public dissimilarity<T>
+    {
+        
+        public :
+            
+            matrixdissimilarity( const ublas::matrix<T>& );
+            std::size_t size( void ) const;
+            ublas::matrix<T> getBlock( const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t& ) const;
+        
+        
+        private :
+            
+            /** reference to the matrix **/
+            const ublas::matrix<T>& m_matrix;
+        
+    };
+    
+    
+    
+    /** dissimilarity for a memory mapped binary file. The file stores
+     * the square matrix row-major without any header in the native
+     * representation of the value type
+     **/
+    template<typename T> class mappeddissimilarity : public dissimilarity<T>
+    {
+        
+        public :
+            
+            mappeddissimilarity( const std::string& );
+            std::size_t size( void ) const;
+            ublas::matrix<T> getBlock( const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t& ) const;
+            ~mappeddissimilarity( void );
+        
+        
+        private :
+            
+            /** mapped file **/
+            bio::mapped_file_source m_file;
+            /** number of rows / columns **/
+            std::size_t m_size;
+        
+    };
+    
+    
+    
+    #if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+    
+    /** dissimilarity for a matrix dataset within a HDF file. Only the
+     * selected block is read from the file
+     **/
+    template<typename T> class hdfdissimilarity : public dissimilarity<T>
+    {
+        
+        public :
+            
+            hdfdissimilarity( const tools::files::hdf&, const std::string&, const tools::files::hdf::datatype& = tools::files::hdf::NATIVE_DOUBLE );
+            std::size_t size( void ) const;
+            ublas::matrix<T> getBlock( const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t& ) const;
+        
+        
+        private :
+            
+            /** HDF file reference **/
+            const tools::files::hdf& m_file;
+            /** dataset path **/
+            const std::string m_path;
+            /** datatype for reading **/
+            const tools::files::hdf::datatype m_datatype;
+            /** number of rows / columns **/
+            std::size_t m_size;
+        
+    };
+    
+    #endif
+    
+    
+    
+    /** dissimilarity, that calculates the normalized compression distance
+     * of each block on demand. The compressed size of each element is calculated
+     * once on construction, so a block compresses only its pairs. Calculated blocks
+     * are cached up to a maximum number of matrix rows (the cache holds at most
+     * rows x size values), so an algorithm, that reads the matrix in each iteration,
+     * compresses the cached pairs only once. The blocks are cached in the order of the
+     * first request and are not replaced, because a cyclic read order would replace
+     * each block before it is read again
+     **/
+    template<typename T> class ncddissimilarity : public dissimilarity<T>
+    {
+        
+        public :
+            
+            ncddissimilarity( const ncd<T>&, const std::vector<std::string>&, const bool& = false, const std::size_t& = 1024 );
+            std::size_t size( void ) const;
+            ublas::matrix<T> getBlock( const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t& ) const;
+            std::size_t getCachedValues( void ) const;
+            void clearCache( void );
+        
+        
+        private :
+            
+            /** key of a cached block (start row / start column, number of rows / number of columns) **/
+            typedef std::pair< std::pair<std::size_t, std::size_t>, std::pair<std::size_t, std::size_t> > blockkey;
+            
+            /** ncd object **/
+            const ncd<T>& m_ncd;
+            /** data vector (strings or filenames) **/
+            const std::vector<std::string>& m_data;
+            /** flag, that the data vector holds filenames **/
+            const bool m_isfile;
+            /** compressed size of each element **/
+            const std::vector<std::size_t> m_compressedsize;
+            /** maximum number of cached values **/
+            const std::size_t m_cachesize;
+            /** cached blocks **/
+            mutable std::map< blockkey, ublas::matrix<T> > m_cache;
+            /** number of cached values **/
+            mutable std::size_t m_cachedvalues;
+        
+    };
+    
+    
+    
+    
+    /** constructor
+     * @param p_matrix square matrix (the matrix must exist during the lifetime of the object)
+     **/
+    template<typename T> inline matrixdissimilarity<T>::matrixdissimilarity( const ublas::matrix<T>& p_matrix ) :
+        m_matrix( p_matrix )
+    {
+        if (p_matrix.size1() != p_matrix.size2())
+            throw exception::runtime(_("matrix must be square"), *this);
+    }
+    
+    
+    /** returns the number of rows
+     * @return number of rows
+     **/
+    template<typename T> inline std::size_t matrixdissimilarity<T>::size( void ) const
+    {
+        return m_matrix.size1();
+    }
+    
+    
+    /** returns a block of the matrix, the block is cut at the border
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @param p_col start column
+     * @param p_cols number of columns
+     * @return block matrix
+     **/
+    template<typename T> inline ublas::matrix<T> matrixdissimilarity<T>::getBlock( const std::size_t& p_row, const std::size_t& p_rows, const std::size_t& p_col, const std::size_t& p_cols ) const
+    {
+        if ((p_row >= m_matrix.size1()) || (p_col >= m_matrix.size2()))
+            throw exception::runtime(_("block index is out of range"), *this);
+        
+        return ublas::subrange( m_matrix, p_row, std::min(p_row+p_rows, m_matrix.size1()), p_col, std::min(p_col+p_cols, m_matrix.size2()) );
+    }
+    
+    
+    
+    
+    /** constructor
+     * @param p_file filename
+     **/
+    template<typename T> inline mappeddissimilarity<T>::mappeddissimilarity( const std::string& p_file ) :
+        m_file( p_file ),
+        m_size( 0 )
+    {
+        if (!m_file.is_open())
+            throw exception::runtime(_("file can not be opened"), *this);
+        
+        m_size = static_cast<std::size_t>( std::floor(std::sqrt(static_cast<double>(m_file.size() / sizeof(T)))+0.5) );
+        if (m_size*m_size*sizeof(T) != m_file.size())
+            throw exception::runtime(_("file does not contain a square matrix"), *this);
+    }
+    
+    
+    /** destructor, that unmaps the file **/
+    template<typename T> inline mappeddissimilarity<T>::~mappeddissimilarity( void )
+    {
+        m_file.close();
+    }
+    
+    
+    /** returns the number of rows
+     * @return number of rows
+     **/
+    template<typename T> inline std::size_t mappeddissimilarity<T>::size( void ) const
+    {
+        return m_size;
+    }
+    
+    
+    /** returns a block of the matrix, the block is cut at the border
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @param p_col start column
+     * @param p_cols number of columns
+     * @return block matrix
+     **/
+    template<typename T> inline ublas::matrix<T> mappeddissimilarity<T>::getBlock( const std::size_t& p_row, const std::size_t& p_rows, const std::size_t& p_col, const std::size_t& p_cols ) const
+    {
+        if ((p_row >= m_size) || (p_col >= m_size))
+            throw exception::runtime(_("block index is out of range"), *this);
+        
+        const std::size_t l_rows = std::min(p_rows, m_size-p_row);
+        const std::size_t l_cols = std::min(p_cols, m_size-p_col);
+        const T* l_data          = reinterpret_cast<const T*>(m_file.data());
+        
+        ublas::matrix<T> l_block(l_rows, l_cols);
+        for(std::size_t i=0; i < l_rows; ++i)
+            std::copy( l_data + (p_row+i)*m_size + p_col, l_data + (p_row+i)*m_size + p_col + l_cols, l_block.data().begin() + i*l_cols );
+        
+        return l_block;
+    }
+    
+    
+    
+    
+    #if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+    
+    /** constructor
+     * @param p_file HDF object (the object must exist during the lifetime of the dissimilarity)
+     * @param p_path dataset path
+     * @param p_datatype datatype for reading
+     **/
+    template<typename T> inline hdfdissimilarity<T>::hdfdissimilarity( const tools::files::hdf& p_file, const std::string& p_path, const tools::files::hdf::datatype& p_datatype ) :
+        m_file( p_file ),
+        m_path( p_path ),
+        m_datatype( p_datatype ),
+        m_size( 0 )
+    {
+        const std::pair<std::size_t, std::size_t> l_size = m_file.getMatrixSize( m_path );
+        if (l_size.first != l_size.second)
+            throw exception::runtime(_("dataset must be a square matrix"), *this);
+        
+        m_size = l_size.first;
+    }
+    
+    
+    /** returns the number of rows
+     * @return number of rows
+     **/
+    template<typename T> inline std::size_t hdfdissimilarity<T>::size( void ) const
+    {
+        return m_size;
+    }
+    
+    
+    /** returns a block of the matrix, the block is cut at the border
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @param p_col start column
+     * @param p_cols number of columns
+     * @return block matrix
+     **/
+    template<typename T> inline ublas::matrix<T> hdfdissimilarity<T>::getBlock( const std::size_t& p_row, const std::size_t& p_rows, const std::size_t& p_col, const std::size_t& p_cols ) const
+    {
+        if ((p_row >= m_size) || (p_col >= m_size))
+            throw exception::runtime(_("block index is out of range"), *this);
+        
+        return m_file.readBlasMatrix<T>( m_path, m_datatype, p_row, p_rows, p_col, p_cols );
+    }
+    
+    #endif
+    
+    
+    
+    
+    /** constructor
+     * @param p_ncd ncd object (the object must exist during the lifetime of the dissimilarity)
+     * @param p_data data vector (the vector must exist during the lifetime of the dissimilarity)
+     * @param p_isfile data vector holds filenames
+     * @param p_cacherows maximum number of cached matrix rows, the cache needs up to rows x size x sizeof(T)
+     * bytes. The default is one block row of the relational neuralgas (1024 rows), zero disables the cache and
+     * the size of the data caches the whole matrix (for large data the matrix should be built once with the
+     * tiledncd and read with the hdfdissimilarity)
+     **/
+    template<typename T> inline ncddissimilarity<T>::ncddissimilarity( const ncd<T>& p_ncd, const std::vector<std::string>& p_data, const bool& p_isfile, const std::size_t& p_cacherows ) :
+        m_ncd( p_ncd ),
+        m_data( p_data ),
+        m_isfile( p_isfile ),
+        m_compressedsize( p_data.size() == 0 ? std::vector<std::size_t>() : p_ncd.getCompressedSize(p_data, p_isfile) ),
+        m_cachesize( std::min(p_cacherows, p_data.size()) * p_data.size() ),
+        m_cache(),
+        m_cachedvalues( 0 )
+    {
+        if (p_data.size() == 0)
+            throw exception::runtime(_("data vector need not be empty"), *this);
+    }
+    
+    
+    /** returns the number of rows
+     * @return number of rows
+     **/
+    template<typename T> inline std::size_t ncddissimilarity<T>::size( void ) const
+    {
+        return m_data.size();
+    }
+    
+    
+    /** returns the number of cached values
+     * @return number of values
+     **/
+    template<typename T> inline std::size_t ncddissimilarity<T>::getCachedValues( void ) const
+    {
+        return m_cachedvalues;
+    }
+    
+    
+    /** removes all cached blocks **/
+    template<typename T> inline void ncddissimilarity<T>::clearCache( void )
+    {
+        m_cache.clear();
+        m_cachedvalues = 0;
+    }
+    
+    
+    /** calculates a block of the distance matrix or returns the cached block, the block is cut at the border
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @param p_col start column
+     * @param p_cols number of columns
+     * @return block matrix
+     **/
+    template<typename T> inline ublas::matrix<T> ncddissimilarity<T>::getBlock( const std::size_t& p_row, const std::size_t& p_rows, const std::size_t& p_col, const std::size_t& p_cols ) const
+    {
+        if ((p_row >= m_data.size()) || (p_col >= m_data.size()))
+            throw exception::runtime(_("block index is out of range"), *this);
+        
+        const std::size_t l_rowend = std::min(p_row+p_rows, m_data.size());
+        const std::size_t l_colend = std::min(p_col+p_cols, m_data.size());
+        
+        const blockkey l_key( std::make_pair(p_row, p_col), std::make_pair(l_rowend-p_row, l_colend-p_col) );
+        const typename std::map< blockkey, ublas::matrix<T> >::const_iterator l_cached = m_cache.find( l_key );
+        if (l_cached != m_cache.end())
+            return l_cached->second;
+        
+        ublas::matrix<T> l_block = m_ncd.getBlock( m_data, m_compressedsize, p_row, p_rows, p_col, p_cols, m_isfile );
+        
+        // the main diagonal of the whole matrix must be zero
+        for(std::size_t i=std::max(p_row, p_col); i < std::min(l_rowend, l_colend); ++i)
+            l_block(i-p_row, i-p_col) = 0;
+        
+        if (l_block.size1()*l_block.size2() <= m_cachesize-m_cachedvalues) {
+            m_cache[l_key]  = l_block;
+            m_cachedvalues += l_block.size1()*l_block.size2();
+        }
+        
+        return l_block;
+    }
+    
+    
+}}
+#endif
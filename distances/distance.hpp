@@ -75,6 +75,12 @@ namespace machinelearning { namespace distances {
                 /** return the length of every row or column vector within the matrix **/
                 virtual ublas::vector<T> getLength( const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const = 0;
             
+                /** returns true if the distance is a metric (triangle inequality holds) **/
+                virtual bool isMetric( void ) const = 0;
+            
+                /** returns true if the distance can be split into the dimensions, so the absolute values of a difference vector are the parts of the distance (needed by the relevance learning) **/
+                virtual bool isSeparable( void ) const = 0;
+            
                 /** invert a value **/
                 virtual T getInvert( const T& ) const = 0;
                    
@@ -97,6 +103,12 @@ namespace machinelearning { namespace distances {
                 /** distances between row / column vectors of matrix and  row / column vectors of the other matrix **/
                 virtual ublas::vector<T> getDistance( const ublas::matrix<T>&, const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const = 0;
             
+                /** distances between every row vector of the first matrix and every row vector of the second matrix (rows of first x rows of second) **/
+                virtual ublas::matrix<T> getPairwiseDistance( const ublas::matrix<T>&, const ublas::matrix<T>& ) const = 0;
+            
+                /** index of the nearest row vector of the second matrix for every row vector of the first matrix **/
+                virtual ublas::indirect_array<> getNearest( const ublas::matrix<T>&, const ublas::matrix<T>& ) const = 0;
+            
             
                 #ifndef SWIG
                 /** weight distance between two vectors **/
@@ -110,6 +122,9 @@ namespace machinelearning { namespace distances {
             
                 /** distances between row / column vectors of matrix and  row / column of the weighted matrix **/
                 virtual ublas::vector<T> getWeightedDistance( const ublas::matrix<T>&, const ublas::vector<T>&, const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const = 0;
+            
+                /** index of the nearest row vector of the second matrix for one row of the first matrix, each row of the second matrix is weighted by the same row of the weight matrix **/
+                virtual std::size_t getWeightedNearest( const ublas::matrix<T>&, const std::size_t&, const ublas::matrix<T>&, const ublas::matrix<T>& ) const = 0;
                 #endif
 
         };
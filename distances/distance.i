@@ -40,10 +40,14 @@
 %typemap(javaout)            ublas::matrix<double> machinelearning::distances::distance<double>::getNormalize     ";"
 %typemap(javaout)            double machinelearning::distances::distance<double>::getLength                       ";"
 %typemap(javaout)            ublas::vector<double> machinelearning::distances::distance<double>::getLength        ";"
+%typemap(javaout)            bool machinelearning::distances::distance<double>::isMetric                          ";"
+%typemap(javaout)            bool machinelearning::distances::distance<double>::isSeparable                       ";"
 %typemap(javaout)            double machinelearning::distances::distance<double>::getInvert                       ";"
 %typemap(javaout)            ublas::vector<double> machinelearning::distances::distance<double>::getAbs           ";"
 %typemap(javaout)            double machinelearning::distances::distance<double>::getDistance                     ";"
 %typemap(javaout)            ublas::vector<double> machinelearning::distances::distance<double>::getDistance      ";"
+%typemap(javaout)            ublas::matrix<double> machinelearning::distances::distance<double>::getPairwiseDistance ";"
+%typemap(javaout)            ublas::indirect_array<> machinelearning::distances::distance<double>::getNearest   ";"
 #endif
 
 
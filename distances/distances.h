@@ -37,12 +37,24 @@ namespace machinelearning {
         /** namespace for norm structures **/
         namespace norm { }
         
+        /** namespace for the compression algorithms of the NCD **/
+        namespace compression { }
+        
     }
 }
         
 
 #include "distance.hpp"
 #include "ncd.hpp"
+#include "minhash.hpp"
+#include "dissimilarity.hpp"
+#include "tiledncd.hpp"
+#include "vectordistance.hpp"
+#include "cosine.hpp"
+#include "mahalanobis.hpp"
 #include "norm/euclid.hpp"
+#include "norm/manhattan.hpp"
+#include "norm/chebyshev.hpp"
+#include "norm/minkowski.hpp"
 
 #endif
@@ -0,0 +1,314 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_MAHALANOBIS_HPP
+#define __MACHINELEARNING_DISTANCES_MAHALANOBIS_HPP
+
+#include <cmath>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/bindings/blas.hpp>
+#include <boost/numeric/bindings/trans.hpp>
+#include <boost/numeric/bindings/ublas/matrix.hpp>
+
+#include "vectordistance.hpp"
+#include "norm/euclid.hpp"
+#include "../errorhandling/exception.hpp"
+#include "../tools/tools.h"
+
+
+namespace machinelearning { namespace distances {
+    
+    
+    #ifndef SWIG
+    namespace ublas  = boost::numeric::ublas;
+    namespace blas   = boost::numeric::bindings::blas;
+    namespace bind   = boost::numeric::bindings;
+    #endif
+    
+    
+    /** class for calculating the mahalanobis distance beween datapoints [ sqrt( (a-b)' * inv(C) * (a-b) ) ].
+     * The covariance matrix C is decomposed into C = L*L' (cholesky), so the distance is the euclidian
+     * norm of inv(L)*(a-b). The pairwise and nearest calculations transform the data once with inv(L)
+     * and use the BLAS-3 euclidian calculation
+     * @note getAbs and getInvert work on distance values (e.g. the quantization error of the clustering),
+     * a distance d is mapped to the quadratic form d^2 = (a-b)' * inv(C) * (a-b). The quadratic form can
+     * not be split into the dimensions, so a difference vector can not be passed and the relevance
+     * learning (rlvq) rejects this distance
+     **/
+    template<typename T> class mahalanobis : public vectordistance<T>
+    {
+        
+        public:
+        
+            mahalanobis( const ublas::matrix<T>& );
+        
+            bool isMetric( void ) const;
+            bool isSeparable( void ) const;
+            T getInvert( const T& ) const;
+            #ifndef SWIG
+            void abs( ublas::vector<T>& ) const;
+            #endif
+        
+            ublas::matrix<T> getPairwiseDistance( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+            ublas::indirect_array<> getNearest( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+        
+        
+        #ifndef SWIG
+        protected :
+        
+            T kernel( const T*, const T*, const std::size_t& ) const;
+            T weightedKernel( const T*, const T*, const T*, const std::size_t& ) const;
+            T lengthKernel( const T*, const std::size_t& ) const;
+            void checkDimension( const std::size_t& ) const;
+        #endif
+        
+        
+        private :
+        
+            /** lower triangular matrix inv(L) of the cholesky decomposition **/
+            ublas::matrix<T> m_transform;
+            /** euclidian distance for the transformed data **/
+            const norm::euclid<T> m_euclid;
+        
+            ublas::matrix<T> transform( const ublas::matrix<T>& ) const;
+        
+    };
+    
+    
+    
+    /** constructor
+     * @param p_covariance symmetric, positive definite covariance matrix
+     **/
+    template<typename T> inline mahalanobis<T>::mahalanobis( const ublas::matrix<T>& p_covariance ) :
+        m_transform( p_covariance.size1(), p_covariance.size2(), 0 ),
+        m_euclid()
+    {
+        if (p_covariance.size1() != p_covariance.size2())
+            throw exception::runtime(_("covariance matrix must be square"), *this);
+        
+        // cholesky decomposition C = L*L' on the lower triangle
+        ublas::matrix<T> l_lower( p_covariance.size1(), p_covariance.size2(), 0 );
+        for(std::size_t j=0; j < l_lower.size1(); ++j) {
+            T l_sum = p_covariance(j,j);
+            for(std::size_t k=0; k < j; ++k)
+                l_sum -= l_lower(j,k) * l_lower(j,k);
+            
+            if (l_sum <= 0)
+                throw exception::runtime(_("covariance matrix must be positive definite"), *this);
+            l_lower(j,j) = std::sqrt(l_sum);
+            
+            for(std::size_t i=j+1; i < l_lower.size1(); ++i) {
+                l_sum = p_covariance(i,j);
+                for(std::size_t k=0; k < j; ++k)
+                    l_sum -= l_lower(i,k) * l_lower(j,k);
+                l_lower(i,j) = l_sum / l_lower(j,j);
+            }
+        }
+        
+        // inversion of the lower triangular matrix with forward substitution
+        for(std::size_t j=0; j < l_lower.size1(); ++j) {
+            m_transform(j,j) = static_cast<T>(1) / l_lower(j,j);
+            
+            for(std::size_t i=j+1; i < l_lower.size1(); ++i) {
+                T l_sum = 0;
+                for(std::size_t k=j; k < i; ++k)
+                    l_sum += l_lower(i,k) * m_transform(k,j);
+                m_transform(i,j) = -l_sum / l_lower(i,i);
+            }
+        }
+    }
+    
+    
+    
+    /** the mahalanobis distance is a metric
+     * @return true
+     **/
+    template<typename T> inline bool mahalanobis<T>::isMetric( void ) const
+    {
+        return true;
+    }
+    
+    
+    /** the quadratic form mixes the dimensions, so it can not be split
+     * @return false
+     **/
+    template<typename T> inline bool mahalanobis<T>::isSeparable( void ) const
+    {
+        return false;
+    }
+    
+    
+    
+    /** returns the inverted quadratic form of a distance value [ 1 / ((a-b)' * inv(C) * (a-b)) ]
+     * @param p_val distance value
+     * @return inverted value
+     **/
+    template<typename T> inline T mahalanobis<T>::getInvert( const T& p_val ) const
+    {
+        return static_cast<T>(1) / (p_val * p_val);
+    }
+    
+    
+    
+    /** maps every distance value of the vector to the quadratic form [ (a-b)' * inv(C) * (a-b) ]
+     * @param p_vec vector with distance values
+     **/
+    template<typename T> inline void mahalanobis<T>::abs( ublas::vector<T>& p_vec ) const
+    {
+        for(std::size_t i=0; i < p_vec.size(); ++i)
+            p_vec(i) *= p_vec(i);
+    }
+    
+    
+    
+    /** checks the data dimension against the size of the covariance matrix
+     * @param p_dim data dimension
+     **/
+    template<typename T> inline void mahalanobis<T>::checkDimension( const std::size_t& p_dim ) const
+    {
+        if (p_dim != m_transform.size2())
+            throw exception::runtime(_("data dimension and covariance matrix size must be equal"), *this);
+    }
+    
+    
+    
+    /** distance kernel [ norm2( inv(L) * (a-b) ) ], only the lower triangle of inv(L) is used
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_size number of elements
+     * @return distance
+     **/
+    template<typename T> inline T mahalanobis<T>::kernel( const T* p_first, const T* p_second, const std::size_t& p_size ) const
+    {
+        T l_sum = 0;
+        for(std::size_t i=0; i < p_size; ++i) {
+            const T* l_row = this->getRow(m_transform, i);
+            T l_value      = 0;
+            
+            #pragma omp simd reduction(+:l_value)
+            for(std::size_t j=0; j <= i; ++j)
+                l_value += l_row[j] * (p_first[j] - p_second[j]);
+            
+            l_sum += l_value * l_value;
+        }
+        
+        return std::sqrt(l_sum);
+    }
+    
+    
+    
+    /** weighted distance kernel [ norm2( inv(L) * (w .* (a-b)) ) ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_weight weight array
+     * @param p_size number of elements
+     * @return distance
+     **/
+    template<typename T> inline T mahalanobis<T>::weightedKernel( const T* p_first, const T* p_second, const T* p_weight, const std::size_t& p_size ) const
+    {
+        T l_sum = 0;
+        for(std::size_t i=0; i < p_size; ++i) {
+            const T* l_row = this->getRow(m_transform, i);
+            T l_value      = 0;
+            
+            #pragma omp simd reduction(+:l_value)
+            for(std::size_t j=0; j <= i; ++j)
+                l_value += l_row[j] * p_weight[j] * (p_first[j] - p_second[j]);
+            
+            l_sum += l_value * l_value;
+        }
+        
+        return std::sqrt(l_sum);
+    }
+    
+    
+    
+    /** length kernel [ norm2( inv(L) * a ) ]
+     * @param p_data array
+     * @param p_size number of elements
+     * @return length
+     **/
+    template<typename T> inline T mahalanobis<T>::lengthKernel( const T* p_data, const std::size_t& p_size ) const
+    {
+        T l_sum = 0;
+        for(std::size_t i=0; i < p_size; ++i) {
+            const T* l_row = this->getRow(m_transform, i);
+            T l_value      = 0;
+            
+            #pragma omp simd reduction(+:l_value)
+            for(std::size_t j=0; j <= i; ++j)
+                l_value += l_row[j] * p_data[j];
+            
+            l_sum += l_value * l_value;
+        }
+        
+        return std::sqrt(l_sum);
+    }
+    
+    
+    
+    /** transforms every row of the matrix with inv(L) [ matrix * inv(L)' ]
+     * @param p_matrix matrix
+     * @return transformed matrix
+     **/
+    template<typename T> inline ublas::matrix<T> mahalanobis<T>::transform( const ublas::matrix<T>& p_matrix ) const
+    {
+        checkDimension( p_matrix.size2() );
+        
+        ublas::matrix<T> l_transform( p_matrix.size1(), m_transform.size1() );
+        blas::gemm( static_cast<T>(1), p_matrix, bind::trans(m_transform), static_cast<T>(0), l_transform );
+        return l_transform;
+    }
+    
+    
+    
+    /** calculates the distances between every row of the first and every row of the second matrix. Both
+     * matrices are transformed with inv(L), so the euclidian BLAS-3 calculation can be used
+     * @param p_first first matrix
+     * @param p_second second matrix
+     * @return distance matrix (rows = rows of the first matrix, columns = rows of the second matrix)
+     **/
+    template<typename T> inline ublas::matrix<T> mahalanobis<T>::getPairwiseDistance( const ublas::matrix<T>& p_first, const ublas::matrix<T>& p_second ) const
+    {
+        return m_euclid.getPairwiseDistance( transform(p_first), transform(p_second) );
+    }
+    
+    
+    
+    /** determines for every row of the data matrix the index of the nearest row of the prototype matrix
+     * on the transformed data
+     * @param p_data data matrix
+     * @param p_prototypes prototype matrix
+     * @return index array with the nearest prototype of every data row
+     **/
+    template<typename T> inline ublas::indirect_array<> mahalanobis<T>::getNearest( const ublas::matrix<T>& p_data, const ublas::matrix<T>& p_prototypes ) const
+    {
+        return m_euclid.getNearest( transform(p_data), transform(p_prototypes) );
+    }
+    
+    
+} }
+#endif
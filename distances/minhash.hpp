@@ -0,0 +1,253 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_MINHASH_HPP
+#define __MACHINELEARNING_DISTANCES_MINHASH_HPP
+
+#include <omp.h>
+#include <string>
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#include <boost/cstdint.hpp>
+
+#include "../errorhandling/exception.hpp"
+#include "compression/source.hpp"
+
+
+
+namespace machinelearning { namespace distances {
+    
+    
+    /** class for a MinHash sketch of byte shingles, that is used as prefilter
+     * of the NCD. The signatures are grouped with locality-sensitive hashing
+     * (banding), so documents that share a bucket are candidate pairs. The
+     * candidates of each document are ranked by the estimated Jaccard similarity
+     * of the shingle sets
+     * @see http://en.wikipedia.org/wiki/MinHash
+     **/
+    class minhash
+    {
+        
+        public :
+            
+            minhash( const std::size_t& = 5, const std::size_t& = 128, const std::size_t& = 64, const std::size_t& = 64, const std::size_t& = 512 );
+            std::vector< std::vector<std::size_t> > getCandidates( const std::vector<std::string>&, const bool& = false ) const;
+            std::vector< std::vector<std::size_t> > getCandidates( const compression::source& ) const;
+            std::size_t getCandidateCount( void ) const;
+        
+        
+        private :
+            
+            /** number of bytes of a shingle **/
+            const std::size_t m_shingle;
+            /** number of hash functions (length of the signature) **/
+            const std::size_t m_hashes;
+            /** number of bands **/
+            const std::size_t m_bands;
+            /** maximum number of candidates of a document **/
+            const std::size_t m_candidates;
+            /** maximum size of a bucket, larger buckets are ignored **/
+            const std::size_t m_bucketsize;
+            /** seeds of the hash functions **/
+            std::vector<boost::uint64_t> m_seeds;
+            
+            void getSignature( const char*, const std::size_t&, boost::uint64_t* ) const;
+            boost::uint64_t mix( boost::uint64_t ) const;
+        
+    };
+    
+    
+    
+    /** constructor
+     * @param p_shingle number of bytes of a shingle
+     * @param p_hashes number of hash functions
+     * @param p_bands number of bands (the number of hash functions must be a multiple of the bands, more bands create more candidates)
+     * @param p_candidates maximum number of candidates of each document
+     * @param p_bucketsize maximum size of a bucket, larger buckets are ignored, because they consist of common shingles
+     **/
+    inline minhash::minhash( const std::size_t& p_shingle, const std::size_t& p_hashes, const std::size_t& p_bands, const std::size_t& p_candidates, const std::size_t& p_bucketsize ) :
+        m_shingle( p_shingle ),
+        m_hashes( p_hashes ),
+        m_bands( p_bands ),
+        m_candidates( p_candidates ),
+        m_bucketsize( p_bucketsize ),
+        m_seeds( p_hashes )
+    {
+        if ((p_shingle == 0) || (p_hashes == 0) || (p_bands == 0) || (p_candidates == 0) || (p_bucketsize < 2))
+            throw exception::runtime(_("sketch parameters must be greater than zero"), *this);
+        if (p_hashes % p_bands)
+            throw exception::runtime(_("number of hash functions must be a multiple of the bands"), *this);
+        
+        for(std::size_t i=0; i < m_seeds.size(); ++i)
+            m_seeds[i] = mix( static_cast<boost::uint64_t>(i+1) );
+    }
+    
+    
+    /** returns the maximum number of candidates
+     * @return number of candidates
+     **/
+    inline std::size_t minhash::getCandidateCount( void ) const
+    {
+        return m_candidates;
+    }
+    
+    
+    /** mixing function of the 64 bit hash values (finalizer of SplitMix64)
+     * @param p_value input value
+     * @return hash value
+     **/
+    inline boost::uint64_t minhash::mix( boost::uint64_t p_value ) const
+    {
+        p_value += 0x9E3779B97F4A7C15ULL;
+        p_value  = (p_value ^ (p_value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        p_value  = (p_value ^ (p_value >> 27)) * 0x94D049BB133111EBULL;
+        return p_value ^ (p_value >> 31);
+    }
+    
+    
+    /** calculates the MinHash signature of a byte array, a document which is
+     * shorter than a shingle is used as one shingle
+     * @param p_data data
+     * @param p_size number of bytes
+     * @param p_signature output array with the signature
+     **/
+    inline void minhash::getSignature( const char* p_data, const std::size_t& p_size, boost::uint64_t* p_signature ) const
+    {
+        std::fill( p_signature, p_signature+m_hashes, std::numeric_limits<boost::uint64_t>::max() );
+        
+        const std::size_t l_shingle = std::min(m_shingle, p_size);
+        for(std::size_t i=0; (i == 0) || (i+l_shingle <= p_size); ++i) {
+            
+            // FNV-1a hash of the shingle
+            boost::uint64_t l_hash = 0xCBF29CE484222325ULL;
+            for(std::size_t n=i; n < i+l_shingle; ++n)
+                l_hash = (l_hash ^ static_cast<unsigned char>(p_data[n])) * 0x100000001B3ULL;
+            
+            for(std::size_t n=0; n < m_hashes; ++n)
+                p_signature[n] = std::min( p_signature[n], mix(l_hash ^ m_seeds[n]) );
+        }
+    }
+    
+    
+    /** returns the candidates of each document, sorted by the estimated
+     * similarity in descending order
+     * @param p_data data vector (strings or filenames)
+     * @param p_isfile data vector holds filenames
+     * @return vector with the candidate indices of each document
+     **/
+    inline std::vector< std::vector<std::size_t> > minhash::getCandidates( const std::vector<std::string>& p_data, const bool& p_isfile ) const
+    {
+        if (p_data.size() == 0)
+            throw exception::runtime(_("data vector need not be empty"), *this);
+        
+        const compression::source l_source( p_data, p_isfile );
+        return getCandidates( l_source );
+    }
+    
+    
+    /** returns the candidates of each document, sorted by the estimated
+     * similarity in descending order
+     * @param p_source input data
+     * @return vector with the candidate indices of each document
+     **/
+    inline std::vector< std::vector<std::size_t> > minhash::getCandidates( const compression::source& p_source ) const
+    {
+        if (p_source.size() == 0)
+            throw exception::runtime(_("data vector need not be empty"), *this);
+        
+        // create the signatures
+        std::vector<boost::uint64_t> l_signature( p_source.size() * m_hashes );
+        
+        #pragma omp parallel for shared(l_signature) schedule(dynamic)
+        for(std::size_t i=0; i < p_source.size(); ++i)
+            getSignature( p_source.getData(i), p_source.getSize(i), &l_signature[i*m_hashes] );
+        
+        
+        // each band is hashed into buckets, all documents in a bucket are candidates of each other
+        const std::size_t l_rows = m_hashes / m_bands;
+        std::vector< std::vector<std::size_t> > l_candidates( p_source.size() );
+        std::vector< std::pair<boost::uint64_t, std::size_t> > l_bucket( p_source.size() );
+        
+        for(std::size_t n=0; n < m_bands; ++n) {
+            for(std::size_t i=0; i < p_source.size(); ++i) {
+                boost::uint64_t l_key = m_seeds[n];
+                for(std::size_t j=n*l_rows; j < (n+1)*l_rows; ++j)
+                    l_key = mix( l_key ^ l_signature[i*m_hashes+j] );
+                
+                l_bucket[i] = std::make_pair( l_key, i );
+            }
+            std::sort( l_bucket.begin(), l_bucket.end() );
+            
+            for(std::size_t start=0, end=1; start < l_bucket.size(); start=end, end=start+1) {
+                while ((end < l_bucket.size()) && (l_bucket[end].first == l_bucket[start].first))
+                    end++;
+                
+                if ((end-start < 2) || (end-start > m_bucketsize))
+                    continue;
+                
+                for(std::size_t i=start; i < end; ++i)
+                    for(std::size_t j=start; j < end; ++j)
+                        if (i != j)
+                            l_candidates[l_bucket[i].second].push_back( l_bucket[j].second );
+            }
+        }
+        
+        
+        // rank the candidates of each document by the number of equal signature elements
+        #pragma omp parallel for shared(l_candidates) schedule(dynamic)
+        for(std::size_t i=0; i < l_candidates.size(); ++i) {
+            std::vector<std::size_t>& l_document = l_candidates[i];
+            
+            std::sort( l_document.begin(), l_document.end() );
+            l_document.erase( std::unique(l_document.begin(), l_document.end()), l_document.end() );
+            
+            std::vector< std::pair<std::size_t, std::size_t> > l_rank( l_document.size() );
+            for(std::size_t j=0; j < l_document.size(); ++j) {
+                std::size_t l_equal = 0;
+                for(std::size_t n=0; n < m_hashes; ++n)
+                    if (l_signature[i*m_hashes+n] == l_signature[l_document[j]*m_hashes+n])
+                        l_equal++;
+                
+                l_rank[j] = std::make_pair( l_equal, l_document[j] );
+            }
+            
+            const std::size_t l_count = std::min(m_candidates, l_rank.size());
+            std::partial_sort( l_rank.begin(), l_rank.begin()+l_count, l_rank.end(), std::greater< std::pair<std::size_t, std::size_t> >() );
+            
+            l_document.resize( l_count );
+            for(std::size_t j=0; j < l_count; ++j)
+                l_document[j] = l_rank[j].second;
+        }
+        
+        return l_candidates;
+    }
+    
+    
+}}
+#endif
@@ -28,28 +28,34 @@
 
 #include <omp.h>
 #include <string>
+#include <exception>
 #include <sstream>
 #include <iostream>
 #include <ostream>
 #include <fstream>
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <functional>
 
 #ifdef MACHINELEARNING_MPI
 #include <boost/mpi.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/string.hpp>
 #endif
 
 #include <boost/static_assert.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/symmetric.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
 
-#include <boost/iostreams/filter/gzip.hpp>
-#include <boost/iostreams/filter/bzip2.hpp>
-
-#include <boost/iostreams/stream.hpp>
-#include <boost/iostreams/device/null.hpp>
-#include <boost/iostreams/filtering_streambuf.hpp>
-#include <boost/iostreams/filter/counter.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "../errorhandling/exception.hpp"
+#include "compression/compressor.hpp"
+#include "compression/source.hpp"
+#include "minhash.hpp"
 
 
 
@@ -58,7 +64,6 @@ namespace machinelearning { namespace distances {
     
     #ifndef SWIG
     namespace ublas = boost::numeric::ublas;
-    namespace bio   = boost::iostreams;
     #ifdef MACHINELEARNING_MPI
     namespace mpi   = boost::mpi;
     #endif
@@ -68,6 +73,15 @@ namespace machinelearning { namespace distances {
     /**
      * class for calculating the normalized compression distance (NCD)
      * with some different algorithms like gzip and bzip2
+     * @note xz, zstd, lz4 and brotli can be used only if the support is
+     * compiled in (MACHINELEARNING_COMPRESSION_XZ, MACHINELEARNING_COMPRESSION_ZSTD,
+     * MACHINELEARNING_COMPRESSION_LZ4, MACHINELEARNING_COMPRESSION_BROTLI),
+     * otherwise an exception is thrown
+     * @note the compressors count the raw streams of the libraries, the gzip size is the raw
+     * deflate stream, which is the gzip file size without the 18 bytes of header & footer, that
+     * were removed before. NCD values differ from versions, that compressed with the boost::iostreams
+     * filter chain, because the counter of the chain returned the same size for short strings and
+     * files were read without whitespaces
      **/
     template<typename T> class ncd
     {
@@ -81,7 +95,11 @@ namespace machinelearning { namespace distances {
             enum compresstype
             {
                 gzip, 
-                bzip2
+                bzip2,
+                xz,
+                zstd,
+                lz4,
+                brotli
             };
             
             enum compresslevel
@@ -99,22 +117,51 @@ namespace machinelearning { namespace distances {
             ublas::symmetric_matrix<T, ublas::upper> symmetric ( const std::vector<std::string>&, const bool& = false ) const;
             T calculate ( const std::string&, const std::string&, const bool& = false ) const;
             void setCompressionLevel( const compresslevel& = defaultcompression );
+            void setCompressionLevel( const int& );
+            void setPriming( const bool& = true );
+            bool getPriming( void ) const;
+            
+            #ifndef SWIG
+            compresstype getCompressionType( void ) const;
+            int getCompressionLevel( void ) const;
+            bool isNativeCompressionLevel( void ) const;
+            ublas::compressed_matrix<T> nearest ( const std::vector<std::string>&, const std::size_t&, const minhash& = minhash(), const bool& = false ) const;
+            std::vector<std::size_t> getCompressedSize ( const std::vector<std::string>&, const bool& = false ) const;
+            ublas::matrix<T> getBlock ( const std::vector<std::string>&, const std::vector<std::size_t>&, const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t&, const bool& = false, const bool& = false ) const;
+            #endif
             
             #ifdef MACHINELEARNING_MPI
             ublas::matrix<T> unsquare ( const mpi::communicator&, const std::vector<std::string>&, const bool& = false ) const;
+            std::vector<std::string> distribute ( const mpi::communicator&, const std::vector<std::string>&, const bool& = false ) const;
             #endif
             
         private:
             
             /** type for internal compression state **/
             const compresstype m_compress;
-            /** parameter for gzip **/
-            bio::gzip_params m_gzipparam;
-            /** parameter for bzip2 **/
-            bio::bzip2_params m_bzip2param;
+            /** compression level **/
+            compresslevel m_level;
+            /** flag for using the native level of the algorithm **/
+            bool m_nativelevel;
+            /** native level of the algorithm **/
+            int m_levelvalue;
+            /** flag for priming the compressor with the first element of a pair **/
+            bool m_priming;
             
-            std::size_t deflate ( const bool&, const std::string&, const std::string& = "" ) const;        
-            std::multimap<std::size_t, std::pair<std::size_t,std::size_t> > getWavefrontIndex( const std::size_t&, const std::size_t& ) const;
+            #ifndef SWIG
+            boost::shared_ptr<compression::compressor> getCompressor( void ) const;
+            template<typename C> boost::shared_ptr<compression::compressor> createCompressor( void ) const;
+            std::size_t deflate ( compression::compressor&, const compression::source&, const std::size_t& ) const;
+            std::size_t deflate ( compression::compressor&, const compression::source&, const std::size_t&, const compression::source&, const std::size_t& ) const;
+            ublas::matrix<T> primed ( const compression::source&, const compression::source&, const std::vector<std::size_t>& ) const;
+            boost::shared_ptr<compression::compressor> getCompressor( std::string& ) const;
+            bool isError( const std::string& ) const;
+            void setError( std::string&, const std::exception& ) const;
+            ublas::matrix<T> calculateBlock ( const compression::source&, const compression::source&, const std::vector<std::size_t>&, const std::vector<std::size_t>&, const bool& = false ) const;
+            std::vector<std::size_t> getSingletonSize( const compression::source& ) const;
+            std::vector<std::size_t> getLengthOrder( const compression::source& ) const;
+            #endif
+            T getDistance( const std::size_t&, const std::size_t&, const std::size_t& ) const;
     };
     
     
@@ -123,63 +170,232 @@ namespace machinelearning { namespace distances {
     /** default constructor **/
     template<typename T> inline ncd<T>::ncd( void ) :
         m_compress ( gzip ),
-        m_gzipparam( bio::gzip::default_compression ),
-        m_bzip2param( 6 )
+        m_level( defaultcompression ),
+        m_nativelevel( false ),
+        m_levelvalue( 0 ),
+        m_priming( false )
     {}
     
     
-    /** constructor with the compression parameter
+    /** constructor with the compression parameter, an algorithm that is not compiled in
+     * is rejected here, so the error is not reported by the first calculation
      * @param p_compress enum value that is declared inside the class
      **/
     template<typename T> inline ncd<T>::ncd( const compresstype& p_compress ) :
         m_compress ( p_compress ),
-        m_gzipparam( bio::gzip::default_compression ),
-        m_bzip2param( 6 )
-    {}
+        m_level( defaultcompression ),
+        m_nativelevel( false ),
+        m_levelvalue( 0 ),
+        m_priming( false )
+    {
+        getCompressor();
+    }
     
     
-    /** creates wavefront index pairs for using on multithreaded systems
-     * @param p_size number of rows or columns
-     * @param p_threads number of threads
-     * @return map with indices
+    /** calculates the compressed size of each element in parallel
+     * @param p_source input data
+     * @return vector with the compressed sizes
      **/
-    template<typename T> inline std::multimap<std::size_t, std::pair<std::size_t,std::size_t> > ncd<T>::getWavefrontIndex( const std::size_t& p_size, const std::size_t& p_threads ) const
+    template<typename T> inline std::vector<std::size_t> ncd<T>::getSingletonSize( const compression::source& p_source ) const
     {
-        std::multimap<std::size_t, std::pair<std::size_t,std::size_t> > l_wavefront;
-        
-        // create wavefront in this case: (0,n) = 0, (0,n-1) = 1, (1,n) = 2 ...
-        // we must create only the upper or lower index position, the other one can be created of swapping the index position
-        std::size_t n=0;
-        for(std::size_t i=1; i < p_size; ++i)
-            for(std::size_t j=0; (i+j) < p_size; ++j)
-                l_wavefront.insert(  std::pair<std::size_t, std::pair<std::size_t,std::size_t> >(n++ % p_threads, std::pair<std::size_t,std::size_t>(j,i+j))  );
+        std::vector<std::size_t> l_size( p_source.size(), 0 );
+        std::string l_error;
+        
+        #pragma omp parallel shared(l_size, l_error)
+        {
+            const boost::shared_ptr<compression::compressor> l_compressor = getCompressor(l_error);
             
-        return l_wavefront;
+            #pragma omp for schedule(dynamic)
+            for(std::size_t i=0; i < p_source.size(); ++i) {
+                if (!l_compressor || isError(l_error))
+                    continue;
+                
+                try {
+                    l_size[i] = deflate(*l_compressor, p_source, i);
+                } catch (const std::exception& e) {
+                    setError(l_error, e);
+                }
+            }
+        }
+        
+        if (!l_error.empty())
+            throw exception::runtime(l_error);
+        
+        return l_size;
     }
     
-      
+    
+    /** returns the indices of the elements ordered by descending length. Rows, that are
+     * processed in this order with a dynamic schedule, are started with the largest
+     * work, so the threads are balanced at the end of the run
+     * @param p_source input data
+     * @return index vector
+     **/
+    template<typename T> inline std::vector<std::size_t> ncd<T>::getLengthOrder( const compression::source& p_source ) const
+    {
+        std::vector< std::pair<std::size_t,std::size_t> > l_length( p_source.size() );
+        for(std::size_t i=0; i < p_source.size(); ++i)
+            l_length[i] = std::make_pair( p_source.getSize(i), i );
+        
+        std::sort( l_length.begin(), l_length.end(), std::greater< std::pair<std::size_t,std::size_t> >() );
+        
+        std::vector<std::size_t> l_order( p_source.size() );
+        for(std::size_t i=0; i < l_length.size(); ++i)
+            l_order[i] = l_length[i].second;
+        
+        return l_order;
+    }
+    
+    
+    /** calculates the NCD value of the compressed sizes
+     * @param p_concat compressed size of the concatenation
+     * @param p_first compressed size of the first element
+     * @param p_second compressed size of the second element
+     * @return distance value
+     **/
+    template<typename T> inline T ncd<T>::getDistance( const std::size_t& p_concat, const std::size_t& p_first, const std::size_t& p_second ) const
+    {
+        const std::size_t l_min = std::min(p_first, p_second);
+        const std::size_t l_max = std::max(p_first, p_second);
+        
+        if ((l_max == 0) || (p_concat <= l_min))
+            return static_cast<T>(0);
+        
+        return std::min( static_cast<T>(1), static_cast<T>(p_concat - l_min) / l_max );
+    }
+    
+    
     /** sets the compression level
      * @param  p_level compression level
      **/
     template<typename T> inline void ncd<T>::setCompressionLevel( const compresslevel& p_level )
     {
-        switch (p_level) 
-        {
-            case defaultcompression :   
-                m_gzipparam     = bio::gzip_params( bio::gzip::default_compression );
-                m_bzip2param    = bio::bzip2_params( 6 );
-                break;
-                
-            case bestspeed          :   
-                m_gzipparam     = bio::gzip_params( bio::gzip::best_speed );
-                m_bzip2param    = bio::bzip2_params( 1 );
-                break;
-                
-            case bestcompression    :   
-                m_gzipparam     = bio::gzip_params( bio::gzip::best_compression );
-                m_bzip2param    = bio::bzip2_params( 9 );
-                break;
+        m_level       = p_level;
+        m_nativelevel = false;
+    }
+    
+    
+    /** sets the native compression level of the algorithm (gzip -1 to 9, bzip2 1 to 9,
+     * xz 0 to 9, zstd ZSTD_minCLevel() to ZSTD_maxCLevel(), lz4 up to LZ4F_compressionLevel_max(),
+     * brotli 0 to 11). The level is checked here, because the compressors are created inside
+     * parallel regions and an exception can not be passed out of them
+     * @param p_level compression level
+     **/
+    template<typename T> inline void ncd<T>::setCompressionLevel( const int& p_level )
+    {
+        const bool l_nativelevel = m_nativelevel;
+        const int l_levelvalue   = m_levelvalue;
+        
+        m_nativelevel = true;
+        m_levelvalue  = p_level;
+        
+        try {
+            getCompressor();
+        } catch (...) {
+            m_nativelevel = l_nativelevel;
+            m_levelvalue  = l_levelvalue;
+            throw;
+        }
+    }
+    
+    
+    /** enables priming. The compressor is primed with the first element of each pair,
+     * so the first element is compressed only once for each row of the matrix and the
+     * size of the concatenation is determined with the first element as dictionary
+     * (gzip, xz and zstd). The values are an approximation of the NCD, because the
+     * compression of the concatenation is not run
+     * @param p_priming enable / disable priming
+     **/
+    template<typename T> inline void ncd<T>::setPriming( const bool& p_priming )
+    {
+        m_priming = p_priming;
+    }
+    
+    
+    /** returns the priming flag
+     * @return priming flag
+     **/
+    template<typename T> inline bool ncd<T>::getPriming( void ) const
+    {
+        return m_priming;
+    }
+    
+    
+    /** returns the compression algorithm
+     * @return enum value of the algorithm
+     **/
+    template<typename T> inline typename ncd<T>::compresstype ncd<T>::getCompressionType( void ) const
+    {
+        return m_compress;
+    }
+    
+    
+    /** returns the compression level
+     * @return native level of the algorithm or the enum value of the level
+     **/
+    template<typename T> inline int ncd<T>::getCompressionLevel( void ) const
+    {
+        return m_nativelevel ? m_levelvalue : static_cast<int>(m_level);
+    }
+    
+    
+    /** returns the flag, if the native level of the algorithm is used
+     * @return native level flag
+     **/
+    template<typename T> inline bool ncd<T>::isNativeCompressionLevel( void ) const
+    {
+        return m_nativelevel;
+    }
+    
+    
+    /** creates a new compressor with the algorithm and the level of the object
+     * @return compressor
+     **/
+    template<typename T> inline boost::shared_ptr<compression::compressor> ncd<T>::getCompressor( void ) const
+    {
+        switch (m_compress) {
+            case gzip   : return createCompressor<compression::gzipcompressor>();
+            case bzip2  : return createCompressor<compression::bzip2compressor>();
+            
+            #ifdef MACHINELEARNING_COMPRESSION_XZ
+            case xz     : return createCompressor<compression::xzcompressor>();
+            #endif
+            
+            #ifdef MACHINELEARNING_COMPRESSION_ZSTD
+            case zstd   : return createCompressor<compression::zstdcompressor>();
+            #endif
+            
+            #ifdef MACHINELEARNING_COMPRESSION_LZ4
+            case lz4    : return createCompressor<compression::lz4compressor>();
+            #endif
+            
+            #ifdef MACHINELEARNING_COMPRESSION_BROTLI
+            case brotli : return createCompressor<compression::brotlicompressor>();
+            #endif
+            
+            default     : break;
         }
+        
+        throw exception::runtime(_("compression algorithm is not supported"), *this);
+    }
+    
+    
+    /** creates a compressor of the backend type with the level of the object
+     * @return compressor
+     **/
+    template<typename T> template<typename C> inline boost::shared_ptr<compression::compressor> ncd<T>::createCompressor( void ) const
+    {
+        if (m_nativelevel)
+            return boost::shared_ptr<compression::compressor>( new C(m_levelvalue) );
+        
+        compression::level l_level = compression::defaultcompression;
+        switch (m_level) {
+            case defaultcompression : l_level = compression::defaultcompression;    break;
+            case bestspeed          : l_level = compression::bestspeed;             break;
+            case bestcompression    : l_level = compression::bestcompression;       break;
+        }
+        
+        return boost::shared_ptr<compression::compressor>( new C(l_level) );
     }
     
     
@@ -192,10 +408,16 @@ namespace machinelearning { namespace distances {
      **/   
     template<typename T> inline T ncd<T>::calculate( const std::string& p_str1, const std::string& p_str2, const bool& p_isfile ) const
     {
-        const std::size_t l_first  = deflate(p_isfile, p_str1);
-        const std::size_t l_second = deflate(p_isfile, p_str2);
+        std::vector<std::string> l_data;
+        l_data.push_back( p_str1 );
+        l_data.push_back( p_str2 );
+        
+        const compression::source l_source( l_data, p_isfile );
+        const boost::shared_ptr<compression::compressor> l_compressor = getCompressor();
+        const std::size_t l_first  = deflate(*l_compressor, l_source, 0);
+        const std::size_t l_second = deflate(*l_compressor, l_source, 1);
         
-        return std::min( static_cast<T>(1),     static_cast<T>(deflate(p_isfile, p_str1, p_str2) - std::min(l_first, l_second)) / std::max(l_first, l_second) );
+        return getDistance( deflate(*l_compressor, l_source, 0, l_source, 1), l_first, l_second );
     }
     
     
@@ -211,57 +433,51 @@ namespace machinelearning { namespace distances {
         if (p_strvec.size() == 0)
             throw exception::runtime(_("vector size must be greater than zero"), *this);
         
-        // init data
-        ublas::vector<std::size_t> l_cache(p_strvec.size(), 0);
-        ublas::matrix<T> l_result(p_strvec.size(), p_strvec.size(), static_cast<T>(0));
+        const compression::source l_source( p_strvec, p_isfile );
         
-        // the first and last element are calculated in a single run, because
-        // the first two thread are used the data directly
-        l_cache(0)                 = deflate(p_isfile, p_strvec[0]);
-        l_cache(p_strvec.size()-1) = deflate(p_isfile, p_strvec[p_strvec.size()-1]);
+        // on priming the matrix is determined rowwise, the main diagonal must be zero
+        if (m_priming) {
+            ublas::matrix<T> l_primed = primed(l_source, l_source, getSingletonSize(l_source));
+            for(std::size_t i=0; i < l_primed.size1(); ++i)
+                l_primed(i,i) = static_cast<T>(0);
+            
+            return l_primed;
+        }
         
-        // create wavefront index position
-        std::multimap<std::size_t, std::pair<std::size_t,std::size_t> > l_wavefront = getWavefrontIndex(p_strvec.size(), omp_get_max_threads());
+        // init data
+        const std::vector<std::size_t> l_size  = getSingletonSize(l_source);
+        const std::vector<std::size_t> l_order = getLengthOrder(l_source);
+        ublas::matrix<T> l_result(p_strvec.size(), p_strvec.size(), static_cast<T>(0));
+        std::string l_error;
         
-        #pragma omp parallel shared(l_cache, l_result)
+        // each row (in order of the length) calculates the pairs with the following rows in both
+        // directions, the dynamic schedule balances the threads (each matrix element is written once)
+        #pragma omp parallel shared(l_result, l_error)
         {
-            for(std::multimap<std::size_t, std::pair<std::size_t,std::size_t> >::iterator it=l_wavefront.lower_bound(omp_get_thread_num()); it != l_wavefront.upper_bound(omp_get_thread_num()); ++it) {
-                
-                // read cache data
-                std::size_t l_first=0, l_second=0;
-                
-                #pragma omp critical
-                {
-                    l_first  = l_cache(it->second.first);
-                    l_second = l_cache(it->second.second);
-                }
-                
-                // check for both index positions the cache and adds the data
-                if (l_first == 0) {
-                    l_first = deflate(p_isfile, p_strvec[it->second.first]);
-                    
-                    #pragma omp critical
-                    l_cache(it->second.first) = l_first;
-                }
+            const boost::shared_ptr<compression::compressor> l_compressor = getCompressor(l_error);
+            
+            #pragma omp for schedule(dynamic)
+            for(std::size_t n=0; n < l_order.size(); ++n) {
+                if (!l_compressor || isError(l_error))
+                    continue;
                 
-                if (l_second == 0) {
-                    l_second = deflate(p_isfile, p_strvec[it->second.second]);
-                    
-                    #pragma omp critical 
-                    l_cache(it->second.second) = l_second;
+                try {
+                    for(std::size_t k=n+1; k < l_order.size(); ++k) {
+                        const std::size_t i = l_order[n];
+                        const std::size_t j = l_order[k];
+                        
+                        l_result(i, j) = getDistance( deflate(*l_compressor, l_source, i, l_source, j), l_size[i], l_size[j] );
+                        l_result(j, i) = getDistance( deflate(*l_compressor, l_source, j, l_source, i), l_size[i], l_size[j] );
+                    }
+                } catch (const std::exception& e) {
+                    setError(l_error, e);
                 }
-                
-                
-                // determin min and max
-                const std::size_t l_min = std::min(l_first, l_second);
-                const std::size_t l_max = std::max(l_first, l_second);
-                
-                // calculate NCD
-                l_result(it->second.first, it->second.second) = std::min( static_cast<T>(1), static_cast<T>(deflate(p_isfile, p_strvec[it->second.first], p_strvec[it->second.second]) - l_min) / l_max );
-                l_result(it->second.second, it->second.first) = std::min( static_cast<T>(1), static_cast<T>(deflate(p_isfile, p_strvec[it->second.second], p_strvec[it->second.first]) - l_min) / l_max );
             }
         }
         
+        if (!l_error.empty())
+            throw exception::runtime(l_error);
+        
         return l_result;
     }
     
@@ -277,65 +493,63 @@ namespace machinelearning { namespace distances {
          if (p_strvec.size() == 0)
              throw exception::runtime(_("vector size must be greater than zero"), *this);
          
-         // init data
-         ublas::vector<std::size_t> l_cache(p_strvec.size(), 0);
-         ublas::symmetric_matrix<T, ublas::upper> l_result(p_strvec.size(), p_strvec.size());
+        // init data
+        ublas::symmetric_matrix<T, ublas::upper> l_result(p_strvec.size(), p_strvec.size());
+        
+        const compression::source l_source( p_strvec, p_isfile );
         
-        // the first and last element are calculated in a single run, because
-        // the first two thread are used the data directly
-        l_cache(0)                 = deflate(p_isfile, p_strvec[0]);
-        l_cache(p_strvec.size()-1) = deflate(p_isfile, p_strvec[p_strvec.size()-1]);
+        // on priming both orders of each pair are determined rowwise
+        if (m_priming) {
+            const ublas::matrix<T> l_primed = primed(l_source, l_source, getSingletonSize(l_source));
+            
+            #pragma omp parallel for shared(l_result)
+            for(std::size_t i=0; i < l_result.size1(); ++i) {
+                l_result(i,i) = static_cast<T>(0);
+                for(std::size_t j=i+1; j < l_result.size2(); ++j)
+                    l_result(i,j) = 0.5 * (l_primed(i,j) + l_primed(j,i));
+            }
+            
+            return l_result;
+        }
+        
+        const std::vector<std::size_t> l_size  = getSingletonSize(l_source);
+        const std::vector<std::size_t> l_order = getLengthOrder(l_source);
         
-        // create wavefront index position
-        std::multimap<std::size_t, std::pair<std::size_t,std::size_t> > l_wavefront = getWavefrontIndex(p_strvec.size(), omp_get_max_threads());
+        // we set the diagonal elements to zero, because constructor has no parameter for initialization value
+        for(std::size_t i=0; i < l_result.size1(); ++i)
+            l_result(i,i) = static_cast<T>(0);
         
-        #pragma omp parallel shared(l_cache, l_result)
+        // each row (in order of the length) calculates the pairs with the following rows,
+        // the dynamic schedule balances the threads (each matrix element is written once)
+        std::string l_error;
+        #pragma omp parallel shared(l_result, l_error)
         {
-            for(std::multimap<std::size_t, std::pair<std::size_t,std::size_t> >::iterator it=l_wavefront.lower_bound(omp_get_thread_num()); it != l_wavefront.upper_bound(omp_get_thread_num()); ++it) {
-                
-                // read cache data
-                std::size_t l_first=0, l_second=0;
-                
-                #pragma omp critical
-                {
-                    l_first  = l_cache(it->second.first);
-                    l_second = l_cache(it->second.second);
-                }
-                
-                // check for both index positions the cache and adds the data
-                if (l_first == 0) {
-                    l_first = deflate(p_isfile, p_strvec[it->second.first]);
-                    
-                    #pragma omp critical
-                    l_cache(it->second.first) = l_first;
-                }
+            const boost::shared_ptr<compression::compressor> l_compressor = getCompressor(l_error);
+            
+            #pragma omp for schedule(dynamic)
+            for(std::size_t n=0; n < l_order.size(); ++n) {
+                if (!l_compressor || isError(l_error))
+                    continue;
                 
-                if (l_second == 0) {
-                    l_second = deflate(p_isfile, p_strvec[it->second.second]);
-                    
-                    #pragma omp critical 
-                    l_cache(it->second.second) = l_second;
+                try {
+                    for(std::size_t k=n+1; k < l_order.size(); ++k) {
+                        const std::size_t i = l_order[n];
+                        const std::size_t j = l_order[k];
+                        
+                        l_result(std::min(i,j), std::max(i,j)) = std::min( static_cast<T>(1), 
+                                     0.5 * (getDistance( deflate(*l_compressor, l_source, i, l_source, j), l_size[i], l_size[j] ) + 
+                                            getDistance( deflate(*l_compressor, l_source, j, l_source, i), l_size[i], l_size[j] ))
+                                     );
+                    }
+                } catch (const std::exception& e) {
+                    setError(l_error, e);
                 }
-                
-                
-                // determin min and max
-                const std::size_t l_min = std::min(l_first, l_second);
-                const std::size_t l_max = std::max(l_first, l_second);
-                
-                // calculate NCD
-                l_result(it->second.first, it->second.second) = std::min( static_cast<T>(1),
-                             0.5 * (static_cast<T>(deflate(p_isfile, p_strvec[it->second.first], p_strvec[it->second.second]) - l_min) / l_max + 
-                                    static_cast<T>(deflate(p_isfile, p_strvec[it->second.second], p_strvec[it->second.first]) - l_min) / l_max)
-                             );
-
             }
         }
         
-         // we set the diagonal elements to zero, because constructor has no parameter for initialization value
-         #pragma omp for
-         for(std::size_t i=0; i < l_result.size1(); ++i)
-             l_result(i,i) = static_cast<T>(0);
-         
+        if (!l_error.empty())
+            throw exception::runtime(l_error);
+        
          return l_result;
     }
     
@@ -351,84 +565,210 @@ namespace machinelearning { namespace distances {
         if ( (p_strvec1.size() == 0) || (p_strvec2.size() == 0) )
             throw exception::runtime(_("vector size must be greater than zero"), *this);
         
-        // init data
-        ublas::vector<std::size_t> l_cache(p_strvec1.size() + p_strvec2.size(), 0);
-        ublas::matrix<T> l_result( p_strvec1.size(), p_strvec2.size() );
+        const compression::source l_source1( p_strvec1, p_isfile );
+        const compression::source l_source2( p_strvec2, p_isfile );
+        
+        // on priming the sizes of the rows are not needed
+        return calculateBlock( l_source1, l_source2, m_priming ? std::vector<std::size_t>() : getSingletonSize(l_source1), getSingletonSize(l_source2) );
+    }
     
-        // we create the map for threads (on the contrary to wavefront we cut patches for each thread, because we must calculate each element without any topographical order)
-        // The map element has in the std::pair within the first position the index of the first vector
-        std::multimap<std::size_t, std::pair<std::size_t,std::size_t> > l_map;
+    
+    /** returns the compressed size of each element, so the sizes can be stored
+     * and passed to getBlock, if the matrix is calculated in blocks
+     * @param p_strvec string vector
+     * @param p_isfile parameter for interpreting the string as a file with path
+     * @return vector with the compressed sizes
+     **/
+    template<typename T> inline std::vector<std::size_t> ncd<T>::getCompressedSize( const std::vector<std::string>& p_strvec, const bool& p_isfile ) const
+    {
+        if (p_strvec.size() == 0)
+            throw exception::runtime(_("vector size must be greater than zero"), *this);
         
-        #pragma omp parallel shared(l_map, l_cache, l_result)
-        {
-            if (p_strvec1.size() < p_strvec2.size())
-                
-                #pragma omp for
-                for(std::size_t j=0; j < p_strvec1.size(); ++j)
-                    for(std::size_t i=0; i < p_strvec2.size(); ++i)
-                        
-                        #pragma omp critical
-                        l_map.insert(  std::pair<std::size_t, std::pair<std::size_t,std::size_t> >(i % omp_get_max_threads(), std::pair<std::size_t,std::size_t>(j,i))  );
-            
-            else
-                
-                #pragma omp for
-                for(std::size_t j=0; j < p_strvec2.size(); ++j)
-                    for(std::size_t i=0; i < p_strvec1.size(); ++i)
-                        
-                        #pragma omp critical
-                        l_map.insert(  std::pair<std::size_t, std::pair<std::size_t,std::size_t> >(i % omp_get_max_threads(), std::pair<std::size_t,std::size_t>(i,j))  );
-
-            
-            #pragma omp barrier
+        return getSingletonSize( compression::source(p_strvec, p_isfile) );
+    }
+    
+    
+    /** calculates a block of the distance matrix of the string vector with precalculated
+     * compressed sizes, so only the pairs are compressed. The block is cut at the border
+     * and the strings of the block are not copied
+     * @param p_strvec string vector
+     * @param p_size compressed size of each element (see getCompressedSize)
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @param p_col start column
+     * @param p_cols number of columns
+     * @param p_isfile parameter for interpreting the string as a file with path
+     * @param p_symmetric each value is the mean of both deflating orders of the pair
+     * @return block matrix (deflating order: row element concat with column element)
+     **/
+    template<typename T> inline ublas::matrix<T> ncd<T>::getBlock( const std::vector<std::string>& p_strvec, const std::vector<std::size_t>& p_size, const std::size_t& p_row, const std::size_t& p_rows, const std::size_t& p_col, const std::size_t& p_cols, const bool& p_isfile, const bool& p_symmetric ) const
+    {
+        if (p_size.size() != p_strvec.size())
+            throw exception::runtime(_("number of compressed sizes must be equal to the vector size"), *this);
+        if ((p_row >= p_strvec.size()) || (p_col >= p_strvec.size()) || (p_rows == 0) || (p_cols == 0))
+            throw exception::runtime(_("block index is out of range"), *this);
+        
+        const std::size_t l_rowend = std::min(p_row+p_rows, p_strvec.size());
+        const std::size_t l_colend = std::min(p_col+p_cols, p_strvec.size());
+        
+        const compression::source l_source1( p_strvec, p_row, l_rowend, p_isfile );
+        const compression::source l_source2( p_strvec, p_col, l_colend, p_isfile );
+        
+        return calculateBlock( l_source1, l_source2,
+                               std::vector<std::size_t>(p_size.begin()+p_row, p_size.begin()+l_rowend),
+                               std::vector<std::size_t>(p_size.begin()+p_col, p_size.begin()+l_colend),
+                               p_symmetric
+                             );
+    }
+    
+    
+    /** calculates all distances between each element of both sources with
+     * precalculated compressed sizes
+     * @param p_source1 input data (rows)
+     * @param p_source2 input data (columns)
+     * @param p_size1 compressed sizes of the rows (not used on priming without the symmetric flag)
+     * @param p_size2 compressed sizes of the columns
+     * @param p_symmetric each value is the mean of both deflating orders of the pair
+     * @return dissimilarity matrix with source1 x source2 elements
+     **/
+    template<typename T> inline ublas::matrix<T> ncd<T>::calculateBlock( const compression::source& p_source1, const compression::source& p_source2, const std::vector<std::size_t>& p_size1, const std::vector<std::size_t>& p_size2, const bool& p_symmetric ) const
+    {
+        if (m_priming) {
+            if (!p_symmetric)
+                return primed(p_source1, p_source2, p_size2);
             
-            for(std::multimap<std::size_t, std::pair<std::size_t,std::size_t> >::iterator it=l_map.lower_bound(omp_get_thread_num()); it != l_map.upper_bound(omp_get_thread_num()); ++it) {
+            return 0.5 * (primed(p_source1, p_source2, p_size2) + ublas::trans(primed(p_source2, p_source1, p_size1)));
+        }
+        
+        // init data
+        const std::vector<std::size_t> l_order = getLengthOrder(p_source1);
+        ublas::matrix<T> l_result( p_source1.size(), p_source2.size() );
+        std::string l_error;
         
-                // read cache data
-                std::size_t l_first=0, l_second=0;
+        // each row (in order of the length) is calculated by one thread, the dynamic
+        // schedule balances the threads (each matrix element is written once)
+        #pragma omp parallel shared(l_result, l_error)
+        {
+            const boost::shared_ptr<compression::compressor> l_compressor = getCompressor(l_error);
+            
+            #pragma omp for schedule(dynamic)
+            for(std::size_t n=0; n < l_order.size(); ++n) {
+                if (!l_compressor || isError(l_error))
+                    continue;
                 
-                #pragma omp critical
-                {
-                    l_first  = l_cache(it->second.first);
-                    l_second = l_cache(p_strvec1.size()+it->second.second);
+                const std::size_t i = l_order[n];
+                try {
+                    for(std::size_t j=0; j < p_source2.size(); ++j)
+                        if (p_symmetric)
+                            l_result(i, j) = std::min( static_cast<T>(1),
+                                         0.5 * (getDistance( deflate(*l_compressor, p_source1, i, p_source2, j), p_size1[i], p_size2[j] ) +
+                                                getDistance( deflate(*l_compressor, p_source2, j, p_source1, i), p_size1[i], p_size2[j] ))
+                                         );
+                        else
+                            l_result(i, j) = getDistance( deflate(*l_compressor, p_source1, i, p_source2, j), p_size1[i], p_size2[j] );
+                } catch (const std::exception& e) {
+                    setError(l_error, e);
                 }
+            }
+        }
+        
+        if (!l_error.empty())
+            throw exception::runtime(l_error);
+        
+        return l_result;
+    }
+    
+    
+    /** calculates a sparse k-nearest-neighbour graph. The sketch proposes candidate
+     * pairs and the NCD is calculated only for the candidates, so the graph can be
+     * created for large datasets
+     * @note a row can have less than k elements, if the sketch finds less candidates,
+     * zero distances are stored as explicit elements
+     * @param p_strvec string vector
+     * @param p_neighbours number of neighbours (k)
+     * @param p_sketch sketch object for the candidates
+     * @param p_isfile parameter for interpreting the string as a file with path
+     * @return sparse matrix with the distances of the nearest neighbours of each row
+     **/
+    template<typename T> inline ublas::compressed_matrix<T> ncd<T>::nearest( const std::vector<std::string>& p_strvec, const std::size_t& p_neighbours, const minhash& p_sketch, const bool& p_isfile ) const
+    {
+        if (p_strvec.size() == 0)
+            throw exception::runtime(_("vector size must be greater than zero"), *this);
+        if (p_neighbours == 0)
+            throw exception::runtime(_("number of neighbours must be greater than zero"), *this);
+        
+        // init data
+        const compression::source l_source( p_strvec, p_isfile );
+        const std::vector< std::vector<std::size_t> > l_candidates = p_sketch.getCandidates(l_source);
+        const std::vector<std::size_t> l_size = getSingletonSize(l_source);
+        std::vector< std::vector< std::pair<std::size_t, T> > > l_nearest( p_strvec.size() );
+        std::string l_error;
+        
+        // each row calculates the distances to the candidates and holds the nearest ones
+        // (on priming the compressor is primed once with the row element)
+        #pragma omp parallel shared(l_nearest, l_error)
+        {
+            const boost::shared_ptr<compression::compressor> l_compressor = getCompressor(l_error);
+            
+            #pragma omp for schedule(dynamic)
+            for(std::size_t i=0; i < p_strvec.size(); ++i) {
+                if (!l_compressor || isError(l_error))
+                    continue;
                 
-                // check for both index positions the cache and adds the data
-                if (l_first == 0) {
-                    l_first = deflate(p_isfile, p_strvec1[it->second.first]);
+                try {
+                    const std::size_t l_first = m_priming ? l_compressor->prime( l_source.getData(i), l_source.getSize(i) ) : l_size[i];
                     
-                    #pragma omp critical
-                    l_cache(it->second.first) = l_first;
-                }
-                
-                if (l_second == 0) {
-                    l_second = deflate(p_isfile, p_strvec2[it->second.second]);
+                    std::vector< std::pair<T, std::size_t> > l_distance( l_candidates[i].size() );
+                    for(std::size_t n=0; n < l_candidates[i].size(); ++n) {
+                        const std::size_t j = l_candidates[i][n];
+                        
+                        const std::size_t l_concat = m_priming ? l_compressor->deflatePrimed( l_source.getData(j), l_source.getSize(j) ) : deflate(*l_compressor, l_source, i, l_source, j);
+                        
+                        l_distance[n] = std::make_pair( getDistance(l_concat, l_first, l_size[j]), j );
+                    }
+                    
+                    // the nearest elements are stored in column order, so the sparse matrix can be filled sequentially
+                    const std::size_t l_count = std::min(p_neighbours, l_distance.size());
+                    std::partial_sort( l_distance.begin(), l_distance.begin()+l_count, l_distance.end() );
                     
-                    #pragma omp critical 
-                    l_cache(p_strvec1.size()+it->second.second) = l_second;
+                    l_nearest[i].resize( l_count );
+                    for(std::size_t n=0; n < l_count; ++n)
+                        l_nearest[i][n] = std::make_pair( l_distance[n].second, l_distance[n].first );
+                    std::sort( l_nearest[i].begin(), l_nearest[i].end() );
+                } catch (const std::exception& e) {
+                    setError(l_error, e);
                 }
-                
-                
-                // determin min and max
-                const std::size_t l_min = std::min(l_first, l_second);
-                const std::size_t l_max = std::max(l_first, l_second);
-        
-                // calculate NCD
-                l_result(it->second.first, it->second.second) = std::min( static_cast<T>(1), static_cast<T>(deflate(p_isfile, p_strvec1[it->second.first], p_strvec2[it->second.second]) - l_min) / l_max );
             }
         }
-                
+        
+        if (!l_error.empty())
+            throw exception::runtime(l_error);
+        
+        std::size_t l_elements = 0;
+        for(std::size_t i=0; i < l_nearest.size(); ++i)
+            l_elements += l_nearest[i].size();
+        
+        ublas::compressed_matrix<T> l_result( p_strvec.size(), p_strvec.size(), l_elements );
+        for(std::size_t i=0; i < l_nearest.size(); ++i)
+            for(std::size_t n=0; n < l_nearest[i].size(); ++n)
+                l_result.push_back( i, l_nearest[i][n].first, l_nearest[i][n].second );
+        
         return l_result;
     }
     
     
     #ifdef MACHINELEARNING_MPI
     
-    /** creates a distance matrix with shared data
+    /** creates a distance matrix with shared data. The data is exchanged in a
+     * ring as flat byte buffer together with the compressed sizes, so the data
+     * is compressed once and files are read only on the local process. The
+     * block of the next process is received while the current block is calculated
+     * @note the work of each process depends on the number of bytes of the local
+     * data, so the data should be distributed with the distribute method
      * @param p_mpi MPI object
      * @param p_strvec local dataset
      * @param p_isfile parameter for interpreting the string as a file with path
-     * @return part of distance matrix (all data size x local data size)
+     * @return distance matrix (rows = all data, columns = local data)
      **/
     template<typename T> inline ublas::matrix<T> ncd<T>::unsquare ( const mpi::communicator& p_mpi, const std::vector<std::string>& p_strvec, const bool& p_isfile ) const
     {
@@ -438,45 +778,98 @@ namespace machinelearning { namespace distances {
         // synchronize the isFile parameter
         const bool l_isfile = mpi::all_reduce(p_mpi, p_isfile, std::multiplies<bool>());
         
-        // we detect the matrix row size (sum over each CPU data - we don't use the all_reduce,
-        // because the different datasizes of each CPU data is needed later)
+        // create the local block, the header contains the number of bytes of each element and the compressed sizes
+        const compression::source l_local( p_strvec, l_isfile );
+        const std::vector<std::size_t> l_localsize = getSingletonSize(l_local);
+        
+        std::vector<std::size_t> l_header( l_localsize.size() );
+        for(std::size_t i=0; i < l_local.size(); ++i)
+            l_header[i] = l_local.getSize(i);
+        l_header.insert( l_header.end(), l_localsize.begin(), l_localsize.end() );
+        
+        std::vector<char> l_bytes( std::max(static_cast<std::size_t>(1), std::accumulate(l_header.begin(), l_header.begin()+l_local.size(), static_cast<std::size_t>(0))) );
+        for(std::size_t i=0, l_offset=0; i < l_local.size(); l_offset += l_local.getSize(i), ++i)
+            if (l_local.getSize(i))
+                std::copy( l_local.getData(i), l_local.getData(i)+l_local.getSize(i), l_bytes.begin()+l_offset );
+        
+        // we detect the matrix row size (sum over each CPU data) and the number of bytes of each CPU data
         std::vector<std::size_t> l_datasize;
+        std::vector<std::size_t> l_bytesize;
         mpi::all_gather(p_mpi, p_strvec.size(), l_datasize );
-        const std::size_t l_rowsize = std::accumulate( l_datasize.begin(), l_datasize.end(), 0 );
+        mpi::all_gather(p_mpi, std::accumulate(l_header.begin(), l_header.begin()+l_local.size(), static_cast<std::size_t>(0)), l_bytesize );
+        
+        if (*std::max_element(l_bytesize.begin(), l_bytesize.end()) > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+            throw exception::runtime(_("data block exceeds the MPI message size"), *this);
+        
+        const std::size_t l_rowsize = std::accumulate( l_datasize.begin(), l_datasize.end(), static_cast<std::size_t>(0) );
+        const std::size_t l_rank    = static_cast<std::size_t>(p_mpi.rank());
+        const std::size_t l_cpu     = static_cast<std::size_t>(p_mpi.size());
         
         // create the target matrix (rows = all data size, column local data size)
         ublas::matrix<T> l_result( l_rowsize, p_strvec.size() );
         
         
-        // create the local distances
-        const std::size_t l_localrow = std::accumulate( l_datasize.begin(), l_datasize.begin() + static_cast<std::size_t>(p_mpi.rank()), 0 );
+        // double buffers for the pipeline, step i receives the block of the i-th predecessor
+        std::vector<char> l_recvbytes[2];
+        std::vector<std::size_t> l_recvheader[2];
+        mpi::request l_req[2][4];
+        
+        for(std::size_t i=1; i < std::min(static_cast<std::size_t>(2), l_cpu); ++i) {
+            const std::size_t l_successor   = (l_rank+i) % l_cpu;
+            const std::size_t l_predecessor = (l_rank+l_cpu-i) % l_cpu;
+            
+            l_recvheader[i%2].resize( 2*l_datasize[l_predecessor] );
+            l_recvbytes[i%2].resize( std::max(static_cast<std::size_t>(1), l_bytesize[l_predecessor]) );
+            
+            l_req[i%2][0] = p_mpi.isend(l_successor, 2*i, &l_header[0], static_cast<int>(l_header.size()));
+            l_req[i%2][1] = p_mpi.isend(l_successor, 2*i+1, &l_bytes[0], static_cast<int>(l_bytesize[l_rank]));
+            l_req[i%2][2] = p_mpi.irecv(l_predecessor, 2*i, &l_recvheader[i%2][0], static_cast<int>(l_recvheader[i%2].size()));
+            l_req[i%2][3] = p_mpi.irecv(l_predecessor, 2*i+1, &l_recvbytes[i%2][0], static_cast<int>(l_bytesize[l_predecessor]));
+        }
+        
+        // create the local distances while the first block is transferred
+        const std::size_t l_localrow = std::accumulate( l_datasize.begin(), l_datasize.begin() + l_rank, static_cast<std::size_t>(0) );
         ublas::matrix_range< ublas::matrix<T> > l_rangelocal(l_result, 
                                                                   ublas::range( l_localrow, l_localrow + p_strvec.size() ), 
                                                                   ublas::range( 0, l_result.size2() )
                                                                   );
-        l_rangelocal.assign( unsquare(p_strvec, p_strvec, l_isfile) );
+        l_rangelocal.assign( calculateBlock(l_local, l_local, l_localsize, l_localsize) );
         
         // create distance to the local articles and the articless of the neighborhood CPU
-        for(std::size_t i=1; i < static_cast<std::size_t>(p_mpi.size()); ++i)
+        for(std::size_t i=1; i < l_cpu; ++i)
         {
-            // get start index on the matrix
-            const std::size_t l_successor   = (static_cast<std::size_t>(p_mpi.rank())+i) % static_cast<std::size_t>(p_mpi.size());
-            const std::size_t l_predecessor = (static_cast<std::size_t>(p_mpi.rank())+p_mpi.size()-i) % static_cast<std::size_t>(p_mpi.size());
+            const std::size_t l_buffer      = i % 2;
+            const std::size_t l_predecessor = (l_rank+l_cpu-i) % l_cpu;
+            mpi::wait_all(l_req[l_buffer], l_req[l_buffer]+4);
+            
+            // start the transfer of the next block
+            if (i+1 < l_cpu) {
+                const std::size_t l_next            = (i+1) % 2;
+                const std::size_t l_nextsuccessor   = (l_rank+i+1) % l_cpu;
+                const std::size_t l_nextpredecessor = (l_rank+l_cpu-i-1) % l_cpu;
+                
+                l_recvheader[l_next].resize( 2*l_datasize[l_nextpredecessor] );
+                l_recvbytes[l_next].resize( std::max(static_cast<std::size_t>(1), l_bytesize[l_nextpredecessor]) );
+                
+                l_req[l_next][0] = p_mpi.isend(l_nextsuccessor, 2*(i+1), &l_header[0], static_cast<int>(l_header.size()));
+                l_req[l_next][1] = p_mpi.isend(l_nextsuccessor, 2*(i+1)+1, &l_bytes[0], static_cast<int>(l_bytesize[l_rank]));
+                l_req[l_next][2] = p_mpi.irecv(l_nextpredecessor, 2*(i+1), &l_recvheader[l_next][0], static_cast<int>(l_recvheader[l_next].size()));
+                l_req[l_next][3] = p_mpi.irecv(l_nextpredecessor, 2*(i+1)+1, &l_recvbytes[l_next][0], static_cast<int>(l_bytesize[l_nextpredecessor]));
+            }
             
-            // send and receive with non-blocking operation and wait for both request
-            mpi::request l_req[2];
-            std::vector<std::string> l_neighbourdata;
-            l_req[0] = p_mpi.isend(l_successor, 0, p_strvec);
-            l_req[1] = p_mpi.irecv(l_predecessor, 0, l_neighbourdata);
-            mpi::wait_all(l_req, l_req+2);
+            // create the source of the received block and calculate the distances
+            const std::size_t l_count = l_datasize[l_predecessor];
+            const std::vector<std::size_t> l_length( l_recvheader[l_buffer].begin(), l_recvheader[l_buffer].begin()+l_count );
+            const std::vector<std::size_t> l_size( l_recvheader[l_buffer].begin()+l_count, l_recvheader[l_buffer].end() );
+            const compression::source l_neighbour( &l_recvbytes[l_buffer][0], l_length );
             
             // get position within the matrix and create distance values
-            const std::size_t l_startrow = std::accumulate( l_datasize.begin(), l_datasize.begin() + l_predecessor, 0 );
+            const std::size_t l_startrow = std::accumulate( l_datasize.begin(), l_datasize.begin() + l_predecessor, static_cast<std::size_t>(0) );
             ublas::matrix_range< ublas::matrix<T> > l_range( l_result, 
-                                                             ublas::range( l_startrow, l_startrow+l_neighbourdata.size() ), 
+                                                             ublas::range( l_startrow, l_startrow+l_count ), 
                                                              ublas::range( 0, l_result.size2() )
                                                            );
-            l_range.assign( unsquare(l_neighbourdata, p_strvec, l_isfile) );
+            l_range.assign( calculateBlock(l_neighbour, l_local, l_size, l_localsize) );
         }
         
         // set the main diagonal zero values
@@ -486,67 +879,177 @@ namespace machinelearning { namespace distances {
         
         return l_result;
     }
+    
+    
+    /** redistributes the data over the processes, so each process holds nearly
+     * the same number of bytes. The global order of the elements is kept, so
+     * each process gets a contiguous part of the whole data
+     * @param p_mpi MPI object
+     * @param p_strvec local dataset
+     * @param p_isfile parameter for interpreting the string as a file with path (the files must be readable on each process)
+     * @return new local dataset
+     **/
+    template<typename T> inline std::vector<std::string> ncd<T>::distribute ( const mpi::communicator& p_mpi, const std::vector<std::string>& p_strvec, const bool& p_isfile ) const
+    {
+        const bool l_isfile = mpi::all_reduce(p_mpi, p_isfile, std::multiplies<bool>());
+        const compression::source l_local( p_strvec, l_isfile );
+        
+        // collect the number of bytes of all elements
+        std::vector<std::size_t> l_length( l_local.size() );
+        for(std::size_t i=0; i < l_local.size(); ++i)
+            l_length[i] = l_local.getSize(i);
+        
+        std::vector< std::vector<std::size_t> > l_alllength;
+        mpi::all_gather(p_mpi, l_length, l_alllength );
+        
+        std::size_t l_total = 0;
+        for(std::size_t i=0; i < l_alllength.size(); ++i)
+            l_total = std::accumulate( l_alllength[i].begin(), l_alllength[i].end(), l_total );
+        
+        // the target process of an element is determined by the center of the element within the byte sequence
+        const std::size_t l_rank = static_cast<std::size_t>(p_mpi.rank());
+        const std::size_t l_cpu  = static_cast<std::size_t>(p_mpi.size());
+        std::size_t l_offset     = 0;
+        for(std::size_t i=0; i < l_rank; ++i)
+            l_offset = std::accumulate( l_alllength[i].begin(), l_alllength[i].end(), l_offset );
+        
+        std::vector< std::vector<std::string> > l_send( l_cpu );
+        for(std::size_t i=0; i < p_strvec.size(); l_offset += l_length[i], ++i) {
+            const double l_center = l_total ? (static_cast<double>(l_offset) + 0.5*l_length[i]) / l_total : 0;
+            l_send[ std::min(l_cpu-1, static_cast<std::size_t>(l_center * l_cpu)) ].push_back( p_strvec[i] );
+        }
+        
+        std::vector< std::vector<std::string> > l_receive;
+        mpi::all_to_all(p_mpi, l_send, l_receive );
+        
+        std::vector<std::string> l_data;
+        for(std::size_t i=0; i < l_receive.size(); ++i)
+            l_data.insert( l_data.end(), l_receive[i].begin(), l_receive[i].end() );
+        
+        return l_data;
+    }
     #endif
     
     
-    /** deflate a string or file with the algorithm
-     * @param p_isfile bool for interpret input string like filenames
-     * @param p_str1 first string to compress
-     * @param p_str2 optional second string to compress
+    /** deflate an element with a compressor context, the data is passed
+     * directly to the compressor
+     * @param p_compressor compressor context
+     * @param p_source input data
+     * @param p_index index of the element
      * @return number of bytes 
      **/    
-    template<typename T> inline std::size_t ncd<T>::deflate( const bool& p_isfile, const std::string& p_str1, const std::string& p_str2 ) const
+    template<typename T> inline std::size_t ncd<T>::deflate( compression::compressor& p_compressor, const compression::source& p_source, const std::size_t& p_index ) const
     {
-        if (p_str1.empty())
-            throw exception::runtime(_("string size must be greater than zero"), *this);
-
-        // for each compress algorithm we removed the header & footer size of the resulting count
-        // @see http://en.wikipedia.org/wiki/Bzip2#File_format
-        // @see http://en.wikipedia.org/wiki/Gzip#File_format
-        std::size_t l_removesize = 0;
+        if (p_source.getSize(p_index) == 0)
+            return 0;
         
-        // create output null stream, compressor and counter structure
-        bio::counter l_counter;
-        bio::basic_null_sink<char> l_null;
-        bio::filtering_streambuf< bio::output > l_deflate;
+        return p_compressor.deflate( p_source.getData(p_index), p_source.getSize(p_index) );
+    }
+    
+    
+    /** deflate the concatenation of two elements with a compressor context,
+     * the data is passed directly to the compressor
+     * @param p_compressor compressor context
+     * @param p_source1 input data of the first element
+     * @param p_index1 index of the first element
+     * @param p_source2 input data of the second element
+     * @param p_index2 index of the second element
+     * @return number of bytes 
+     **/    
+    template<typename T> inline std::size_t ncd<T>::deflate( compression::compressor& p_compressor, const compression::source& p_source1, const std::size_t& p_index1, const compression::source& p_source2, const std::size_t& p_index2 ) const
+    {
+        if (p_source1.getSize(p_index1) + p_source2.getSize(p_index2) == 0)
+            return 0;
         
-        switch (m_compress) {
-            case gzip   : l_deflate.push( bio::gzip_compressor( m_gzipparam ) );      l_removesize = 18; break;
-            case bzip2  : l_deflate.push( bio::bzip2_compressor( m_bzip2param ) );    l_removesize = 8; break;
-        }
-        l_deflate.push( boost::ref(l_counter) );        
-        l_deflate.push( l_null );
-        
-        // create stream for data and copy streamdata to output
-        if (p_isfile) {
-            // for filestreams copy data manually to deflate stream, cause boost::iostreams::copy close
-            // source and destination stream after copy is finished, so we copy only data from first
-            // stream into deflate and than from second stream
-            
-            std::ifstream l_file1(p_str1.c_str(), std::ifstream::binary);
-            if (!l_file1.is_open())
-                throw exception::runtime(_("file can not be opened"), *this);
-            std::copy( std::istream_iterator<char>(l_file1), std::istream_iterator<char>(), std::ostreambuf_iterator<char>(&l_deflate) );
+        return p_compressor.deflate( p_source1.getData(p_index1), p_source1.getSize(p_index1), p_source2.getData(p_index2), p_source2.getSize(p_index2) );
+    }
+    
+    
+    /** calculates all distances between each element of both vectors with a primed
+     * compressor. Each row is primed with the element of the first vector, so the element
+     * is compressed only once and each element of the second vector is compressed with
+     * the primed state
+     * @param p_source1 input data (rows)
+     * @param p_source2 input data (columns)
+     * @param p_size2 compressed sizes of the columns
+     * @return dissimilarity matrix with source1 x source2 elements
+     **/
+    template<typename T> inline ublas::matrix<T> ncd<T>::primed( const compression::source& p_source1, const compression::source& p_source2, const std::vector<std::size_t>& p_size2 ) const
+    {
+        ublas::matrix<T> l_result( p_source1.size(), p_source2.size() );
+        const std::vector<std::size_t> l_order = getLengthOrder(p_source1);
+        std::string l_error;
+        
+        #pragma omp parallel shared(l_result, l_error)
+        {
+            const boost::shared_ptr<compression::compressor> l_compressor = getCompressor(l_error);
             
-            if (!p_str2.empty()) {
-                std::ifstream l_file2(p_str2.c_str(), std::ifstream::binary);
-                if (!l_file2.is_open())
-                    throw exception::runtime(_("file can not be opened"), *this);
-                std::copy( std::istream_iterator<char>(l_file2), std::istream_iterator<char>(), std::ostreambuf_iterator<char>(&l_deflate) );
+            // each row (in order of the length) is primed and all column elements are compressed with the primed state
+            #pragma omp for schedule(dynamic)
+            for(std::size_t n=0; n < l_order.size(); ++n) {
+                if (!l_compressor || isError(l_error))
+                    continue;
+                
+                const std::size_t i = l_order[n];
+                try {
+                    const std::size_t l_first = l_compressor->prime( p_source1.getData(i), p_source1.getSize(i) );
+                    
+                    for(std::size_t j=0; j < p_source2.size(); ++j)
+                        l_result(i, j) = getDistance( l_compressor->deflatePrimed(p_source2.getData(j), p_source2.getSize(j)), l_first, p_size2[j] );
+                } catch (const std::exception& e) {
+                    setError(l_error, e);
+                }
             }
-            
-        } else {
-          
-            // we read binary data and don't skip any whitespaces
-            std::stringstream l_sstream( std::stringstream::in | std::stringstream::out | std::stringstream::binary );
-            l_sstream << std::noskipws << p_str1 << p_str2;
-            std::copy( std::istream_iterator<char>(l_sstream), std::istream_iterator<char>(), std::ostreambuf_iterator<char>(&l_deflate) );
         }
-
-        // close deflate stream, cause only than counter returns correct value
-        bio::close(l_deflate);
         
-        return (static_cast<std::size_t>(l_counter.characters()) >= l_removesize) ? l_counter.characters()-l_removesize*sizeof(char) : l_counter.characters();
+        if (!l_error.empty())
+            throw exception::runtime(l_error);
+        
+        return l_result;
+    }
+    
+    
+    /** creates a compressor inside a parallel region. An exception can not be passed out
+     * of the region, so the message of the first error is stored, the following rows are
+     * skipped and the caller throws the error after the region
+     * @param p_error message of the first error (shared between the threads)
+     * @return compressor or an empty pointer on error
+     **/
+    template<typename T> inline boost::shared_ptr<compression::compressor> ncd<T>::getCompressor( std::string& p_error ) const
+    {
+        try {
+            return getCompressor();
+        } catch (const std::exception& e) {
+            setError(p_error, e);
+        }
+        
+        return boost::shared_ptr<compression::compressor>();
+    }
+    
+    
+    /** checks inside a parallel region, if a thread has stored an error
+     * @param p_error message of the first error (shared between the threads)
+     * @return bool if an error is stored
+     **/
+    template<typename T> inline bool ncd<T>::isError( const std::string& p_error ) const
+    {
+        bool l_error = false;
+        #pragma omp critical (ncd_error)
+        l_error = !p_error.empty();
+        
+        return l_error;
+    }
+    
+    
+    /** stores the message of an exception inside a parallel region, if no error is stored
+     * @param p_error message of the first error (shared between the threads)
+     * @param p_exception exception
+     **/
+    template<typename T> inline void ncd<T>::setError( std::string& p_error, const std::exception& p_exception ) const
+    {
+        #pragma omp critical (ncd_error)
+        if (p_error.empty())
+            p_error = p_exception.what();
     }
     
     
@@ -0,0 +1,160 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_NORM_CHEBYSHEV_HPP
+#define __MACHINELEARNING_DISTANCES_NORM_CHEBYSHEV_HPP
+
+#include <cmath>
+#include <algorithm>
+#include <boost/numeric/ublas/vector.hpp>
+
+#include "../vectordistance.hpp"
+#include "../../tools/tools.h"
+
+
+namespace machinelearning { namespace distances { namespace norm {
+    
+    
+    #ifndef SWIG
+    namespace ublas  = boost::numeric::ublas;
+    #endif
+    
+    
+    /** class for calculating the chebyshev (L-infinity) distance beween datapoints [ max |a-b| ]
+     **/
+    template<typename T> class chebyshev : public vectordistance<T>
+    {
+        
+        public:
+        
+            bool isMetric( void ) const;
+            T getInvert( const T& ) const;
+            #ifndef SWIG
+            void abs( ublas::vector<T>& ) const;
+            #endif
+        
+        
+        #ifndef SWIG
+        protected :
+        
+            T kernel( const T*, const T*, const std::size_t& ) const;
+            T weightedKernel( const T*, const T*, const T*, const std::size_t& ) const;
+            T lengthKernel( const T*, const std::size_t& ) const;
+        #endif
+        
+    };
+    
+    
+    
+    /** the chebyshev distance is a metric
+     * @return true
+     **/
+    template<typename T> inline bool chebyshev<T>::isMetric( void ) const
+    {
+        return true;
+    }
+    
+    
+    
+    /** returns a invertet value
+     * @param p_val value
+     * @return inverted value
+     **/
+    template<typename T> inline T chebyshev<T>::getInvert( const T& p_val ) const
+    {
+        return static_cast<T>(1) / p_val;
+    }
+    
+    
+    
+    /** calculate absolut values for every element of the vector like |vec|
+     * @param p_vec vector
+     **/
+    template<typename T> inline void chebyshev<T>::abs( ublas::vector<T>& p_vec ) const
+    {
+        for(std::size_t i=0; i < p_vec.size(); ++i)
+            p_vec(i) = std::fabs(p_vec(i));
+    }
+    
+    
+    
+    /** distance kernel [ max |a-b| ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_size number of elements
+     * @return distance
+     **/
+    template<typename T> inline T chebyshev<T>::kernel( const T* p_first, const T* p_second, const std::size_t& p_size ) const
+    {
+        T l_max = 0;
+        
+        #pragma omp simd reduction(max:l_max)
+        for(std::size_t i=0; i < p_size; ++i)
+            l_max = std::max( l_max, std::fabs(p_first[i] - p_second[i]) );
+        
+        return l_max;
+    }
+    
+    
+    
+    /** weighted distance kernel [ max |w .* (a-b)| ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_weight weight array
+     * @param p_size number of elements
+     * @return distance
+     **/
+    template<typename T> inline T chebyshev<T>::weightedKernel( const T* p_first, const T* p_second, const T* p_weight, const std::size_t& p_size ) const
+    {
+        T l_max = 0;
+        
+        #pragma omp simd reduction(max:l_max)
+        for(std::size_t i=0; i < p_size; ++i)
+            l_max = std::max( l_max, std::fabs(p_weight[i] * (p_first[i] - p_second[i])) );
+        
+        return l_max;
+    }
+    
+    
+    
+    /** length kernel [ max |a| ]
+     * @param p_data array
+     * @param p_size number of elements
+     * @return length
+     **/
+    template<typename T> inline T chebyshev<T>::lengthKernel( const T* p_data, const std::size_t& p_size ) const
+    {
+        T l_max = 0;
+        
+        #pragma omp simd reduction(max:l_max)
+        for(std::size_t i=0; i < p_size; ++i)
+            l_max = std::max( l_max, std::fabs(p_data[i]) );
+        
+        return l_max;
+    }
+    
+    
+} } }
+#endif
@@ -26,13 +26,17 @@
 #ifndef __MACHINELEARNING_DISTANCES_NORM_EUCLID_HPP
 #define __MACHINELEARNING_DISTANCES_NORM_EUCLID_HPP
 
+#include <cmath>
+#include <algorithm>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
 #include <boost/numeric/bindings/blas.hpp>
+#include <boost/numeric/bindings/trans.hpp>
 #include <boost/numeric/bindings/ublas/vector.hpp>
 #include <boost/numeric/bindings/ublas/matrix.hpp>
 
-#include "../distance.hpp"
+#include "../vectordistance.hpp"
 #include "../../errorhandling/exception.hpp"
 #include "../../tools/tools.h"
 
@@ -43,372 +47,280 @@ namespace machinelearning { namespace distances { namespace norm {
     #ifndef SWIG
     namespace ublas  = boost::numeric::ublas;
     namespace blas   = boost::numeric::bindings::blas;
+    namespace bind   = boost::numeric::bindings;
     #endif
     
     
-    /** class for calculating euclid distance beween datapoints
+    /** class for calculating euclid distance beween datapoints. The vector calculations use the
+     * kernels of the vector distance, so they run directly on the row data without temporary vectors,
+     * and the nearest prototypes are determined on the squared distances without the square root
      * @todo portage this class to the Intel Math Kernel Library http://software.intel.com/en-us/articles/intel-mkl/
      **/
-    template<typename T> class euclid : public distance<T>
+    template<typename T> class euclid : public vectordistance<T>
     {
         
         public:
         
-            #ifndef SWIG
-            void normalize( ublas::vector<T>& ) const;
-            void normalize( ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;        
-            #endif
-            ublas::vector<T> getNormalize( const ublas::vector<T>& ) const;
-            ublas::matrix<T> getNormalize( const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
-        
-            T getLength( const ublas::vector<T>& ) const;
-            ublas::vector<T> getLength( const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
+            bool isMetric( void ) const;
             T getInvert( const T& ) const;
-            ublas::vector<T> getAbs( const ublas::vector<T>& ) const;
             #ifndef SWIG
             void abs( ublas::vector<T>& ) const;
             #endif
         
-            T getDistance( const ublas::vector<T>&, const ublas::vector<T>& ) const;        
-            ublas::vector<T> getDistance( const ublas::matrix<T>&, const ublas::vector<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
-            ublas::vector<T> getDistance( const ublas::matrix<T>&, const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
+            ublas::matrix<T> getPairwiseDistance( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+            ublas::indirect_array<> getNearest( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
         
-            #ifndef SWIG
-            T getWeightedDistance( const ublas::vector<T>&, const ublas::vector<T>&, const ublas::vector<T>& ) const;        
-            ublas::vector<T> getWeightedDistance( const ublas::matrix<T>&, const ublas::vector<T>&, const ublas::vector<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;        
-            ublas::vector<T> getWeightedDistance( const ublas::matrix<T>&, const ublas::matrix<T>&, const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
-            ublas::vector<T> getWeightedDistance( const ublas::matrix<T>&, const ublas::vector<T>&, const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
-            #endif
+        
+        #ifndef SWIG
+        protected :
+        
+            T kernel( const T*, const T*, const std::size_t& ) const;
+            T weightedKernel( const T*, const T*, const T*, const std::size_t& ) const;
+            T lengthKernel( const T*, const std::size_t& ) const;
+            T orderKernel( const T*, const T*, const std::size_t& ) const;
+            T weightedOrderKernel( const T*, const T*, const T*, const std::size_t& ) const;
+        
+        
+        private :
+        
+            static T squaredKernel( const T*, const T*, const std::size_t& );
+            static T weightedSquaredKernel( const T*, const T*, const T*, const std::size_t& );
+        #endif
 
     };
     
     
     
-    /** normalize a vector with euclidian norm
-     * @param p_vec vector which should be normalized
+    /** the euclidian distance is a metric
+     * @return true
      **/
-    template<typename T> inline void euclid<T>::normalize( ublas::vector<T>& p_vec ) const 
+    template<typename T> inline bool euclid<T>::isMetric( void ) const
     {
-        p_vec /= blas::nrm2( p_vec );
-    }    
-    
-    
-   
-    /** normalize a matrix on their rows or columns vectors
-     * @param p_matrix matrix for normalization
-     * @param p_row option for row or column iteration (default row)
-     **/
-    template<typename T> inline void euclid<T>::normalize( ublas::matrix<T>& p_matrix, const tools::matrix::rowtype& p_row ) const
-    { 
-        switch (p_row) {                
-            case tools::matrix::row :
-                
-                    for(std::size_t i=0; i < p_matrix.size1(); ++i)
-                        ublas::row(p_matrix, i) /= blas::nrm2( static_cast< ublas::vector<T> >(ublas::row(p_matrix, i)) );
-                    break;
-                
-                
-            case tools::matrix::column :  
-                
-                    for(std::size_t i=0; i < p_matrix.size2(); ++i)
-                        ublas::column(p_matrix, i) /= blas::nrm2( static_cast< ublas::vector<T> >(ublas::column(p_matrix, i)) );
-                    break;
-        }
-        
+        return true;
     }
     
     
     
-    /** return the normalized vector with euclidian norm
-     * @param p_vec vector which should be normalized
-     * @return vector
-     **/
-    template<typename T> inline ublas::vector<T> euclid<T>::getNormalize( const ublas::vector<T>& p_vec ) const 
-    {
-        ublas::vector<T> l_vec = p_vec;
-        normalize(l_vec);
-        return l_vec;
-    }
-    
-    
-    
-    /** normalize a matrix on their rows or columns vectors
-     * @param p_matrix matrix for noamlization
-     * @param p_row option for row or column iteration (default row)
-     * @return normalized matrix
+    /** returns a invertet value
+     * @param p_val value
+     * @return inverted value
      **/
-    template<typename T> inline ublas::matrix<T> euclid<T>::getNormalize( const ublas::matrix<T>& p_matrix, const tools::matrix::rowtype& p_row ) const
+    template<typename T> inline T euclid<T>::getInvert( const T& p_val ) const
     {
-        ublas::matrix<T> l_matrix = p_matrix;
-        normalize(l_matrix, p_row);
-        return l_matrix;
-    }
+        return std::pow( p_val, static_cast<T>(-2) );
+    }    
     
     
     
-    /** returns the length of a vector
+    /** calculate absolut values for every element of the vector like vec.^2
      * @param p_vec vector
-     * @return length of the vector
      **/
-    template<typename T> inline T euclid<T>::getLength( const ublas::vector<T>& p_vec ) const
+    template<typename T> inline void euclid<T>::abs( ublas::vector<T>& p_vec ) const
     {
-        return blas::nrm2( p_vec );
+        for(std::size_t i=0; i < p_vec.size(); ++i)
+            p_vec(i) *= p_vec(i);
     }
-
     
     
-    /** returns for every row or column the length 
-     * @param p_matrix matrix
-     * @param p_row option for row or column iteration (default row)
-     * @return vector with length
+    
+    /** squared distance kernel [ sum (a-b)^2 ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_size number of elements
+     * @return squared distance
      **/
-    template<typename T> inline ublas::vector<T> euclid<T>::getLength( const ublas::matrix<T>& p_matrix, const tools::matrix::rowtype& p_row ) const
+    template<typename T> inline T euclid<T>::squaredKernel( const T* p_first, const T* p_second, const std::size_t& p_size )
     {
-        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_matrix.size1() : p_matrix.size2()  );
+        T l_sum = 0;
         
-        switch (p_row) {                
-            case tools::matrix::row :
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = blas::nrm2( static_cast< ublas::vector<T> >(ublas::row(p_matrix, i)) );
-                break;
-                
-                
-            case tools::matrix::column :  
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = blas::nrm2( static_cast< ublas::vector<T> >(ublas::column(p_matrix, i)) );
-                break;
+        #pragma omp simd reduction(+:l_sum)
+        for(std::size_t i=0; i < p_size; ++i) {
+            const T l_diff = p_first[i] - p_second[i];
+            l_sum += l_diff * l_diff;
         }
         
-        return l_vec;
+        return l_sum;
     }
     
     
     
-    /** returns a invertet value
-     * @param p_val value
-     * @return inverted value
-     **/
-    template<typename T> inline T euclid<T>::getInvert( const T& p_val ) const
-    {
-        return std::pow( p_val, static_cast<T>(-2) );
-    }    
-    
-    
-    
-    /** calculate absolut values for a vector like vec.^2
-     * @param p_vec vector
-     * @return absolut value
+    /** weighted squared distance kernel [ sum (w .* (a-b))^2 ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_weight weight array
+     * @param p_size number of elements
+     * @return squared distance
      **/
-    template<typename T> inline ublas::vector<T> euclid<T>::getAbs( const ublas::vector<T>& p_vec ) const
+    template<typename T> inline T euclid<T>::weightedSquaredKernel( const T* p_first, const T* p_second, const T* p_weight, const std::size_t& p_size )
     {
-        return tools::vector::pow<T>(p_vec, 2);
-    }    
+        T l_sum = 0;
+        
+        #pragma omp simd reduction(+:l_sum)
+        for(std::size_t i=0; i < p_size; ++i) {
+            const T l_diff = p_weight[i] * (p_first[i] - p_second[i]);
+            l_sum += l_diff * l_diff;
+        }
+        
+        return l_sum;
+    }
     
     
     
-    /** calculate absolut values for every element of the vector like vec.^2
-     * @param p_vec vector
+    /** distance kernel [ norm2(a-b) ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_size number of elements
+     * @return distance
      **/
-    template<typename T> inline void euclid<T>::abs( ublas::vector<T>& p_vec ) const
+    template<typename T> inline T euclid<T>::kernel( const T* p_first, const T* p_second, const std::size_t& p_size ) const
     {
-        p_vec = tools::vector::pow<T>(p_vec, 2);
+        return std::sqrt( squaredKernel(p_first, p_second, p_size) );
     }
-   
-
     
-    /** calculates the distance between two vectors
-     * @param p_first first vector
-     * @param p_second second vector
-     * @return distance value
-     **/
-    template<typename T> inline T euclid<T>::getDistance( const ublas::vector<T>& p_first, const ublas::vector<T>& p_second ) const
-    {
-        ublas::vector<T> l_vec = p_first-p_second;
-        return blas::nrm2( l_vec );
-    }
     
     
-    /** calculates the distance beween every row or column of the matrix and the vector [ norm(matrix({1..n},:) * vector)]
-     * @param p_data matrix
-     * @param p_vec vector
-     * @param p_row row / column option (default row)
-     * @return vector with distance values
+    /** weighted distance kernel [ norm2(w .* (a-b)) ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_weight weight array
+     * @param p_size number of elements
+     * @return distance
      **/
-    template<typename T> inline ublas::vector<T> euclid<T>::getDistance( const ublas::matrix<T>& p_data, const ublas::vector<T>& p_vec, const tools::matrix::rowtype& p_row ) const
+    template<typename T> inline T euclid<T>::weightedKernel( const T* p_first, const T* p_second, const T* p_weight, const std::size_t& p_size ) const
     {
-        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_data.size1() : p_data.size2()  );
-        
-        switch (p_row) {                
-            case tools::matrix::row :
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = getDistance( ublas::row(p_data, i), p_vec);
-                    
-                break;
-                
-                
-            case tools::matrix::column :  
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = getDistance( ublas::column(p_data, i), p_vec);
-                
-                break;
-        }
-
-        return l_vec;
+        return std::sqrt( weightedSquaredKernel(p_first, p_second, p_weight, p_size) );
     }
     
     
     
-    /** calculates the distance between every row and column of the matrices [ norm(matrixA[i,:] - matrixB(i,:))]
-     * @param p_first first matrix
-     * @param p_second second matrix
-     * @param p_row row / column option (default row)
-     * @return distance vector
+    /** order kernel, the squared distance has got the same order as the distance [ sum (a-b)^2 ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_size number of elements
+     * @return squared distance
      **/
-    template<typename T> inline ublas::vector<T> euclid<T>::getDistance( const ublas::matrix<T>& p_first, const ublas::matrix<T>& p_second, const tools::matrix::rowtype& p_row ) const
+    template<typename T> inline T euclid<T>::orderKernel( const T* p_first, const T* p_second, const std::size_t& p_size ) const
     {
-        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_first.size1() : p_first.size2()  );
-        ublas::matrix<T> l_matrix = p_first-p_second;
-        
-        switch (p_row) {                
-            
-            case tools::matrix::row :
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = blas::nrm2( static_cast< ublas::vector<T> >(ublas::row(l_matrix, i)) );
-                break;
-            
-                
-            case tools::matrix::column :  for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = blas::nrm2( static_cast< ublas::vector<T> >(ublas::column(l_matrix, i)) );
-                break;
-        }
-        
-        return l_vec;
+        return squaredKernel( p_first, p_second, p_size );
     }
     
     
     
-    /** calculates the weighted distance between two vectors [ norm2(weight .* (vectorA - vectorB)) ]
-     * @param p_first first vector
-     * @param p_second second vector
-     * @param p_weight weight vector
-     * @return distance value
+    /** weighted order kernel [ sum (w .* (a-b))^2 ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_weight weight array
+     * @param p_size number of elements
+     * @return squared distance
      **/
-    template<typename T> inline T euclid<T>::getWeightedDistance( const ublas::vector<T>& p_first, const ublas::vector<T>& p_second, const ublas::vector<T>& p_weight ) const
+    template<typename T> inline T euclid<T>::weightedOrderKernel( const T* p_first, const T* p_second, const T* p_weight, const std::size_t& p_size ) const
     {
-        ublas::vector<T> l_vec = p_first-p_second;
-        l_vec = ublas::element_prod( p_weight, l_vec );
-        return blas::nrm2(  l_vec );
+        return weightedSquaredKernel( p_first, p_second, p_weight, p_size );
     }
     
-
     
-    /** calculates the weighted distance between two vectors  [ norm2(weight(i,:) .* (matrix(i,:) - vector)) ]
-     * @param p_data data matrix
-     * @param p_vec vector
-     * @param p_weight weight vector
-     * @param p_row row / column option (default row)
-     * @return distance vector
+    
+    /** length kernel [ norm2(a) ]
+     * @param p_data array
+     * @param p_size number of elements
+     * @return length
      **/
-    template<typename T> inline ublas::vector<T> euclid<T>::getWeightedDistance( const ublas::matrix<T>& p_data, const ublas::vector<T>& p_vec, const ublas::vector<T>& p_weight, const tools::matrix::rowtype& p_row ) const
+    template<typename T> inline T euclid<T>::lengthKernel( const T* p_data, const std::size_t& p_size ) const
     {
-        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_data.size1() : p_data.size2()  );
-        ublas::vector<T> l_help;
+        T l_sum = 0;
         
-        switch (p_row) {                
-            case tools::matrix::row :
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i) {
-                    l_help   = ublas::row(p_data, i) - p_vec;
-                    l_help   = ublas::element_prod( p_weight, l_help );
-                    l_vec(i) = blas::nrm2( l_help );
-                }
-                
-                break;
-                
-                
-            case tools::matrix::column :  
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i) {
-                    l_help   = ublas::column(p_data, i) - p_vec;
-                    l_help   = ublas::element_prod( p_weight, l_help );
-                    l_vec(i) = blas::nrm2( l_help );
-                }
-                
-                break;
-        }
+        #pragma omp simd reduction(+:l_sum)
+        for(std::size_t i=0; i < p_size; ++i)
+            l_sum += p_data[i] * p_data[i];
         
-        return l_vec;        
+        return std::sqrt(l_sum);
     }
     
     
     
-    /** calculates the weighted distance between two matrices [ weight .* (matrixA - matrixB) ]
+    /** calculates the distances between every row of the first and every row of the second matrix. The
+     * identity ||a-b||^2 = ||a||^2 + ||b||^2 - 2 a*b' is used, so the main work is one BLAS-3 gemm call
+     * and the squared row norms are calculated only once for each matrix
      * @param p_first first matrix
      * @param p_second second matrix
-     * @param p_weight weight matrix
-     * @param p_row row / column option (default row)
-     * @return distance vector
+     * @return distance matrix (rows = rows of the first matrix, columns = rows of the second matrix)
      **/
-    template<typename T> inline ublas::vector<T> euclid<T>::getWeightedDistance( const ublas::matrix<T>& p_first, const ublas::matrix<T>& p_second, const ublas::matrix<T>& p_weight, const tools::matrix::rowtype& p_row ) const
+    template<typename T> inline ublas::matrix<T> euclid<T>::getPairwiseDistance( const ublas::matrix<T>& p_first, const ublas::matrix<T>& p_second ) const
     {
-        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_first.size1() : p_first.size2()  );
-        ublas::matrix<T> l_matrix = ublas::element_prod( p_weight, p_first-p_second );
+        if (p_first.size2() != p_second.size2())
+            throw exception::runtime(_("matrix column size must be equal"), *this);
         
-        switch (p_row) {                
-                
-            case tools::matrix::row :
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = blas::nrm2( static_cast< ublas::vector<T> >(ublas::row(l_matrix, i)) );
-                break;
-                
-                
-            case tools::matrix::column : 
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = blas::nrm2( static_cast< ublas::vector<T> >(ublas::column(l_matrix, i)) );
-                break;
-        }
+        // squared length of every row
+        ublas::vector<T> l_firstnorm( p_first.size1() );
+        ublas::vector<T> l_secondnorm( p_second.size1() );
+        
+        #pragma omp parallel for shared(l_firstnorm)
+        for(std::size_t i=0; i < l_firstnorm.size(); ++i)
+            l_firstnorm(i) = ublas::inner_prod( ublas::row(p_first, i), ublas::row(p_first, i) );
+        
+        #pragma omp parallel for shared(l_secondnorm)
+        for(std::size_t i=0; i < l_secondnorm.size(); ++i)
+            l_secondnorm(i) = ublas::inner_prod( ublas::row(p_second, i), ublas::row(p_second, i) );
+        
+        
+        // -2 * first * second' 
+        ublas::matrix<T> l_distances( p_first.size1(), p_second.size1() );
+        blas::gemm( static_cast<T>(-2), p_first, bind::trans(p_second), static_cast<T>(0), l_distances );
         
-        return l_vec;
+        
+        // add the norms, values can be negative on rounding errors, so they are set to zero
+        #pragma omp parallel for shared(l_distances)
+        for(std::size_t i=0; i < l_distances.size1(); ++i)
+            for(std::size_t j=0; j < l_distances.size2(); ++j)
+                l_distances(i,j) = std::sqrt( std::max( static_cast<T>(0), l_distances(i,j) + l_firstnorm(i) + l_secondnorm(j) ) );
+        
+        return l_distances;
     }
     
     
     
-    /** calculates the weighted distance between matrices, vector and weighted matrix  [ norm2(weight(i,:) .* (matrix(i,:) - vector)) ]
-     * @param p_matrix matrix
-     * @param p_vec vector
-     * @param p_weight weight matrix
-     * @param p_row row / column option (default row)
-     * @return distance vector
+    /** determines for every row of the data matrix the index of the nearest row of the prototype matrix.
+     * The data is processed in row blocks, so the full distance matrix is never created. The
+     * squared norm of the data row is equal for all prototypes, so the winner is the minimum
+     * of ||w||^2 - 2 x*w' and neither the data norms nor the square root must be calculated
+     * @param p_data data matrix
+     * @param p_prototypes prototype matrix
+     * @return index array with the nearest prototype of every data row
      **/
-    template<typename T> inline ublas::vector<T> euclid<T>::getWeightedDistance( const ublas::matrix<T>& p_matrix, const ublas::vector<T>& p_vec, const ublas::matrix<T>& p_weight, const tools::matrix::rowtype& p_row ) const
+    template<typename T> inline ublas::indirect_array<> euclid<T>::getNearest( const ublas::matrix<T>& p_data, const ublas::matrix<T>& p_prototypes ) const
     {
-        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_matrix.size1() : p_matrix.size2()  );
+        if (p_data.size2() != p_prototypes.size2())
+            throw exception::runtime(_("matrix column size must be equal"), *this);
+        if (p_prototypes.size1() == 0)
+            throw exception::runtime(_("prototype matrix must have one or more rows"), *this);
         
-        switch (p_row) {                
-                
-            case tools::matrix::row :
-                
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = getWeightedDistance( ublas::row(p_matrix, i), p_vec, ublas::row(p_weight, i) );
-                break;
-                
-            
-            case tools::matrix::column :
-
-                for(std::size_t i=0; i < l_vec.size(); ++i)
-                    l_vec(i) = getWeightedDistance( ublas::column(p_matrix, i), p_vec, ublas::column(p_weight, i) );
-                break;
+        // number of data rows, that are calculated with one gemm call
+        const std::size_t l_blocksize = 4096;
         
+        ublas::vector<T> l_norm( p_prototypes.size1() );
+        #pragma omp parallel for shared(l_norm)
+        for(std::size_t i=0; i < l_norm.size(); ++i)
+            l_norm(i) = ublas::inner_prod( ublas::row(p_prototypes, i), ublas::row(p_prototypes, i) );
+        
+        
+        ublas::indirect_array<> l_idx( p_data.size1() );
+        ublas::matrix<T> l_product;
+        
+        for(std::size_t n=0; n < p_data.size1(); n += l_blocksize) {
+            const std::size_t l_end = std::min( n+l_blocksize, p_data.size1() );
+            const ublas::matrix<T> l_block = ublas::subrange( p_data, n, l_end, 0, p_data.size2() );
+            
+            l_product.resize( l_block.size1(), p_prototypes.size1(), false );
+            blas::gemm( static_cast<T>(-2), l_block, bind::trans(p_prototypes), static_cast<T>(0), l_product );
+            
+            #pragma omp parallel for shared(l_product, l_idx)
+            for(std::size_t i=0; i < l_product.size1(); ++i) {
+                ublas::row(l_product, i) += l_norm;
+                l_idx[n+i] = tools::vector::argmin( ublas::row(l_product, i) );
+            }
         }
         
-        return l_vec;
+        return l_idx;
     }
     
     
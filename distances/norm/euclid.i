@@ -32,5 +32,6 @@
 #endif
 
  
+%import "../vectordistance.i"
 %include "euclid.hpp"
 %template(Euclid) machinelearning::distances::norm::euclid<double>;
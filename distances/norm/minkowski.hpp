@@ -0,0 +1,195 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_NORM_MINKOWSKI_HPP
+#define __MACHINELEARNING_DISTANCES_NORM_MINKOWSKI_HPP
+
+#include <cmath>
+#include <boost/numeric/ublas/vector.hpp>
+
+#include "../vectordistance.hpp"
+#include "../../errorhandling/exception.hpp"
+#include "../../tools/tools.h"
+
+
+namespace machinelearning { namespace distances { namespace norm {
+    
+    
+    #ifndef SWIG
+    namespace ublas  = boost::numeric::ublas;
+    #endif
+    
+    
+    /** class for calculating the minkowski (Lp) distance beween datapoints [ (sum |a-b|^p)^(1/p) ]. For
+     * p < 1 the triangle inequality does not hold, so the distance is not a metric
+     **/
+    template<typename T> class minkowski : public vectordistance<T>
+    {
+        
+        public:
+        
+            minkowski( const T& );
+        
+            T getP( void ) const;
+            bool isMetric( void ) const;
+            T getInvert( const T& ) const;
+            #ifndef SWIG
+            void abs( ublas::vector<T>& ) const;
+            #endif
+        
+        
+        #ifndef SWIG
+        protected :
+        
+            T kernel( const T*, const T*, const std::size_t& ) const;
+            T weightedKernel( const T*, const T*, const T*, const std::size_t& ) const;
+            T lengthKernel( const T*, const std::size_t& ) const;
+        #endif
+        
+        
+        private :
+        
+            /** exponent of the norm **/
+            const T m_p;
+        
+    };
+    
+    
+    
+    /** constructor
+     * @param p_p exponent of the norm
+     **/
+    template<typename T> inline minkowski<T>::minkowski( const T& p_p ) :
+        m_p( p_p )
+    {
+        if (p_p <= 0)
+            throw exception::runtime(_("exponent must be greater than zero"), *this);
+    }
+    
+    
+    
+    /** returns the exponent
+     * @return exponent
+     **/
+    template<typename T> inline T minkowski<T>::getP( void ) const
+    {
+        return m_p;
+    }
+    
+    
+    
+    /** the minkowski distance is a metric for p >= 1
+     * @return metric flag
+     **/
+    template<typename T> inline bool minkowski<T>::isMetric( void ) const
+    {
+        return m_p >= 1;
+    }
+    
+    
+    
+    /** returns a invertet value
+     * @param p_val value
+     * @return inverted value
+     **/
+    template<typename T> inline T minkowski<T>::getInvert( const T& p_val ) const
+    {
+        return std::pow( p_val, -m_p );
+    }
+    
+    
+    
+    /** calculate absolut values for every element of the vector like |vec|.^p
+     * @param p_vec vector
+     **/
+    template<typename T> inline void minkowski<T>::abs( ublas::vector<T>& p_vec ) const
+    {
+        for(std::size_t i=0; i < p_vec.size(); ++i)
+            p_vec(i) = std::pow( std::fabs(p_vec(i)), m_p );
+    }
+    
+    
+    
+    /** distance kernel [ (sum |a-b|^p)^(1/p) ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_size number of elements
+     * @return distance
+     **/
+    template<typename T> inline T minkowski<T>::kernel( const T* p_first, const T* p_second, const std::size_t& p_size ) const
+    {
+        const T l_p = m_p;
+        T l_sum     = 0;
+        
+        #pragma omp simd reduction(+:l_sum)
+        for(std::size_t i=0; i < p_size; ++i)
+            l_sum += std::pow( std::fabs(p_first[i] - p_second[i]), l_p );
+        
+        return std::pow( l_sum, static_cast<T>(1) / l_p );
+    }
+    
+    
+    
+    /** weighted distance kernel [ (sum |w .* (a-b)|^p)^(1/p) ]
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_weight weight array
+     * @param p_size number of elements
+     * @return distance
+     **/
+    template<typename T> inline T minkowski<T>::weightedKernel( const T* p_first, const T* p_second, const T* p_weight, const std::size_t& p_size ) const
+    {
+        const T l_p = m_p;
+        T l_sum     = 0;
+        
+        #pragma omp simd reduction(+:l_sum)
+        for(std::size_t i=0; i < p_size; ++i)
+            l_sum += std::pow( std::fabs(p_weight[i] * (p_first[i] - p_second[i])), l_p );
+        
+        return std::pow( l_sum, static_cast<T>(1) / l_p );
+    }
+    
+    
+    
+    /** length kernel [ (sum |a|^p)^(1/p) ]
+     * @param p_data array
+     * @param p_size number of elements
+     * @return length
+     **/
+    template<typename T> inline T minkowski<T>::lengthKernel( const T* p_data, const std::size_t& p_size ) const
+    {
+        const T l_p = m_p;
+        T l_sum     = 0;
+        
+        #pragma omp simd reduction(+:l_sum)
+        for(std::size_t i=0; i < p_size; ++i)
+            l_sum += std::pow( std::fabs(p_data[i]), l_p );
+        
+        return std::pow( l_sum, static_cast<T>(1) / l_p );
+    }
+    
+    
+} } }
+#endif
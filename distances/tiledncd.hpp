@@ -0,0 +1,409 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+#if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+
+#ifndef __MACHINELEARNING_DISTANCES_TILEDNCD_HPP
+#define __MACHINELEARNING_DISTANCES_TILEDNCD_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/static_assert.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "../errorhandling/exception.hpp"
+#include "../tools/files/hdf.hpp"
+#include "ncd.hpp"
+
+
+
+namespace machinelearning { namespace distances {
+    
+    #ifndef SWIG
+    namespace ublas = boost::numeric::ublas;
+    #endif
+    
+    
+    /** class for building a large NCD distance matrix out-of-core. The matrix
+     * is calculated in square tiles, each finished tile is written into a chunked
+     * and compressed HDF dataset and marked as done, so an interrupted run can be
+     * resumed and a grown corpus only calculates the new tiles. The compressed size
+     * of each document is stored too, so each document is compressed once and a
+     * tile compresses only its pairs. The HDF group contains the datasets "matrix",
+     * "tiles" (progress flags), "compressedsize", "size", "tilesize" and "symmetric",
+     * the compression parameters are stored as attributes "algorithm", "level",
+     * "nativelevel" and "priming" of the matrix and are checked on resume
+     * @note the order of the documents must not be changed between two runs, new
+     * documents must be appended
+     **/
+    template<typename T> class tiledncd
+    {
+        #ifndef SWIG
+        BOOST_STATIC_ASSERT( !boost::is_integral<T>::value );
+        #endif
+        
+        
+        public :
+            
+            tiledncd( const ncd<T>&, const tools::files::hdf&, const std::string&, const std::size_t& = 1024, const bool& = false, const tools::files::hdf::datatype& = tools::files::hdf::NATIVE_DOUBLE );
+            void build( const std::vector<std::string>&, const bool& = false );
+            void build( const std::vector<std::string>&, const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t&, const bool& = false );
+            void buildBand( const std::vector<std::string>&, const std::size_t&, const std::size_t&, const bool& = false );
+            std::size_t size( void ) const;
+            std::size_t getTileSize( void ) const;
+            std::size_t getMissingTiles( void ) const;
+            std::string getMatrixPath( void ) const;
+        
+        
+        private :
+            
+            /** ncd object **/
+            const ncd<T>& m_ncd;
+            /** HDF file reference **/
+            const tools::files::hdf& m_file;
+            /** group path **/
+            const std::string m_path;
+            /** datatype of the matrix **/
+            const tools::files::hdf::datatype m_datatype;
+            /** number of rows / columns of a tile **/
+            std::size_t m_tilesize;
+            /** flag for a symmetric matrix **/
+            bool m_symmetric;
+            /** number of documents within the matrix **/
+            std::size_t m_size;
+            /** progress flags of the tiles **/
+            ublas::matrix<unsigned char> m_tiles;
+            /** compressed size of each document **/
+            std::vector<std::size_t> m_compressedsize;
+            
+            void prepare( const std::vector<std::string>&, const bool& );
+            void extend( const std::size_t& );
+            void calculateTiles( const std::vector<std::string>&, const bool&, const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t& );
+            void calculateTile( const std::vector<std::string>&, const bool&, const std::size_t&, const std::size_t& );
+            void setTile( const std::size_t&, const std::size_t&, const unsigned char& );
+        
+    };
+    
+    
+    
+    /** constructor, an existing group is opened and resumed, so the tile size and
+     * the symmetric flag are read from the file. The compression parameters are
+     * written as last step of the creation, so a group without them is created again
+     * @param p_ncd ncd object (the object must exist during the lifetime of the builder)
+     * @param p_file HDF object (the object must exist during the lifetime of the builder)
+     * @param p_path group path
+     * @param p_tilesize number of rows / columns of a tile
+     * @param p_symmetric build a symmetric matrix (the mean of both directions of a pair)
+     * @param p_datatype datatype of the matrix
+     **/
+    template<typename T> inline tiledncd<T>::tiledncd( const ncd<T>& p_ncd, const tools::files::hdf& p_file, const std::string& p_path, const std::size_t& p_tilesize, const bool& p_symmetric, const tools::files::hdf::datatype& p_datatype ) :
+        m_ncd( p_ncd ),
+        m_file( p_file ),
+        m_path( p_path ),
+        m_datatype( p_datatype ),
+        m_tilesize( p_tilesize ),
+        m_symmetric( p_symmetric ),
+        m_size( 0 ),
+        m_tiles(),
+        m_compressedsize()
+    {
+        if (p_tilesize == 0)
+            throw exception::runtime(_("tile size must be greater than zero"), *this);
+        
+        if ((!m_file.pathexists(getMatrixPath())) || (!m_file.attributeexists(getMatrixPath(), "priming")))
+            return;
+        
+        if ( (m_file.readAttribute<std::size_t>( getMatrixPath(), "algorithm", tools::files::hdf::NATIVE_ULONG ) != static_cast<std::size_t>(m_ncd.getCompressionType())) ||
+             (m_file.readAttribute<int>( getMatrixPath(), "level", tools::files::hdf::NATIVE_INT ) != m_ncd.getCompressionLevel()) ||
+             ((m_file.readAttribute<std::size_t>( getMatrixPath(), "nativelevel", tools::files::hdf::NATIVE_ULONG ) != 0) != m_ncd.isNativeCompressionLevel()) ||
+             ((m_file.readAttribute<std::size_t>( getMatrixPath(), "priming", tools::files::hdf::NATIVE_ULONG ) != 0) != m_ncd.getPriming())
+           )
+            throw exception::runtime(_("compression parameters do not match the stored matrix"), *this);
+        
+        m_tilesize  = m_file.readValue<std::size_t>( m_path + "/tilesize", tools::files::hdf::NATIVE_ULONG );
+        m_symmetric = m_file.readValue<std::size_t>( m_path + "/symmetric", tools::files::hdf::NATIVE_ULONG ) != 0;
+        m_tiles     = m_file.readBlasMatrix<unsigned char>( m_path + "/tiles", tools::files::hdf::NATIVE_UINT8 );
+        
+        // the size is written again after the datasets are extended, so the
+        // size of an interrupted extension is the size of the extended matrix
+        m_size      = m_file.pathexists(m_path + "/size") ? m_file.readValue<std::size_t>( m_path + "/size", tools::files::hdf::NATIVE_ULONG ) : m_file.getMatrixSize( getMatrixPath() ).first;
+        
+        if (m_symmetric != p_symmetric)
+            throw exception::runtime(_("symmetric flag does not match the stored matrix"), *this);
+    }
+    
+    
+    /** returns the number of documents within the matrix
+     * @return number of rows / columns
+     **/
+    template<typename T> inline std::size_t tiledncd<T>::size( void ) const
+    {
+        return m_size;
+    }
+    
+    
+    /** returns the tile size
+     * @return number of rows / columns of a tile
+     **/
+    template<typename T> inline std::size_t tiledncd<T>::getTileSize( void ) const
+    {
+        return m_tilesize;
+    }
+    
+    
+    /** returns the path of the matrix dataset, so the matrix can be read
+     * with the hdfdissimilarity
+     * @return dataset path
+     **/
+    template<typename T> inline std::string tiledncd<T>::getMatrixPath( void ) const
+    {
+        return m_path + "/matrix";
+    }
+    
+    
+    /** returns the number of tiles, that are not calculated
+     * @return number of tiles
+     **/
+    template<typename T> inline std::size_t tiledncd<T>::getMissingTiles( void ) const
+    {
+        std::size_t l_missing = 0;
+        for(std::size_t i=0; i < m_tiles.size1(); ++i)
+            for(std::size_t j=(m_symmetric ? i : 0); j < m_tiles.size2(); ++j)
+                if (!m_tiles(i,j))
+                    l_missing++;
+        
+        return l_missing;
+    }
+    
+    
+    /** builds the whole matrix, finished tiles are skipped
+     * @param p_data data vector (strings or filenames)
+     * @param p_isfile data vector holds filenames
+     **/
+    template<typename T> inline void tiledncd<T>::build( const std::vector<std::string>& p_data, const bool& p_isfile )
+    {
+        prepare( p_data, p_isfile );
+        calculateTiles( p_data, p_isfile, 0, m_tiles.size1(), 0, m_tiles.size2() );
+    }
+    
+    
+    /** builds a block of the matrix, all tiles that intersect the block are calculated,
+     * finished tiles are skipped
+     * @param p_data data vector (strings or filenames)
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @param p_col start column
+     * @param p_cols number of columns
+     * @param p_isfile data vector holds filenames
+     **/
+    template<typename T> inline void tiledncd<T>::build( const std::vector<std::string>& p_data, const std::size_t& p_row, const std::size_t& p_rows, const std::size_t& p_col, const std::size_t& p_cols, const bool& p_isfile )
+    {
+        if ((p_row >= p_data.size()) || (p_col >= p_data.size()) || (p_rows == 0) || (p_cols == 0))
+            throw exception::runtime(_("block index is out of range"), *this);
+        
+        prepare( p_data, p_isfile );
+        calculateTiles( p_data, p_isfile, 
+                        p_row / m_tilesize, (std::min(p_row+p_rows, p_data.size()) - 1) / m_tilesize + 1,
+                        p_col / m_tilesize, (std::min(p_col+p_cols, p_data.size()) - 1) / m_tilesize + 1
+                      );
+    }
+    
+    
+    /** builds a band of rows and the columns with the same indices, so the
+     * distances between a range of (new) documents and all other documents
+     * are calculated
+     * @param p_data data vector (strings or filenames)
+     * @param p_start index of the first document
+     * @param p_count number of documents
+     * @param p_isfile data vector holds filenames
+     **/
+    template<typename T> inline void tiledncd<T>::buildBand( const std::vector<std::string>& p_data, const std::size_t& p_start, const std::size_t& p_count, const bool& p_isfile )
+    {
+        build( p_data, p_start, p_count, 0, p_data.size(), p_isfile );
+        if (!m_symmetric)
+            build( p_data, 0, p_data.size(), p_start, p_count, p_isfile );
+    }
+    
+    
+    /** creates the datasets or extends them, if the corpus has grown, and
+     * calculates the compressed sizes of the documents, that are not stored
+     * @param p_data data vector
+     * @param p_isfile data vector holds filenames
+     **/
+    template<typename T> inline void tiledncd<T>::prepare( const std::vector<std::string>& p_data, const bool& p_isfile )
+    {
+        if (p_data.size() == 0)
+            throw exception::runtime(_("data vector need not be empty"), *this);
+        if (p_data.size() < m_size)
+            throw exception::runtime(_("data vector is smaller than the stored matrix"), *this);
+        
+        if (p_data.size() > m_size)
+            extend( p_data.size() );
+        
+        if (m_compressedsize.size() == m_size)
+            return;
+        
+        // the stored sizes are read and only the sizes of the appended documents are calculated
+        const std::string l_path = m_path + "/compressedsize";
+        m_compressedsize = m_file.pathexists(l_path) ? m_file.readStdVector<std::size_t>( l_path, tools::files::hdf::NATIVE_ULONG ) : std::vector<std::size_t>();
+        if (m_compressedsize.size() > m_size)
+            throw exception::runtime(_("number of compressed sizes does not match the stored matrix"), *this);
+        if (m_compressedsize.size() == m_size)
+            return;
+        
+        if (m_compressedsize.empty())
+            m_compressedsize = m_ncd.getCompressedSize( p_data, p_isfile );
+        else {
+            const std::vector<std::size_t> l_size = m_ncd.getCompressedSize( std::vector<std::string>(p_data.begin()+m_compressedsize.size(), p_data.end()), p_isfile );
+            m_compressedsize.insert( m_compressedsize.end(), l_size.begin(), l_size.end() );
+        }
+        
+        if (m_file.pathexists(l_path))
+            m_file.remove( l_path );
+        m_file.writeStdVector<std::size_t>( l_path, m_compressedsize, tools::files::hdf::NATIVE_ULONG );
+        m_file.flush();
+    }
+    
+    
+    /** creates the datasets or extends them to the new number of documents. Each
+     * step can be run again, so an interrupted run is finished on the next call
+     * @param p_size number of documents
+     **/
+    template<typename T> inline void tiledncd<T>::extend( const std::size_t& p_size )
+    {
+        const std::size_t l_tiles = (p_size - 1) / m_tilesize + 1;
+        
+        if (m_size == 0) {
+            // datasets of an interrupted creation are removed
+            const std::string l_datasets[] = { "matrix", "tiles", "tilesize", "symmetric", "size", "compressedsize" };
+            for(std::size_t i=0; i < sizeof(l_datasets) / sizeof(std::string); ++i)
+                if (m_file.pathexists(m_path + "/" + l_datasets[i]))
+                    m_file.remove( m_path + "/" + l_datasets[i] );
+            
+            m_file.createChunkedMatrix( m_path + "/tiles", l_tiles, l_tiles, tools::files::hdf::NATIVE_UINT8, 64, 0 );
+            m_file.writeValue<std::size_t>( m_path + "/tilesize", m_tilesize, tools::files::hdf::NATIVE_ULONG );
+            m_file.writeValue<std::size_t>( m_path + "/symmetric", m_symmetric ? 1 : 0, tools::files::hdf::NATIVE_ULONG );
+            m_file.createChunkedMatrix( getMatrixPath(), p_size, p_size, m_datatype, m_tilesize );
+            m_file.writeAttribute<std::size_t>( getMatrixPath(), "algorithm", static_cast<std::size_t>(m_ncd.getCompressionType()), tools::files::hdf::NATIVE_ULONG );
+            m_file.writeAttribute<int>( getMatrixPath(), "level", m_ncd.getCompressionLevel(), tools::files::hdf::NATIVE_INT );
+            m_file.writeAttribute<std::size_t>( getMatrixPath(), "nativelevel", m_ncd.isNativeCompressionLevel() ? 1 : 0, tools::files::hdf::NATIVE_ULONG );
+            m_file.writeAttribute<std::size_t>( getMatrixPath(), "priming", m_ncd.getPriming() ? 1 : 0, tools::files::hdf::NATIVE_ULONG );
+        } else {
+            // the last tile row / column was cut at the old border, so it must be calculated again
+            // (the flags are reset before the extension, so the old size is valid until the reset is done)
+            if (m_size % m_tilesize) {
+                const std::size_t l_last  = m_size / m_tilesize;
+                const std::size_t l_count = m_tiles.size1();
+                m_file.writeBlasMatrix<unsigned char>( m_path + "/tiles", ublas::matrix<unsigned char>(1, l_count, 0), tools::files::hdf::NATIVE_UINT8, l_last, 0 );
+                m_file.writeBlasMatrix<unsigned char>( m_path + "/tiles", ublas::matrix<unsigned char>(l_count, 1, 0), tools::files::hdf::NATIVE_UINT8, 0, l_last );
+                m_file.flush();
+            }
+            
+            m_file.extendMatrix( getMatrixPath(), p_size, p_size );
+            m_file.extendMatrix( m_path + "/tiles", l_tiles, l_tiles );
+        }
+        
+        m_size = p_size;
+        if (m_file.pathexists(m_path + "/size"))
+            m_file.remove( m_path + "/size" );
+        m_file.writeValue<std::size_t>( m_path + "/size", m_size, tools::files::hdf::NATIVE_ULONG );
+        m_tiles = m_file.readBlasMatrix<unsigned char>( m_path + "/tiles", tools::files::hdf::NATIVE_UINT8 );
+        m_file.flush();
+    }
+    
+    
+    /** calculates all missing tiles within a range of the tile grid,
+     * on a symmetric matrix the tiles below the diagonal are mapped to the upper ones
+     * @param p_data data vector
+     * @param p_isfile data vector holds filenames
+     * @param p_rowstart first tile row
+     * @param p_rowend tile row behind the last one
+     * @param p_colstart first tile column
+     * @param p_colend tile column behind the last one
+     **/
+    template<typename T> inline void tiledncd<T>::calculateTiles( const std::vector<std::string>& p_data, const bool& p_isfile, const std::size_t& p_rowstart, const std::size_t& p_rowend, const std::size_t& p_colstart, const std::size_t& p_colend )
+    {
+        for(std::size_t i=p_rowstart; i < p_rowend; ++i)
+            for(std::size_t j=p_colstart; j < p_colend; ++j) {
+                const std::size_t l_row = m_symmetric ? std::min(i,j) : i;
+                const std::size_t l_col = m_symmetric ? std::max(i,j) : j;
+                
+                if (!m_tiles(l_row, l_col))
+                    calculateTile( p_data, p_isfile, l_row, l_col );
+            }
+    }
+    
+    
+    /** calculates a tile with the stored compressed sizes and writes it to the file,
+     * after that the tile is marked as done
+     * @param p_data data vector
+     * @param p_isfile data vector holds filenames
+     * @param p_row tile row
+     * @param p_col tile column
+     **/
+    template<typename T> inline void tiledncd<T>::calculateTile( const std::vector<std::string>& p_data, const bool& p_isfile, const std::size_t& p_row, const std::size_t& p_col )
+    {
+        const std::size_t l_row = p_row * m_tilesize;
+        const std::size_t l_col = p_col * m_tilesize;
+        
+        // on a symmetric matrix each value is the mean of both directions of the pair
+        ublas::matrix<T> l_block = m_ncd.getBlock( p_data, m_compressedsize, l_row, m_tilesize, l_col, m_tilesize, p_isfile, m_symmetric );
+        
+        // the main diagonal of the whole matrix must be zero
+        for(std::size_t i=std::max(l_row, l_col); i < std::min(l_row+l_block.size1(), l_col+l_block.size2()); ++i)
+            l_block(i-l_row, i-l_col) = 0;
+        
+        if (!m_symmetric) {
+            m_file.writeBlasMatrix<T>( getMatrixPath(), l_block, m_datatype, l_row, l_col );
+            setTile( p_row, p_col, 1 );
+            return;
+        }
+        
+        // the mirrored block is written below the diagonal
+        m_file.writeBlasMatrix<T>( getMatrixPath(), l_block, m_datatype, l_row, l_col );
+        if (p_row != p_col)
+            m_file.writeBlasMatrix<T>( getMatrixPath(), ublas::matrix<T>(ublas::trans(l_block)), m_datatype, l_col, l_row );
+        
+        setTile( p_row, p_col, 1 );
+        setTile( p_col, p_row, 1 );
+    }
+    
+    
+    /** sets the progress flag of a tile and flushes the file, so the
+     * tile is stored, if the run is interrupted
+     * @param p_row tile row
+     * @param p_col tile column
+     * @param p_value flag value
+     **/
+    template<typename T> inline void tiledncd<T>::setTile( const std::size_t& p_row, const std::size_t& p_col, const unsigned char& p_value )
+    {
+        m_tiles(p_row, p_col) = p_value;
+        m_file.writeBlasMatrix<unsigned char>( m_path + "/tiles", ublas::matrix<unsigned char>(1, 1, p_value), tools::files::hdf::NATIVE_UINT8, p_row, p_col );
+        m_file.flush();
+    }
+    
+    
+}}
+#endif
+#endif
@@ -0,0 +1,619 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_DISTANCES_VECTORDISTANCE_HPP
+#define __MACHINELEARNING_DISTANCES_VECTORDISTANCE_HPP
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+
+#include "distance.hpp"
+#include "../errorhandling/exception.hpp"
+#include "../tools/tools.h"
+
+
+namespace machinelearning { namespace distances {
+    
+    
+    #ifndef SWIG
+    namespace ublas = boost::numeric::ublas;
+    #endif
+    
+    
+    /** abstract class for distances, that are calculated by a kernel function on two
+     * contiguous arrays. The matrix, pairwise, nearest and weighted calculations are
+     * implemented here, so a derived class must only implement the kernels (and the
+     * properties of the distance). The kernels are plain loops over raw pointers, so
+     * the compiler can vectorize them for float and double.
+     **/
+    template<typename T> class vectordistance : public distance<T>
+    {
+        
+        public:
+        
+            #ifndef SWIG
+            void normalize( ublas::vector<T>& ) const;
+            void normalize( ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;        
+            #endif
+            ublas::vector<T> getNormalize( const ublas::vector<T>& ) const;
+            ublas::matrix<T> getNormalize( const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
+        
+            T getLength( const ublas::vector<T>& ) const;
+            ublas::vector<T> getLength( const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
+            ublas::vector<T> getAbs( const ublas::vector<T>& ) const;
+            bool isSeparable( void ) const;
+        
+            T getDistance( const ublas::vector<T>&, const ublas::vector<T>& ) const;        
+            ublas::vector<T> getDistance( const ublas::matrix<T>&, const ublas::vector<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
+            ublas::vector<T> getDistance( const ublas::matrix<T>&, const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
+            ublas::matrix<T> getPairwiseDistance( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+            ublas::indirect_array<> getNearest( const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+        
+            #ifndef SWIG
+            T getWeightedDistance( const ublas::vector<T>&, const ublas::vector<T>&, const ublas::vector<T>& ) const;        
+            ublas::vector<T> getWeightedDistance( const ublas::matrix<T>&, const ublas::vector<T>&, const ublas::vector<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;        
+            ublas::vector<T> getWeightedDistance( const ublas::matrix<T>&, const ublas::matrix<T>&, const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
+            ublas::vector<T> getWeightedDistance( const ublas::matrix<T>&, const ublas::vector<T>&, const ublas::matrix<T>&, const tools::matrix::rowtype& = tools::matrix::row ) const;
+            std::size_t getWeightedNearest( const ublas::matrix<T>&, const std::size_t&, const ublas::matrix<T>&, const ublas::matrix<T>& ) const;
+            #endif
+        
+        
+        #ifndef SWIG
+        protected :
+        
+            /** distance between two arrays of the given size **/
+            virtual T kernel( const T*, const T*, const std::size_t& ) const = 0;
+        
+            /** weighted distance between two arrays, the third array holds the weights **/
+            virtual T weightedKernel( const T*, const T*, const T*, const std::size_t& ) const = 0;
+        
+            /** length of an array **/
+            virtual T lengthKernel( const T*, const std::size_t& ) const = 0;
+        
+            /** value with the order of the distance between two arrays **/
+            virtual T orderKernel( const T*, const T*, const std::size_t& ) const;
+            /** value with the order of the weighted distance between two arrays **/
+            virtual T weightedOrderKernel( const T*, const T*, const T*, const std::size_t& ) const;
+            virtual void checkDimension( const std::size_t& ) const;
+        
+        
+            static const T* getRow( const ublas::matrix<T>&, const std::size_t& );
+            static const T* getData( const ublas::vector<T>& );
+        #endif
+        
+    };
+    
+    
+    
+    /** checks the data dimension before the kernels are called. The kernels run
+     * within parallel loops, so they must not throw and a derived class, which supports
+     * only one dimension, checks it here
+     **/
+    template<typename T> inline void vectordistance<T>::checkDimension( const std::size_t& ) const
+    {
+    }
+    
+    
+    
+    /** the vector distances are calculated on the element differences, so they
+     * can be split into the dimensions
+     * @return true
+     **/
+    template<typename T> inline bool vectordistance<T>::isSeparable( void ) const
+    {
+        return true;
+    }
+    
+    
+    
+    /** kernel for the nearest searches, the value must have got the same order as the distance,
+     * so a derived class can remove the last monotone step of the distance (e.g. the square root)
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_size number of elements
+     * @return value with the order of the distance
+     **/
+    template<typename T> inline T vectordistance<T>::orderKernel( const T* p_first, const T* p_second, const std::size_t& p_size ) const
+    {
+        return kernel( p_first, p_second, p_size );
+    }
+    
+    
+    
+    /** weighted kernel for the nearest searches, the value must have got the same order as the weighted distance
+     * @param p_first first array
+     * @param p_second second array
+     * @param p_weight weight array
+     * @param p_size number of elements
+     * @return value with the order of the weighted distance
+     **/
+    template<typename T> inline T vectordistance<T>::weightedOrderKernel( const T* p_first, const T* p_second, const T* p_weight, const std::size_t& p_size ) const
+    {
+        return weightedKernel( p_first, p_second, p_weight, p_size );
+    }
+    
+    
+    
+    /** returns a pointer to the first element of a matrix row (the matrix is stored row-major)
+     * @param p_matrix matrix
+     * @param p_row row index
+     * @return pointer
+     **/
+    template<typename T> inline const T* vectordistance<T>::getRow( const ublas::matrix<T>& p_matrix, const std::size_t& p_row )
+    {
+        return p_matrix.data().begin() + p_row * p_matrix.size2();
+    }
+    
+    
+    
+    /** returns a pointer to the first element of a vector
+     * @param p_vec vector
+     * @return pointer
+     **/
+    template<typename T> inline const T* vectordistance<T>::getData( const ublas::vector<T>& p_vec )
+    {
+        return p_vec.data().begin();
+    }
+    
+    
+    
+    /** normalize a vector, a vector with zero length is not changed
+     * @param p_vec vector which should be normalized
+     **/
+    template<typename T> inline void vectordistance<T>::normalize( ublas::vector<T>& p_vec ) const 
+    {
+        const T l_length = getLength(p_vec);
+        if (l_length > 0)
+            p_vec /= l_length;
+    }    
+    
+    
+    
+    /** normalize a matrix on their rows or columns vectors, row or column vectors with
+     * zero length are not changed
+     * @param p_matrix matrix for normalization
+     * @param p_row option for row or column iteration (default row)
+     **/
+    template<typename T> inline void vectordistance<T>::normalize( ublas::matrix<T>& p_matrix, const tools::matrix::rowtype& p_row ) const
+    { 
+        const ublas::vector<T> l_length = getLength(p_matrix, p_row);
+        
+        switch (p_row) {                
+            case tools::matrix::row :
+                
+                for(std::size_t i=0; i < l_length.size(); ++i)
+                    if (l_length(i) > 0)
+                        ublas::row(p_matrix, i) /= l_length(i);
+                break;
+                
+                
+            case tools::matrix::column :  
+                
+                for(std::size_t i=0; i < l_length.size(); ++i)
+                    if (l_length(i) > 0)
+                        ublas::column(p_matrix, i) /= l_length(i);
+                break;
+        }
+    }
+    
+    
+    
+    /** return the normalized vector, a vector with zero length is returned unchanged
+     * @param p_vec vector which should be normalized
+     * @return vector
+     **/
+    template<typename T> inline ublas::vector<T> vectordistance<T>::getNormalize( const ublas::vector<T>& p_vec ) const 
+    {
+        ublas::vector<T> l_vec = p_vec;
+        normalize(l_vec);
+        return l_vec;
+    }
+    
+    
+    
+    /** normalize a matrix on their rows or columns vectors, vectors with zero length are not changed
+     * @param p_matrix matrix for normalization
+     * @param p_row option for row or column iteration (default row)
+     * @return normalized matrix
+     **/
+    template<typename T> inline ublas::matrix<T> vectordistance<T>::getNormalize( const ublas::matrix<T>& p_matrix, const tools::matrix::rowtype& p_row ) const
+    {
+        ublas::matrix<T> l_matrix = p_matrix;
+        normalize(l_matrix, p_row);
+        return l_matrix;
+    }
+    
+    
+    
+    /** returns the length of a vector
+     * @param p_vec vector
+     * @return length of the vector
+     **/
+    template<typename T> inline T vectordistance<T>::getLength( const ublas::vector<T>& p_vec ) const
+    {
+        checkDimension( p_vec.size() );
+        return lengthKernel( getData(p_vec), p_vec.size() );
+    }
+    
+    
+    
+    /** returns for every row or column the length 
+     * @param p_matrix matrix
+     * @param p_row option for row or column iteration (default row)
+     * @return vector with length
+     **/
+    template<typename T> inline ublas::vector<T> vectordistance<T>::getLength( const ublas::matrix<T>& p_matrix, const tools::matrix::rowtype& p_row ) const
+    {
+        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_matrix.size1() : p_matrix.size2()  );
+        
+        switch (p_row) {                
+            case tools::matrix::row :
+                
+                checkDimension( p_matrix.size2() );
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = lengthKernel( getRow(p_matrix, i), p_matrix.size2() );
+                break;
+                
+                
+            case tools::matrix::column :  
+                
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = getLength( static_cast< ublas::vector<T> >(ublas::column(p_matrix, i)) );
+                break;
+        }
+        
+        return l_vec;
+    }
+    
+    
+    
+    /** returns a vector with the absolut values
+     * @param p_vec vector
+     * @return absolut value
+     **/
+    template<typename T> inline ublas::vector<T> vectordistance<T>::getAbs( const ublas::vector<T>& p_vec ) const
+    {
+        ublas::vector<T> l_vec = p_vec;
+        this->abs(l_vec);
+        return l_vec;
+    }
+    
+    
+    
+    /** calculates the distance between two vectors
+     * @param p_first first vector
+     * @param p_second second vector
+     * @return distance value
+     **/
+    template<typename T> inline T vectordistance<T>::getDistance( const ublas::vector<T>& p_first, const ublas::vector<T>& p_second ) const
+    {
+        if (p_first.size() != p_second.size())
+            throw exception::runtime(_("vector size must be equal"), *this);
+        
+        checkDimension( p_first.size() );
+        return kernel( getData(p_first), getData(p_second), p_first.size() );
+    }
+    
+    
+    
+    /** calculates the distance beween every row or column of the matrix and the vector
+     * @param p_data matrix
+     * @param p_vec vector
+     * @param p_row row / column option (default row)
+     * @return vector with distance values
+     **/
+    template<typename T> inline ublas::vector<T> vectordistance<T>::getDistance( const ublas::matrix<T>& p_data, const ublas::vector<T>& p_vec, const tools::matrix::rowtype& p_row ) const
+    {
+        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_data.size1() : p_data.size2()  );
+        
+        switch (p_row) {                
+            case tools::matrix::row :
+                
+                if (p_data.size2() != p_vec.size())
+                    throw exception::runtime(_("matrix column size and vector size must be equal"), *this);
+                
+                checkDimension( p_vec.size() );
+                #pragma omp parallel for shared(l_vec)
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = kernel( getRow(p_data, i), getData(p_vec), p_vec.size() );
+                break;
+                
+                
+            case tools::matrix::column :  
+                
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = getDistance( static_cast< ublas::vector<T> >(ublas::column(p_data, i)), p_vec );
+                break;
+        }
+        
+        return l_vec;
+    }
+    
+    
+    
+    /** calculates the distance between every row and column of the matrices
+     * @param p_first first matrix
+     * @param p_second second matrix
+     * @param p_row row / column option (default row)
+     * @return distance vector
+     **/
+    template<typename T> inline ublas::vector<T> vectordistance<T>::getDistance( const ublas::matrix<T>& p_first, const ublas::matrix<T>& p_second, const tools::matrix::rowtype& p_row ) const
+    {
+        if ( (p_first.size1() != p_second.size1()) || (p_first.size2() != p_second.size2()) )
+            throw exception::runtime(_("matrix sizes must be equal"), *this);
+        
+        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_first.size1() : p_first.size2()  );
+        
+        switch (p_row) {                
+            case tools::matrix::row :
+                
+                checkDimension( p_first.size2() );
+                #pragma omp parallel for shared(l_vec)
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = kernel( getRow(p_first, i), getRow(p_second, i), p_first.size2() );
+                break;
+                
+                
+            case tools::matrix::column :  
+                
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = getDistance( static_cast< ublas::vector<T> >(ublas::column(p_first, i)), static_cast< ublas::vector<T> >(ublas::column(p_second, i)) );
+                break;
+        }
+        
+        return l_vec;
+    }
+    
+    
+    
+    /** calculates the distances between every row of the first and every row of the second matrix
+     * @param p_first first matrix
+     * @param p_second second matrix
+     * @return distance matrix (rows = rows of the first matrix, columns = rows of the second matrix)
+     **/
+    template<typename T> inline ublas::matrix<T> vectordistance<T>::getPairwiseDistance( const ublas::matrix<T>& p_first, const ublas::matrix<T>& p_second ) const
+    {
+        if (p_first.size2() != p_second.size2())
+            throw exception::runtime(_("matrix column size must be equal"), *this);
+        
+        ublas::matrix<T> l_distances( p_first.size1(), p_second.size1() );
+        
+        checkDimension( p_first.size2() );
+        #pragma omp parallel for shared(l_distances)
+        for(std::size_t i=0; i < l_distances.size1(); ++i)
+            for(std::size_t j=0; j < l_distances.size2(); ++j)
+                l_distances(i,j) = kernel( getRow(p_first, i), getRow(p_second, j), p_first.size2() );
+        
+        return l_distances;
+    }
+    
+    
+    
+    /** determines for every row of the data matrix the index of the nearest row of the prototype matrix
+     * without creating the full distance matrix
+     * @param p_data data matrix
+     * @param p_prototypes prototype matrix
+     * @return index array with the nearest prototype of every data row
+     **/
+    template<typename T> inline ublas::indirect_array<> vectordistance<T>::getNearest( const ublas::matrix<T>& p_data, const ublas::matrix<T>& p_prototypes ) const
+    {
+        if (p_data.size2() != p_prototypes.size2())
+            throw exception::runtime(_("matrix column size must be equal"), *this);
+        if (p_prototypes.size1() == 0)
+            throw exception::runtime(_("prototype matrix must have one or more rows"), *this);
+        
+        ublas::indirect_array<> l_idx( p_data.size1() );
+        
+        checkDimension( p_data.size2() );
+        #pragma omp parallel for shared(l_idx)
+        for(std::size_t i=0; i < p_data.size1(); ++i) {
+            std::size_t l_nearest = 0;
+            T l_min = orderKernel( getRow(p_data, i), getRow(p_prototypes, 0), p_data.size2() );
+            
+            for(std::size_t j=1; j < p_prototypes.size1(); ++j) {
+                const T l_dist = orderKernel( getRow(p_data, i), getRow(p_prototypes, j), p_data.size2() );
+                if (l_dist < l_min) {
+                    l_min     = l_dist;
+                    l_nearest = j;
+                }
+            }
+            
+            l_idx[i] = l_nearest;
+        }
+        
+        return l_idx;
+    }
+    
+    
+    
+    /** calculates the weighted distance between two vectors
+     * @param p_first first vector
+     * @param p_second second vector
+     * @param p_weight weight vector
+     * @return distance value
+     **/
+    template<typename T> inline T vectordistance<T>::getWeightedDistance( const ublas::vector<T>& p_first, const ublas::vector<T>& p_second, const ublas::vector<T>& p_weight ) const
+    {
+        if ( (p_first.size() != p_second.size()) || (p_first.size() != p_weight.size()) )
+            throw exception::runtime(_("vector size must be equal"), *this);
+        
+        checkDimension( p_first.size() );
+        return weightedKernel( getData(p_first), getData(p_second), getData(p_weight), p_first.size() );
+    }
+    
+    
+    
+    /** calculates the weighted distance between every row or column of the matrix and the vector
+     * @param p_data data matrix
+     * @param p_vec vector
+     * @param p_weight weight vector
+     * @param p_row row / column option (default row)
+     * @return distance vector
+     **/
+    template<typename T> inline ublas::vector<T> vectordistance<T>::getWeightedDistance( const ublas::matrix<T>& p_data, const ublas::vector<T>& p_vec, const ublas::vector<T>& p_weight, const tools::matrix::rowtype& p_row ) const
+    {
+        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_data.size1() : p_data.size2()  );
+        
+        switch (p_row) {                
+            case tools::matrix::row :
+                
+                if ( (p_data.size2() != p_vec.size()) || (p_vec.size() != p_weight.size()) )
+                    throw exception::runtime(_("matrix column size and vector size must be equal"), *this);
+                
+                checkDimension( p_vec.size() );
+                #pragma omp parallel for shared(l_vec)
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = weightedKernel( getRow(p_data, i), getData(p_vec), getData(p_weight), p_vec.size() );
+                break;
+                
+                
+            case tools::matrix::column :  
+                
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = getWeightedDistance( static_cast< ublas::vector<T> >(ublas::column(p_data, i)), p_vec, p_weight );
+                break;
+        }
+        
+        return l_vec;        
+    }
+    
+    
+    
+    /** calculates the weighted distance between the rows or columns of two matrices
+     * @param p_first first matrix
+     * @param p_second second matrix
+     * @param p_weight weight matrix
+     * @param p_row row / column option (default row)
+     * @return distance vector
+     **/
+    template<typename T> inline ublas::vector<T> vectordistance<T>::getWeightedDistance( const ublas::matrix<T>& p_first, const ublas::matrix<T>& p_second, const ublas::matrix<T>& p_weight, const tools::matrix::rowtype& p_row ) const
+    {
+        if ( (p_first.size1() != p_second.size1()) || (p_first.size2() != p_second.size2()) || (p_first.size1() != p_weight.size1()) || (p_first.size2() != p_weight.size2()) )
+            throw exception::runtime(_("matrix sizes must be equal"), *this);
+        
+        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_first.size1() : p_first.size2()  );
+        
+        switch (p_row) {                
+            case tools::matrix::row :
+                
+                checkDimension( p_first.size2() );
+                #pragma omp parallel for shared(l_vec)
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = weightedKernel( getRow(p_first, i), getRow(p_second, i), getRow(p_weight, i), p_first.size2() );
+                break;
+                
+                
+            case tools::matrix::column : 
+                
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = getWeightedDistance( static_cast< ublas::vector<T> >(ublas::column(p_first, i)), static_cast< ublas::vector<T> >(ublas::column(p_second, i)), static_cast< ublas::vector<T> >(ublas::column(p_weight, i)) );
+                break;
+        }
+        
+        return l_vec;
+    }
+    
+    
+    
+    /** calculates the weighted distance between every row or column of the matrix and the vector, every
+     * row or column has got its own weight
+     * @param p_matrix matrix
+     * @param p_vec vector
+     * @param p_weight weight matrix
+     * @param p_row row / column option (default row)
+     * @return distance vector
+     **/
+    template<typename T> inline ublas::vector<T> vectordistance<T>::getWeightedDistance( const ublas::matrix<T>& p_matrix, const ublas::vector<T>& p_vec, const ublas::matrix<T>& p_weight, const tools::matrix::rowtype& p_row ) const
+    {
+        if ( (p_matrix.size1() != p_weight.size1()) || (p_matrix.size2() != p_weight.size2()) )
+            throw exception::runtime(_("matrix sizes must be equal"), *this);
+        
+        ublas::vector<T> l_vec( (p_row==tools::matrix::row) ? p_matrix.size1() : p_matrix.size2()  );
+        
+        switch (p_row) {                
+            case tools::matrix::row :
+                
+                if (p_matrix.size2() != p_vec.size())
+                    throw exception::runtime(_("matrix column size and vector size must be equal"), *this);
+                
+                checkDimension( p_vec.size() );
+                #pragma omp parallel for shared(l_vec)
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = weightedKernel( getRow(p_matrix, i), getData(p_vec), getRow(p_weight, i), p_vec.size() );
+                break;
+                
+                
+            case tools::matrix::column :
+                
+                for(std::size_t i=0; i < l_vec.size(); ++i)
+                    l_vec(i) = getWeightedDistance( static_cast< ublas::vector<T> >(ublas::column(p_matrix, i)), p_vec, static_cast< ublas::vector<T> >(ublas::column(p_weight, i)) );
+                break;
+        }
+        
+        return l_vec;
+    }
+    
+    
+    
+    /** returns the index of the nearest prototype for one data row, each prototype
+     * is weighted by its own weight row. The distances are not stored, so the
+     * function can be called for every sample of an online training
+     * @param p_data data matrix
+     * @param p_row row index of the data matrix
+     * @param p_prototypes prototype matrix
+     * @param p_weight weight matrix with one row for each prototype
+     * @return index of the nearest prototype
+     **/
+    template<typename T> inline std::size_t vectordistance<T>::getWeightedNearest( const ublas::matrix<T>& p_data, const std::size_t& p_row, const ublas::matrix<T>& p_prototypes, const ublas::matrix<T>& p_weight ) const
+    {
+        if (p_data.size2() != p_prototypes.size2())
+            throw exception::runtime(_("matrix column size must be equal"), *this);
+        if ( (p_prototypes.size1() != p_weight.size1()) || (p_prototypes.size2() != p_weight.size2()) )
+            throw exception::runtime(_("matrix sizes must be equal"), *this);
+        if (p_prototypes.size1() == 0)
+            throw exception::runtime(_("prototype matrix must have one or more rows"), *this);
+        if (p_row >= p_data.size1())
+            throw exception::runtime(_("row index is out of range"), *this);
+        
+        checkDimension( p_data.size2() );
+        
+        std::size_t l_nearest = 0;
+        T l_min = weightedOrderKernel( getRow(p_prototypes, 0), getRow(p_data, p_row), getRow(p_weight, 0), p_data.size2() );
+        
+        for(std::size_t i=1; i < p_prototypes.size1(); ++i) {
+            const T l_dist = weightedOrderKernel( getRow(p_prototypes, i), getRow(p_data, p_row), getRow(p_weight, i), p_data.size2() );
+            if (l_dist < l_min) {
+                l_min     = l_dist;
+                l_nearest = i;
+            }
+        }
+        
+        return l_nearest;
+    }
+    
+    
+} }
+#endif
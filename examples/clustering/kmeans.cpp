@@ -48,7 +48,9 @@ int main(int p_argc, char* p_argv[])
     
     // default values
     bool l_log;
+    bool l_accelerate;
     std::size_t l_iteration;
+    std::size_t l_batch;
 
     // create CML options with description
     po::options_description l_description("allowed options");
@@ -60,6 +62,8 @@ int main(int p_argc, char* p_argv[])
         ("prototype", po::value<std::size_t>(), "number of prototypes")
         ("iteration", po::value<std::size_t>(&l_iteration)->default_value(15), "number of iteration [default: 15]")
         ("log", po::value<bool>(&l_log)->default_value(false), "'true' for enable logging [default: false]")
+        ("accelerate", po::value<bool>(&l_accelerate)->default_value(false), "'true' for using the accelerated batch training [default: false]")
+        ("batch", po::value<std::size_t>(&l_batch)->default_value(0), "number of rows of each chunk for mini-batch training, the data is read chunk by chunk from the input file (0 = batch training) [default: 0]")
     ;
 
     po::variables_map l_map;
@@ -80,17 +84,27 @@ int main(int p_argc, char* p_argv[])
 
 
 
-    // read source hdf file and data
+    // read source hdf file and data (on mini-batch training only the first chunk)
     tools::files::hdf l_source( l_map["inputfile"].as<std::string>() );
-    ublas::matrix<double> l_data = l_source.readBlasMatrix<double>( l_map["inputpath"].as<std::string>(), tools::files::hdf::NATIVE_DOUBLE);
+    ublas::matrix<double> l_data = (l_batch == 0) ? l_source.readBlasMatrix<double>( l_map["inputpath"].as<std::string>(), tools::files::hdf::NATIVE_DOUBLE) : l_source.readBlasMatrix<double>( l_map["inputpath"].as<std::string>(), tools::files::hdf::NATIVE_DOUBLE, 0, l_batch);
 
 
     // create distance object, k-means object and enable logging
-    cluster::kmeans<double> l_kmeans(distance::norm::euclid<double>(), l_map["prototype"].as<std::size_t>(), l_data.size2());
+    const distance::norm::euclid<double> l_distance;
+    cluster::kmeans<double> l_kmeans(l_distance, l_map["prototype"].as<std::size_t>(), l_data.size2());
     l_kmeans.setLogging(l_log);
-
-    // train prototypes
-    l_kmeans.train(l_data, l_iteration);
+    l_kmeans.setAcceleration(l_accelerate);
+
+    // train prototypes (on mini-batch training each iteration runs over all chunks of the file)
+    if (l_batch == 0)
+        l_kmeans.train(l_data, l_iteration);
+    else {
+        for(std::size_t i=0; i < l_iteration; ++i)
+            for(std::size_t n=0; (l_data = l_source.readBlasMatrix<double>( l_map["inputpath"].as<std::string>(), tools::files::hdf::NATIVE_DOUBLE, n, l_batch)).size1() > 0; n += l_batch)
+                l_kmeans.trainbatch(l_data);
+        
+        std::cout << "throughput: " << l_kmeans.getThroughput() << " datapoints per second" << std::endl;
+    }
 
 
     // create file and write data to hdf
@@ -115,7 +129,7 @@ int main(int p_argc, char* p_argv[])
     std::cout << "/iteration \t\t number of iterations" << std::endl;
 
     if (l_kmeans.getLogging()) {
-        std::cout << "/error \t\t quantization error on each iteration" << std::endl;
+        std::cout << "/error \t\t quantization error on each iteration (on mini-batch training on each chunk)" << std::endl;
         std::cout << "/log<0 to number of iteration-1>/protosos \t\t prototypes on each iteration" << std::endl;
     }
 
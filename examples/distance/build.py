@@ -28,6 +28,7 @@ buildlist = []
 
 if env["withfiles"] :
     buildlist.append( env.Program( target=os.path.join("#build", env["buildtype"], "distance", "ncd"), source=defaultcpp + ["ncd.cpp"] ) )
+    buildlist.append( env.Program( target=os.path.join("#build", env["buildtype"], "distance", "ncdbenchmark"), source=defaultcpp + ["ncdbenchmark.cpp"] ) )
     
 if env["uselocallibrary"] or env["copylibrary"] :
     Depends(buildlist, env.LibraryCopy( os.path.join("#build", env["buildtype"], "distance"), [] ))
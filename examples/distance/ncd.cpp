@@ -24,6 +24,8 @@
 #include <cstdlib>
 #include <machinelearning.h>
 #include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+#include <boost/numeric/ublas/io.hpp>
 #include <boost/program_options/parsers.hpp>
 #include <boost/program_options/variables_map.hpp>
 #include <boost/program_options/options_description.hpp>
@@ -48,6 +50,8 @@ int main(int p_argc, char* p_argv[])
     std::string l_compress;
     std::string l_algorithm;
     std::string l_matrix;
+    bool l_priming;
+    std::size_t l_nearest;
 
     // create CML options with description
     po::options_description l_description("allowed options");
@@ -56,8 +60,10 @@ int main(int p_argc, char* p_argv[])
         ("outfile", po::value<std::string>(), "output HDF5 file")
         ("sources", po::value< std::vector<std::string> >()->multitoken(), "list of text files or directories with text files (all files in the directory will be read and subdirectories will be ignored)")
         ("compress", po::value<std::string>(&l_compress)->default_value("default"), "compression level (allowed values are: default [default], bestspeed or bestcompression)")
-        ("algorithm", po::value<std::string>(&l_algorithm)->default_value("gzip"), "compression algorithm (allowed values are: gzip [default], bzip)")
+        ("algorithm", po::value<std::string>(&l_algorithm)->default_value("gzip"), "compression algorithm (allowed values are: gzip [default], bzip2, xz, zstd, lz4, brotli - xz, zstd, lz4 and brotli must be compiled in)")
+        ("priming", po::value<bool>(&l_priming)->default_value(false), "prime the compressor with the first element of each pair (values: false / 0 [default], true)")
         ("matrix", po::value<std::string>(&l_matrix)->default_value("symmetric"), "structure of the matrix (allowed values are: symmetric [default] or unsymmetric")
+        ("nearest", po::value<std::size_t>(&l_nearest)->default_value(0), "number of nearest neighbours, if it is set, a sparse neighbour graph with MinHash candidates is created instead of the matrix")
     ;
 
     po::variables_map l_map;
@@ -78,11 +84,57 @@ int main(int p_argc, char* p_argv[])
 
 
     // create ncd object
-    distances::ncd<double> l_ncd( (l_algorithm == "gzip") ? distances::ncd<double>::gzip : distances::ncd<double>::bzip2 );
+    distances::ncd<double>::compresstype l_type = distances::ncd<double>::gzip;
+    if ((l_algorithm == "bzip") || (l_algorithm == "bzip2"))
+        l_type = distances::ncd<double>::bzip2;
+    if (l_algorithm == "xz")
+        l_type = distances::ncd<double>::xz;
+    if (l_algorithm == "zstd")
+        l_type = distances::ncd<double>::zstd;
+    if (l_algorithm == "lz4")
+        l_type = distances::ncd<double>::lz4;
+    if (l_algorithm == "brotli")
+        l_type = distances::ncd<double>::brotli;
+    
+    distances::ncd<double> l_ncd( l_type );
     if (l_compress == "bestspeed")
         l_ncd.setCompressionLevel( distances::ncd<double>::bestspeed );
     if (l_compress == "bestcompression")
         l_ncd.setCompressionLevel( distances::ncd<double>::bestcompression );
+    l_ncd.setPriming( l_priming );
+
+
+    // create the sparse neighbour graph and write it in coordinate format
+    if (l_nearest) {
+        const ublas::compressed_matrix<double> l_graph = l_ncd.nearest( l_map["sources"].as< std::vector<std::string> >(), l_nearest, distances::minhash(), true );
+        
+        std::vector<std::size_t> l_row;
+        std::vector<std::size_t> l_column;
+        std::vector<double> l_distance;
+        for(ublas::compressed_matrix<double>::const_iterator1 it = l_graph.begin1(); it != l_graph.end1(); ++it)
+            for(ublas::compressed_matrix<double>::const_iterator2 jt = it.begin(); jt != it.end(); ++jt) {
+                l_row.push_back( jt.index1() );
+                l_column.push_back( jt.index2() );
+                l_distance.push_back( *jt );
+            }
+        
+        // the graph is printed in coordinate format, because the dense output has got N x N elements
+        if (!l_map.count("outfile"))
+            for(std::size_t i=0; i < l_distance.size(); ++i)
+                std::cout << l_row[i] << "\t" << l_column[i] << "\t" << l_distance[i] << std::endl;
+        else if (l_distance.size()) {
+            tools::files::hdf file(l_map["outfile"].as<std::string>(), true);
+            file.writeStdVector<std::size_t>( "/row", l_row, tools::files::hdf::NATIVE_ULONG );
+            file.writeStdVector<std::size_t>( "/column", l_column, tools::files::hdf::NATIVE_ULONG );
+            file.writeStdVector<double>( "/ncd", l_distance, tools::files::hdf::NATIVE_DOUBLE );
+            std::cout << "structure of the output file" << std::endl;
+            std::cout << "/row" << "\t\t" << "row index of each graph element" << std::endl;
+            std::cout << "/column" << "\t\t" << "column index of each graph element" << std::endl;
+            std::cout << "/ncd" << "\t\t" << "distance of each graph element" << std::endl;
+        }
+        
+        return EXIT_SUCCESS;
+    }
 
 
     // create the distance matrix and use the each element of the vector as a filename
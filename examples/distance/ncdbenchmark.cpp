@@ -0,0 +1,222 @@
+/**
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+#include <omp.h>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <machinelearning.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/options_description.hpp>
+
+
+namespace po = boost::program_options;
+using namespace boost::numeric;
+using namespace machinelearning;
+
+
+/** main program, that compares the compression algorithms of the NCD. For each
+ * algorithm and level the symmetric distance matrix is created, the throughput
+ * is measured and if labels are set, the quality is estimated by the leave-one-out
+ * nearest neighbour accuracy and the difference between the mean distance of different
+ * and equal labels
+ * @param p_argc number of arguments
+ * @param p_argv arguments
+ **/
+int main(int p_argc, char* p_argv[])
+{
+    #ifdef MACHINELEARNING_MULTILANGUAGE
+    tools::language::bindings::bind();
+    #endif
+    
+    bool l_priming;
+    
+    // create CML options with description
+    po::options_description l_description("allowed options");
+    l_description.add_options()
+        ("help", "produce help message")
+        ("sources", po::value< std::vector<std::string> >()->multitoken(), "list of text files (e.g. the output of the source examples)")
+        ("labels", po::value< std::vector<std::string> >()->multitoken(), "list of labels for each source file (e.g. the newsgroup name) for estimating the quality")
+        ("algorithms", po::value< std::vector<std::string> >()->multitoken(), "list of compression algorithms (allowed values are: gzip, bzip2, xz, zstd, lz4, brotli / default all)")
+        ("priming", po::value<bool>(&l_priming)->default_value(false), "prime the compressor with the first element of each pair (values: false / 0 [default], true)")
+        ("compress", po::value< std::vector<std::string> >()->multitoken(), "list of compression levels (allowed values are: bestspeed, default, bestcompression or the integer level of the algorithm / default bestspeed, default, bestcompression)")
+    ;
+    
+    po::variables_map l_map;
+    po::positional_options_description l_input;
+    po::store(po::command_line_parser(p_argc, p_argv).options(l_description).positional(l_input).run(), l_map);
+    po::notify(l_map);
+    
+    if (l_map.count("help")) {
+        std::cout << l_description << std::endl;
+        return EXIT_SUCCESS;
+    }
+    
+    if (!l_map.count("sources"))  {
+        std::cerr << "[--sources] must be set" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    const std::vector<std::string> l_sources = l_map["sources"].as< std::vector<std::string> >();
+    const std::vector<std::string> l_labels  = l_map.count("labels") ? l_map["labels"].as< std::vector<std::string> >() : std::vector<std::string>();
+    if ((!l_labels.empty()) && (l_labels.size() != l_sources.size())) {
+        std::cerr << "number of labels must be equal to the number of sources" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    std::vector<std::string> l_algorithms;
+    if (l_map.count("algorithms"))
+        l_algorithms = l_map["algorithms"].as< std::vector<std::string> >();
+    else {
+        l_algorithms.push_back("gzip");
+        l_algorithms.push_back("bzip2");
+        l_algorithms.push_back("xz");
+        l_algorithms.push_back("zstd");
+        l_algorithms.push_back("lz4");
+        l_algorithms.push_back("brotli");
+    }
+    
+    std::vector<std::string> l_levels;
+    if (l_map.count("compress"))
+        l_levels = l_map["compress"].as< std::vector<std::string> >();
+    else {
+        l_levels.push_back("bestspeed");
+        l_levels.push_back("default");
+        l_levels.push_back("bestcompression");
+    }
+    
+    // unknown values are rejected, otherwise the default would be benchmarked
+    for(std::size_t n=0; n < l_algorithms.size(); ++n)
+        if ( (l_algorithms[n] != "gzip") && (l_algorithms[n] != "bzip2") && (l_algorithms[n] != "xz") &&
+             (l_algorithms[n] != "zstd") && (l_algorithms[n] != "lz4") && (l_algorithms[n] != "brotli") ) {
+            std::cerr << "algorithm [" << l_algorithms[n] << "] is unknown" << std::endl;
+            return EXIT_FAILURE;
+        }
+    
+    // integer levels are checked by the algorithm, so a level out of range is reported for the algorithm only
+    for(std::size_t n=0; n < l_levels.size(); ++n)
+        if ( (l_levels[n] != "bestspeed") && (l_levels[n] != "default") && (l_levels[n] != "bestcompression") )
+            try {
+                boost::lexical_cast<int>(l_levels[n]);
+            } catch (const boost::bad_lexical_cast&) {
+                std::cerr << "compression level [" << l_levels[n] << "] is unknown" << std::endl;
+                return EXIT_FAILURE;
+            }
+    
+    
+    // determine the number of bytes, that are compressed for one matrix (each pair is compressed in both orders)
+    double l_bytes = 0;
+    for(std::size_t i=0; i < l_sources.size(); ++i) {
+        std::ifstream l_file(l_sources[i].c_str(), std::ifstream::binary | std::ifstream::ate);
+        if (!l_file.is_open()) {
+            std::cerr << "file [" << l_sources[i] << "] can not be opened" << std::endl;
+            return EXIT_FAILURE;
+        }
+        l_bytes += static_cast<double>(l_file.tellg());
+    }
+    l_bytes *= 2*l_sources.size() - 1;
+    
+    
+    std::cout << std::setw(10) << "algorithm" << std::setw(18) << "level" << std::setw(12) << "time [s]" << std::setw(12) << "MB/s";
+    if (!l_labels.empty())
+        std::cout << std::setw(12) << "1-NN" << std::setw(12) << "separation";
+    std::cout << std::endl;
+    
+    for(std::size_t n=0; n < l_algorithms.size(); ++n)
+        for(std::size_t k=0; k < l_levels.size(); ++k) {
+            
+            distances::ncd<double>::compresstype l_type = distances::ncd<double>::gzip;
+            if (l_algorithms[n] == "bzip2")
+                l_type = distances::ncd<double>::bzip2;
+            if (l_algorithms[n] == "xz")
+                l_type = distances::ncd<double>::xz;
+            if (l_algorithms[n] == "zstd")
+                l_type = distances::ncd<double>::zstd;
+            if (l_algorithms[n] == "lz4")
+                l_type = distances::ncd<double>::lz4;
+            if (l_algorithms[n] == "brotli")
+                l_type = distances::ncd<double>::brotli;
+            
+            // create the matrix, algorithms that are not compiled in are rejected by the constructor and skipped
+            ublas::matrix<double> l_distance;
+            double l_time = 0;
+            try {
+                distances::ncd<double> l_ncd( l_type );
+                if (l_levels[k] == "bestspeed")
+                    l_ncd.setCompressionLevel( distances::ncd<double>::bestspeed );
+                else if (l_levels[k] == "bestcompression")
+                    l_ncd.setCompressionLevel( distances::ncd<double>::bestcompression );
+                else if (l_levels[k] != "default")
+                    l_ncd.setCompressionLevel( boost::lexical_cast<int>(l_levels[k]) );
+                l_ncd.setPriming( l_priming );
+                
+                const double l_start = omp_get_wtime();
+                l_distance = l_ncd.symmetric( l_sources, true );
+                l_time     = omp_get_wtime() - l_start;
+            } catch (const exception::runtime& e) {
+                std::cout << std::setw(10) << l_algorithms[n] << std::setw(18) << l_levels[k] << "    " << e.what() << std::endl;
+                continue;
+            }
+            
+            std::cout << std::setw(10) << l_algorithms[n] << std::setw(18) << l_levels[k] << std::setw(12) << std::setprecision(4) << l_time << std::setw(12) << std::setprecision(4) << l_bytes / l_time / 1048576;
+            
+            
+            // quality: leave-one-out nearest neighbour accuracy and mean distance between different minus equal labels
+            if (!l_labels.empty()) {
+                std::size_t l_correct = 0;
+                double l_equal = 0, l_different = 0;
+                std::size_t l_equalcount = 0, l_differentcount = 0;
+                
+                for(std::size_t i=0; i < l_distance.size1(); ++i) {
+                    std::size_t l_nearest = (i == 0) ? 1 : 0;
+                    for(std::size_t j=0; j < l_distance.size2(); ++j) {
+                        if (i == j)
+                            continue;
+                        if (l_distance(i,j) < l_distance(i,l_nearest))
+                            l_nearest = j;
+                        
+                        if (l_labels[i] == l_labels[j]) {
+                            l_equal += l_distance(i,j);
+                            l_equalcount++;
+                        } else {
+                            l_different += l_distance(i,j);
+                            l_differentcount++;
+                        }
+                    }
+                    
+                    if ((l_nearest < l_labels.size()) && (l_labels[i] == l_labels[l_nearest]))
+                        l_correct++;
+                }
+                
+                std::cout << std::setw(12) << std::setprecision(4) << static_cast<double>(l_correct) / l_labels.size();
+                std::cout << std::setw(12) << std::setprecision(4) << ((l_differentcount ? l_different / l_differentcount : 0) - (l_equalcount ? l_equal / l_equalcount : 0));
+            }
+            
+            std::cout << std::endl;
+        }
+    
+    return EXIT_SUCCESS;
+}
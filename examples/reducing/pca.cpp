@@ -47,6 +47,9 @@ int main(int p_argc, char* p_argv[])
 
     // default values
     std::size_t l_dimension;
+    std::size_t l_batch;
+    bool l_randomized;
+    bool l_incremental;
     std::string l_outpath;
 
     // create CML options with description
@@ -58,6 +61,9 @@ int main(int p_argc, char* p_argv[])
         ("outfile", po::value<std::string>(), "output HDF5 file")
         ("outpath", po::value<std::string>(&l_outpath)->default_value("/pca"), "output path within the HDF5 file [default: /pca]")
         ("dimension", po::value<std::size_t>(&l_dimension)->default_value(3), "target dimension [default: 3]")
+        ("randomized", po::value<bool>(&l_randomized)->default_value(false), "'true' for the randomized SVD instead of the full eigen decomposition [default: false]")
+        ("batch", po::value<std::size_t>(&l_batch)->default_value(0), "number of rows of each chunk, the data is read chunk by chunk from the input file with the randomized SVD (0 = read all data) [default: 0]")
+        ("incremental", po::value<bool>(&l_incremental)->default_value(false), "'true' for updating the projection incrementally with each chunk, so the input file is read only once (needs --batch) [default: false]")
     ;
 
     po::variables_map l_map;
@@ -79,9 +85,27 @@ int main(int p_argc, char* p_argv[])
     // read source hdf file
     tools::files::hdf source( l_map["infile"].as<std::string>() );
 
-    // create pca object and map the data
-    dim::pca<double> l_pca( l_dimension );
-    const ublas::matrix<double> l_project = l_pca.map( source.readBlasMatrix<double>( l_map["inpath"].as<std::string>(), tools::files::hdf::NATIVE_DOUBLE) );
+    // create pca object and map the data (on chunks the projection is calculated first and every chunk is projected)
+    dim::pca<double> l_pca( l_dimension, (l_randomized || (l_batch > 0)) ? dim::pca<double>::randomized : dim::pca<double>::full );
+    ublas::matrix<double> l_project;
+    
+    if (l_batch == 0)
+        l_project = l_pca.map( source.readBlasMatrix<double>( l_map["inpath"].as<std::string>(), tools::files::hdf::NATIVE_DOUBLE) );
+    else {
+        const tools::hdfrowblocks<double> l_data( source, l_map["inpath"].as<std::string>(), tools::files::hdf::NATIVE_DOUBLE );
+        
+        if (l_incremental)
+            for(std::size_t i=0; i < l_data.size1(); i += l_batch)
+                l_pca.fitbatch( l_data.getRows(i, l_batch) );
+        else
+            l_pca.fit( l_data, l_batch );
+        
+        l_project.resize( l_data.size1(), l_pca.getProject().size2(), false );
+        for(std::size_t i=0; i < l_data.size1(); i += l_batch) {
+            const ublas::matrix<double> l_chunk = l_pca.transform( l_data.getRows(i, l_batch) );
+            ublas::subrange( l_project, i, i+l_chunk.size1(), 0, l_chunk.size2() ) = l_chunk;
+        }
+    }
 
 
     // create file and write data to hdf
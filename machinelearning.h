@@ -632,9 +632,13 @@
  * @file classifier/lazylearner.hpp lazy learner algorithm
  *
  * @file clustering/clustering.h main header for all clustering algorithms
+ * @file clustering/seeding.hpp k-means++ and k-means|| seeding of the prototypes
+ * @file clustering/convergence.hpp stopping policy (convergence criteria) of the iterative training
+ * @file clustering/observer.hpp observer classes for the training of the clustering classes
  * @file clustering/nonsupervised/clustering.hpp header for nonsupervised abstract clustering classes
  * @file clustering/nonsupervised/kmeans.hpp k-means implementation
  * @file clustering/nonsupervised/neuralgas.hpp neuralgas implemention for real vector space
+ * @file clustering/nonsupervised/online_neuralgas.hpp online (stochastic) neuralgas implementation with mini-batches
  * @file clustering/nonsupervised/relational_neuralgas.hpp neuralgas implemention for distance / relational data
  * @file clustering/nonsupervised/spectralclustering.hpp implementation of the spectral clustering
  * @file clustering/supervised/clustering.hpp header for supervised abstract clustering classes
@@ -650,8 +654,19 @@
  * 
  * @file distances/distances.h main header for all distance structures
  * @file distances/distance.hpp abstract class for distance algorithms
+ * @file distances/vectordistance.hpp abstract class for distances with kernels on contiguous arrays
+ * @file distances/cosine.hpp class for cosine distances
+ * @file distances/mahalanobis.hpp class for mahalanobis distances
  * @file distances/norm/euclid.hpp class for euclidian distances
+ * @file distances/norm/manhattan.hpp class for manhattan (L1) distances
+ * @file distances/norm/chebyshev.hpp class for chebyshev (L-infinity) distances
+ * @file distances/norm/minkowski.hpp class for minkowski (Lp) distances
  * @file distances/ncd.hpp implementation of the normalize compression distance
+ * @file distances/dissimilarity.hpp dissimilarity matrices, that are calculated or read in blocks
+ * @file distances/compression/compressor.hpp compressor backends of the normalize compression distance
+ * @file distances/compression/source.hpp memory-mapped input data of the compressors
+ * @file distances/tiledncd.hpp resumable tiled NCD matrix on a HDF file
+ * @file distances/minhash.hpp MinHash prefilter for the sparse NCD neighbour graph
  *
  * @file errorhandling/exception.hpp header file for exceptions with implemention (forward declaration)
  * @file errorhandling/exception.implementation.hpp file with the exception implementation
@@ -684,7 +699,9 @@
  * @file tools/function.hpp different functions eg. numerical limit checking
  * @file tools/logger.hpp logger implementation (forward declaration)
  * @file tools/logger.implementation.hpp logger implementation
+ * @file tools/rowblocks.hpp classes for reading data matrices in row blocks
  * @file tools/lapack.hpp wrapper class for LAPack calls
+ * @file tools/lanczos.hpp thick-restart Lanczos solver for symmetric (sparse) eigenvalue problems
  * @file tools/matrix.hpp implementation of matrix operations
  * @file tools/vector.hpp implementation of vector operations
  * @file tools/random.hpp random implementation 
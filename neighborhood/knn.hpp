@@ -116,8 +116,9 @@ namespace machinelearning { namespace neighborhood {
     **/
     template<typename T> inline ublas::matrix<std::size_t> knn<T>::get( const ublas::matrix<T>& p_data ) const
     {
-        if (m_knn > p_data.size1())
-            throw exception::runtime(_("knn is greater than datapoints"), *this);
+        // the data point self is not a neighbour, so knn+1 data points are needed
+        if (m_knn >= p_data.size1())
+            throw exception::runtime(_("knn must be less than the number of datapoints"), *this);
         
         
         ublas::symmetric_matrix<T, ublas::upper> l_distance = calculate( p_data );
@@ -127,13 +128,12 @@ namespace machinelearning { namespace neighborhood {
         for(std::size_t i=0; i < l_distance.size1(); ++i) {
             ublas::vector<T> l_vec = static_cast< ublas::vector<T> >(ublas::row(l_distance,i));
             
-            ublas::vector<std::size_t> l_rank = tools::vector::rankIndexVector(l_vec);
+            const ublas::indirect_array<> l_rank = tools::vector::rankIndex(l_vec, m_knn+1);
             
             // index position in [1,knn+1] because we would like to have the neighbours of a data point
             // and rank[0] is index of the data point self (distance is 0) 
-            const ublas::vector_range< ublas::vector<std::size_t> > l_range( l_rank, ublas::range(1, m_knn+1)  );
-            
-            ublas::row(l_index, i) = l_range;
+            for(std::size_t j=0; j < m_knn; ++j)
+                l_index(i, j) = l_rank(j+1);
         }
             
         return l_index;
@@ -148,23 +148,20 @@ namespace machinelearning { namespace neighborhood {
      **/
     template<typename T> inline ublas::matrix<std::size_t> knn<T>::get( const ublas::matrix<T>& p_fix, const ublas::matrix<T>& p_data  ) const
     {
-        if (m_knn > p_data.size1())
+        if (m_knn > p_fix.size1())
             throw exception::runtime(_("knn is greater than datapoints"), *this);
         
         
         ublas::matrix<std::size_t> l_index(p_data.size1(), m_knn);
+        const ublas::matrix<T> l_distances = m_distance.getPairwiseDistance( p_data, p_fix );
         
         for(std::size_t i=0; i < p_data.size1(); ++i) {
-            const ublas::vector<T> l_vec = static_cast< ublas::vector<T> >(ublas::row(p_data, i));
+            ublas::vector<T> l_distance = ublas::row(l_distances, i);
             
-            ublas::vector<T> l_distance(p_fix.size1());
-            for(std::size_t j=0; j < p_fix.size1(); ++j)
-                l_distance(j) = calculateDistance( l_vec, static_cast< ublas::vector<T> >(ublas::row(p_fix, j)) );
+            const ublas::indirect_array<> l_rank = tools::vector::rankIndex(l_distance, m_knn);
             
-            ublas::vector<std::size_t> l_rank = tools::vector::rankIndexVector(l_distance);
-            const ublas::vector_range< ublas::vector<std::size_t> > l_range( l_rank, ublas::range(0, m_knn)  );
-
-            ublas::row(l_index, i) = l_range;
+            for(std::size_t j=0; j < m_knn; ++j)
+                l_index(i, j) = l_rank(j);
         }
         
         return l_index;
@@ -54,6 +54,7 @@ namespace machinelearning { namespace tools { namespace files {
             
             template<typename T> ublas::vector<T> readBlasVector( const std::string&, const bool& = false ) const;
             template<typename T> ublas::matrix<T> readBlasMatrix( const std::string&, const std::string& = ",; \t", const bool& = false ) const;
+            template<typename T> ublas::matrix<T> readBlasMatrix( std::istream&, const std::size_t&, const std::size_t&, const std::string& = ",; \t" ) const;
             std::vector<std::string> readVector( const std::string& ) const;
             template<typename T> void write( const std::string&, const ublas::vector<T>&, const bool& = false ) const;
             template<typename T> void write( const std::string&, const std::vector<T>&, const bool& = false ) const;
@@ -173,6 +174,47 @@ namespace machinelearning { namespace tools { namespace files {
     }
     
     
+    /** reads the next rows of a matrix structure from an opened stream, so large
+     * csv files can be read in chunks (the stream holds the position between the calls).
+     * The returned matrix has less rows if the stream ends and no rows on the end of the stream
+     * @param p_stream input stream
+     * @param p_rows maximum number of rows
+     * @param p_columns number of columns
+     * @param p_separator characters for sperator (default , ; \\t blank)
+     * @return ublas matrix with data
+     **/
+    template<typename T> inline ublas::matrix<T> csv::readBlasMatrix( std::istream& p_stream, const std::size_t& p_rows, const std::size_t& p_columns, const std::string& p_separator ) const
+    {
+        if (p_separator.empty())
+            throw exception::runtime(_("separator can not be empty"), *this);
+        if (p_columns == 0)
+            throw exception::runtime(_("column size must be greater than zero"), *this);
+        
+        ublas::matrix<T> l_mat( p_rows, p_columns, static_cast<T>(0) );
+        std::size_t l_row = 0;
+        std::string l_line;
+        std::vector<std::string> l_splitline;
+        
+        while ((l_row < p_rows) && (std::getline(p_stream, l_line))) {
+            if (l_line.empty())
+                continue;
+            
+            l_splitline.clear();
+            boost::split( l_splitline, l_line, boost::is_any_of(p_separator) );
+            
+            for(std::size_t j=0; (j < p_columns) && (j < l_splitline.size()); ++j)
+                l_mat(l_row,j) = boost::lexical_cast<T>( l_splitline[j] );
+            
+            l_row++;
+        }
+        
+        if (l_row < p_rows)
+            l_mat.resize( l_row, p_columns, true );
+        
+        return l_mat;
+    }
+    
+    
     /** read all lines from csv file to a std::vector
      * @param p_file filename as string
      * @return std::vector
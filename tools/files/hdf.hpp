@@ -27,6 +27,8 @@
 #define __MACHINELEARNING_TOOLS_FILES_HDF_HPP
 
 #include <string>
+#include <limits>
+#include <utility>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/storage.hpp>
@@ -197,24 +199,34 @@ namespace machinelearning { namespace tools { namespace files {
             std::size_t getFilesize( void ) const;
             void remove( const std::string& ) const;
             bool pathexists( const std::string&, const bool& = true ) const;
+            std::pair<std::size_t, std::size_t> getMatrixSize( const std::string& ) const;
+            bool attributeexists( const std::string&, const std::string& ) const;
             
             
             template<typename T> ublas::matrix<T> readBlasMatrix( const std::string&, const datatype& ) const;
+            template<typename T> ublas::matrix<T> readBlasMatrix( const std::string&, const datatype&, const std::size_t&, const std::size_t& ) const;
+            template<typename T> ublas::matrix<T> readBlasMatrix( const std::string&, const datatype&, const std::size_t&, const std::size_t&, const std::size_t&, const std::size_t& ) const;
             template<typename T> ublas::vector<T> readBlasVector( const std::string&, const datatype& ) const;
             template<typename T> std::vector<T> readStdVector( const std::string&, const datatype& ) const;
             template<typename T> T readValue( const std::string&, const datatype& ) const;
+            template<typename T> T readAttribute( const std::string&, const std::string&, const datatype& ) const;
             
             std::string readString( const std::string& ) const;
             std::vector<std::string> readStringVector( const std::string& ) const;
             
             
             template<typename T> void writeBlasMatrix( const std::string&, const ublas::matrix<T>&, const datatype& ) const;
+            template<typename T> void writeBlasMatrix( const std::string&, const ublas::matrix<T>&, const datatype&, const std::size_t&, const std::size_t& ) const;
             template<typename T> void writeBlasVector( const std::string&, const ublas::vector<T>&, const datatype& ) const;
             template<typename T> void writeStdVector( const std::string&, const std::vector<T>&, const datatype& ) const;
             template<typename T> void writeValue( const std::string&, const T&, const datatype& ) const;
+            template<typename T> void writeAttribute( const std::string&, const std::string&, const T&, const datatype& ) const;
             
             void writeString( const std::string&, const std::string& ) const;
             void writeStringVector( const std::string&, const std::vector<std::string>& ) const;
+            
+            void createChunkedMatrix( const std::string&, const std::size_t&, const std::size_t&, const datatype&, const std::size_t&, const unsigned int& = 6 ) const;
+            void extendMatrix( const std::string&, const std::size_t&, const std::size_t& ) const;
         
         
         private :
@@ -333,6 +345,50 @@ namespace machinelearning { namespace tools { namespace files {
     }
     
     
+    /** returns the size of a matrix dataset without reading the data
+     * @param p_path dataset name
+     * @return pair with the number of rows and columns
+     **/
+    inline std::pair<std::size_t, std::size_t> hdf::getMatrixSize( const std::string& p_path ) const
+    {
+        if (!isAbsolutePath(p_path))
+            throw exception::runtime(_("path is not an absolute path"));
+        
+        H5::DataSet   l_dataset   = m_file.openDataSet( p_path.c_str() );
+        H5::DataSpace l_dataspace = l_dataset.getSpace();
+        
+        if (l_dataspace.getSimpleExtentNdims() != 2)
+            throw exception::runtime(_("dataset must be two-dimensional"));
+        
+        // first element is column size, second row size
+        hsize_t l_size[2];
+        l_dataspace.getSimpleExtentDims( l_size );
+        
+        l_dataspace.close();
+        l_dataset.close();
+        
+        return std::pair<std::size_t, std::size_t>( static_cast<std::size_t>(l_size[1]), static_cast<std::size_t>(l_size[0]) );
+    }
+    
+    
+    /** returns the bool if an attribute of a dataset exists
+     * @param p_path dataset path & name
+     * @param p_name attribute name
+     * @return boolean
+     **/
+    inline bool hdf::attributeexists( const std::string& p_path, const std::string& p_name ) const
+    {
+        if (!isAbsolutePath(p_path))
+            throw exception::runtime(_("path is not an absolute path"));
+        
+        H5::DataSet l_dataset = m_file.openDataSet( p_path.c_str() );
+        const bool l_exists   = l_dataset.attrExists( p_name.c_str() );
+        l_dataset.close();
+        
+        return l_exists;
+    }
+    
+    
     /** reads a matrix with convert to blas matrix
      * @param p_path dataset name
      * @param p_datatype datatype for reading data
@@ -371,6 +427,82 @@ namespace machinelearning { namespace tools { namespace files {
     
     
     
+    /** reads a block of rows of a matrix with convert to blas matrix, so large
+     * datasets can be read in chunks. The returned matrix has less rows if the
+     * block exceeds the dataset and no rows if the start row is behind the end
+     * @param p_path dataset name
+     * @param p_datatype datatype for reading data
+     * @param p_start index of the first row
+     * @param p_rows number of rows
+     * @return ublas matrix
+     **/ 
+    template<typename T> inline ublas::matrix<T> hdf::readBlasMatrix( const std::string& p_path, const datatype& p_datatype, const std::size_t& p_start, const std::size_t& p_rows ) const
+    {
+        return readBlasMatrix<T>( p_path, p_datatype, p_start, p_rows, 0, std::numeric_limits<std::size_t>::max() );
+    }
+    
+    
+    
+    /** reads a block (tile) of a matrix with convert to blas matrix. The returned
+     * matrix is cut at the border of the dataset and has no rows if the start row
+     * is behind the end
+     * @param p_path dataset name
+     * @param p_datatype datatype for reading data
+     * @param p_rowstart index of the first row
+     * @param p_rows number of rows
+     * @param p_colstart index of the first column
+     * @param p_cols number of columns
+     * @return ublas matrix
+     **/ 
+    template<typename T> inline ublas::matrix<T> hdf::readBlasMatrix( const std::string& p_path, const datatype& p_datatype, const std::size_t& p_rowstart, const std::size_t& p_rows, const std::size_t& p_colstart, const std::size_t& p_cols ) const
+    {
+        if (!isAbsolutePath(p_path))
+            throw exception::runtime(_("path is not an absolute path"));
+        
+        H5::DataSet   l_dataset   = m_file.openDataSet( p_path.c_str() );
+        H5::DataSpace l_dataspace = l_dataset.getSpace();
+        
+        // check datasetdimension
+        if (l_dataspace.getSimpleExtentNdims() != 2)
+            throw exception::runtime(_("dataset must be two-dimensional"));
+        if (!l_dataspace.isSimple())
+            throw exception::runtime(_("dataset must be a simple datatype"));
+        
+        // read matrix size (first element is column size, second row size)
+        hsize_t l_size[2];
+        l_dataspace.getSimpleExtentDims( l_size );
+        
+        if ((!l_size[1]) || (!l_size[0]))
+            throw exception::runtime(_("dimension need not be zero"));
+        
+        if (p_colstart >= l_size[0])
+            throw exception::runtime(_("column index is out of range"));
+        
+        const hsize_t l_cols = std::min(static_cast<hsize_t>(p_cols), l_size[0]-p_colstart);
+        if ((p_rowstart >= l_size[1]) || (p_rows == 0)) {
+            l_dataspace.close();
+            l_dataset.close();
+            return ublas::matrix<T>(0, l_cols);
+        }
+        
+        // select the block within the file (rows are the second dimension)
+        const hsize_t l_offset[2] = { p_colstart, p_rowstart };
+        const hsize_t l_count[2]  = { l_cols, std::min(static_cast<hsize_t>(p_rows), l_size[1]-p_rowstart) };
+        l_dataspace.selectHyperslab( H5S_SELECT_SET, l_count, l_offset );
+        H5::DataSpace l_memspace( 2, l_count );
+        
+        // read data (read column oriantated, because data order is changed)
+        ublas::matrix<T, ublas::column_major> l_mat(l_count[1], l_count[0]);
+        l_dataset.read( &(l_mat.data()[0]), getHDFType(p_datatype), l_memspace, l_dataspace );
+        
+        l_memspace.close();
+        l_dataspace.close();
+        l_dataset.close();
+        return l_mat;
+    }
+    
+    
+    
     /** reads a vector with convert to blas vector
      * @param p_path dataset path & name
      * @param p_datatype datatype for reading data
@@ -478,6 +610,32 @@ namespace machinelearning { namespace tools { namespace files {
     }
     
     
+    /** reads a single value attribute of a dataset
+     * @param p_path dataset path & name
+     * @param p_name attribute name
+     * @param p_datatype datatype for reading data
+     * @return single value
+     **/ 
+    template<typename T> inline T hdf::readAttribute( const std::string& p_path, const std::string& p_name, const datatype& p_datatype ) const
+    {
+        if (!isAbsolutePath(p_path))
+            throw exception::runtime(_("path is not an absolute path"));
+        
+        H5::DataSet   l_dataset   = m_file.openDataSet( p_path.c_str() );
+        H5::Attribute l_attribute = l_dataset.openAttribute( p_name.c_str() );
+        
+        if (l_attribute.getSpace().getSimpleExtentNpoints() != 1)
+            throw exception::runtime(_("element is not a single value"));
+        
+        T l_value;
+        l_attribute.read( getHDFType(p_datatype), &l_value );
+        
+        l_attribute.close();
+        l_dataset.close();
+        return l_value;
+    }
+    
+    
     /** reads a string array from HDF file into a std::vector
      * @todo switch array to a vector, because it creates pedantic errors
      * @param p_path path to element
@@ -669,6 +827,52 @@ namespace machinelearning { namespace tools { namespace files {
     }
     
     
+    /** writes a blas matrix as block into an existing matrix dataset, so
+     * large datasets can be written in tiles
+     * @param p_path dataset path & name
+     * @param p_dataset matrixdata
+     * @param p_datatype datatype for writing data
+     * @param p_rowstart index of the first row within the dataset
+     * @param p_colstart index of the first column within the dataset
+     **/
+    template<typename T> inline void hdf::writeBlasMatrix( const std::string& p_path, const ublas::matrix<T>& p_dataset, const datatype& p_datatype, const std::size_t& p_rowstart, const std::size_t& p_colstart ) const
+    {
+        if ((!p_dataset.size1()) || (!p_dataset.size2()))
+            throw exception::runtime(_("can not write empty data"));
+        
+        if (!isAbsolutePath(p_path))
+            throw exception::runtime(_("path is not an absolute path"));
+        
+        H5::DataSet   l_dataset   = m_file.openDataSet( p_path.c_str() );
+        H5::DataSpace l_dataspace = l_dataset.getSpace();
+        
+        // check datasetdimension
+        if (l_dataspace.getSimpleExtentNdims() != 2)
+            throw exception::runtime(_("dataset must be two-dimensional"));
+        
+        // read matrix size (first element is column size, second row size)
+        hsize_t l_size[2];
+        l_dataspace.getSimpleExtentDims( l_size );
+        
+        if ((p_colstart + p_dataset.size2() > l_size[0]) || (p_rowstart + p_dataset.size1() > l_size[1]))
+            throw exception::runtime(_("block exceeds the dataset"));
+        
+        // select the block within the file (rows are the second dimension)
+        const hsize_t l_offset[2] = { p_colstart, p_rowstart };
+        const hsize_t l_count[2]  = { p_dataset.size2(), p_dataset.size1() };
+        l_dataspace.selectHyperslab( H5S_SELECT_SET, l_count, l_offset );
+        H5::DataSpace l_memspace( 2, l_count );
+        
+        // write data (column oriantated, because data order is changed)
+        const ublas::matrix<T, ublas::column_major> l_matrix( p_dataset );
+        l_dataset.write( &(l_matrix.data()[0]), getHDFType(p_datatype), l_memspace, l_dataspace );
+        
+        l_memspace.close();
+        l_dataspace.close();
+        l_dataset.close();
+    }
+    
+    
     /** write a blas vector to hdf file
      * @param p_path dataset path & name
      * @param p_dataset vectordata
@@ -735,6 +939,107 @@ namespace machinelearning { namespace tools { namespace files {
     }
     
     
+    /** writes a single value attribute to a dataset, an existing attribute
+     * is overwritten in place
+     * @param p_path dataset path & name
+     * @param p_name attribute name
+     * @param p_value value
+     * @param p_datatype datatype for writing data
+     **/
+    template<typename T> inline void hdf::writeAttribute( const std::string& p_path, const std::string& p_name, const T& p_value, const datatype& p_datatype ) const
+    {
+        if (!isAbsolutePath(p_path))
+            throw exception::runtime(_("path is not an absolute path"));
+        
+        H5::DataSet   l_dataset = m_file.openDataSet( p_path.c_str() );
+        H5::Attribute l_attribute;
+        
+        if (l_dataset.attrExists( p_name.c_str() ))
+            l_attribute = l_dataset.openAttribute( p_name.c_str() );
+        else
+            l_attribute = l_dataset.createAttribute( p_name.c_str(), getHDFType(p_datatype), H5::DataSpace(H5S_SCALAR) );
+        
+        l_attribute.write( getHDFType(p_datatype), &p_value );
+        
+        l_attribute.close();
+        l_dataset.close();
+    }
+    
+    
+    /** creates an empty matrix dataset, that is stored in chunks and can be
+     * extended, so it can be written blockwise
+     * @note the chunk should be the block size of the writing, a chunk must be smaller than 4 GB
+     * @param p_path dataset path & name
+     * @param p_rows number of rows
+     * @param p_cols number of columns
+     * @param p_datatype datatype of the dataset
+     * @param p_chunk number of rows / columns of a chunk
+     * @param p_deflate deflate level of the chunks [0,9] (zero disables the compression)
+     **/
+    inline void hdf::createChunkedMatrix( const std::string& p_path, const std::size_t& p_rows, const std::size_t& p_cols, const datatype& p_datatype, const std::size_t& p_chunk, const unsigned int& p_deflate ) const
+    {
+        if ((!p_rows) || (!p_cols) || (!p_chunk))
+            throw exception::runtime(_("dimension need not be zero"));
+        if (p_deflate > 9)
+            throw exception::runtime(_("deflate level must be in [0,9]"));
+        
+        if (!isAbsolutePath(p_path))
+            throw exception::runtime(_("path is not an absolute path"));
+        
+        // first element is column size, second row size
+        const hsize_t l_size[2]    = { p_cols, p_rows };
+        const hsize_t l_maxsize[2] = { H5S_UNLIMITED, H5S_UNLIMITED };
+        const hsize_t l_chunk[2]   = { p_chunk, p_chunk };
+        
+        H5::DSetCreatPropList l_property;
+        l_property.setChunk( 2, l_chunk );
+        if (p_deflate)
+            l_property.setDeflate( p_deflate );
+        
+        H5::DataSet l_dataset;
+        H5::DataSpace l_dataspace( 2, l_size, l_maxsize );
+        std::vector<H5::Group> l_groups;
+        const std::string l_path = createPath( p_path, l_groups );
+        
+        if (!l_groups.size())
+            l_dataset = m_file.createDataSet( l_path.c_str(), getHDFType(p_datatype), l_dataspace, l_property );
+        else
+            l_dataset = l_groups[l_groups.size()-1].createDataSet( l_path.c_str(), getHDFType(p_datatype), l_dataspace, l_property );
+        
+        l_property.close();
+        closeSpace(l_groups, l_dataset, l_dataspace);
+    }
+    
+    
+    /** extends a chunked matrix dataset, new elements are set to zero
+     * @param p_path dataset path & name
+     * @param p_rows new number of rows
+     * @param p_cols new number of columns
+     **/
+    inline void hdf::extendMatrix( const std::string& p_path, const std::size_t& p_rows, const std::size_t& p_cols ) const
+    {
+        if (!isAbsolutePath(p_path))
+            throw exception::runtime(_("path is not an absolute path"));
+        
+        H5::DataSet   l_dataset   = m_file.openDataSet( p_path.c_str() );
+        H5::DataSpace l_dataspace = l_dataset.getSpace();
+        
+        if (l_dataspace.getSimpleExtentNdims() != 2)
+            throw exception::runtime(_("dataset must be two-dimensional"));
+        
+        hsize_t l_size[2];
+        l_dataspace.getSimpleExtentDims( l_size );
+        l_dataspace.close();
+        
+        if ((p_cols < l_size[0]) || (p_rows < l_size[1]))
+            throw exception::runtime(_("dataset can not be shrunk"));
+        
+        const hsize_t l_newsize[2] = { p_cols, p_rows };
+        l_dataset.extend( l_newsize );
+        l_dataset.close();
+    }
+    
+    
     /** close the dataspace and the groups in the right order
      * @param p_groups vector with group information
      * @param p_dataset dataset
@@ -863,7 +1168,7 @@ namespace machinelearning { namespace tools { namespace files {
                 }
                 p_groups.push_back( l_group );
             }
-            return *l_path.end();
+            return l_path.back();
         }
         
         throw exception::runtime(_("can not create path structure"));
@@ -0,0 +1,352 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+#ifndef __MACHINELEARNING_TOOLS_LANCZOS_HPP
+#define __MACHINELEARNING_TOOLS_LANCZOS_HPP
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <boost/function.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/vector_proxy.hpp>
+#include <boost/numeric/ublas/operation.hpp>
+
+#include "../errorhandling/exception.hpp"
+#include "language/language.h"
+#include "vector.hpp"
+#include "lapack.hpp"
+
+
+namespace machinelearning { namespace tools {
+    
+    #ifndef SWIG
+    namespace ublas     = boost::numeric::ublas;
+    #endif
+    
+    
+    /** class for the iterative eigen decomposition of large symmetric matrices with the thick-restart
+     * Lanczos algorithm. The matrix is only used by matrix-vector products, so sparse matrices or implicit
+     * matrices (callback) can be used and the memory is N x (Krylov subspace size). The basis is fully
+     * reorthogonalized, the eigen decomposition of the small projected matrix uses LAPACK
+     * @see http://en.wikipedia.org/wiki/Lanczos_algorithm
+     * @see Wu & Simon, Thick-Restart Lanczos Method for Large Symmetric Eigenvalue Problems, SIAM J. Matrix Anal. Appl. 22(2), 2000
+     **/
+    class lanczos
+    {
+        
+        public :
+        
+            template<typename T> static bool eigen( const boost::function<void (const ublas::vector<T>&, ublas::vector<T>&)>&, const std::size_t&, ublas::vector<T>&, ublas::matrix<T>&, const std::size_t&, const lapack::spectrum& = lapack::largest, const T& = std::sqrt(std::numeric_limits<T>::epsilon()), const std::size_t& = 1000, const std::size_t& = 0 );
+            template<typename T> static bool eigen( const ublas::compressed_matrix<T>&, ublas::vector<T>&, ublas::matrix<T>&, const std::size_t&, const lapack::spectrum& = lapack::largest, const T& = std::sqrt(std::numeric_limits<T>::epsilon()), const std::size_t& = 1000, const std::size_t& = 0 );
+            template<typename T> static bool eigen( const ublas::matrix<T>&, ublas::vector<T>&, ublas::matrix<T>&, const std::size_t&, const lapack::spectrum& = lapack::largest, const T& = std::sqrt(std::numeric_limits<T>::epsilon()), const std::size_t& = 1000, const std::size_t& = 0 );
+        
+        
+        private :
+        
+            /** functor for the matrix-vector product of a dense matrix, the row-major data
+             * is used directly, because the generic ublas product is slow
+             **/
+            template<typename T> class denseproduct
+            {
+                public :
+                
+                    denseproduct( const ublas::matrix<T>& p_matrix ) : m_matrix(p_matrix) {}
+                
+                    void operator()( const ublas::vector<T>& p_in, ublas::vector<T>& p_out ) const
+                    {
+                        p_out.resize( m_matrix.size1(), false );
+                        const std::size_t l_size = m_matrix.size2();
+                        const T* l_data          = m_matrix.data().begin();
+                        
+                        #pragma omp parallel for shared(p_in, p_out)
+                        for(std::size_t i=0; i < m_matrix.size1(); ++i) {
+                            const T* l_row = l_data + i*l_size;
+                            T l_sum = 0;
+                            for(std::size_t j=0; j < l_size; ++j)
+                                l_sum += l_row[j] * p_in(j);
+                            p_out(i) = l_sum;
+                        }
+                    }
+                
+                private :
+                
+                    /** matrix **/
+                    const ublas::matrix<T>& m_matrix;
+            };
+        
+        
+            /** functor for the matrix-vector product of a sparse matrix with compressed row storage **/
+            template<typename T> class sparseproduct
+            {
+                public :
+                
+                    sparseproduct( const ublas::compressed_matrix<T>& p_matrix ) : m_matrix(p_matrix) {}
+                
+                    void operator()( const ublas::vector<T>& p_in, ublas::vector<T>& p_out ) const
+                    {
+                        p_out.resize( m_matrix.size1(), false );
+                        
+                        // only the first filled1-1 rows have got a valid row pointer, all other rows are empty
+                        const std::size_t l_rows = std::min( m_matrix.size1(), m_matrix.filled1() > 0 ? m_matrix.filled1()-1 : 0 );
+                        
+                        #pragma omp parallel for shared(p_in, p_out)
+                        for(std::size_t i=0; i < m_matrix.size1(); ++i) {
+                            T l_sum = 0;
+                            if (i < l_rows)
+                                for(std::size_t j=m_matrix.index1_data()[i]; j < m_matrix.index1_data()[i+1]; ++j)
+                                    l_sum += m_matrix.value_data()[j] * p_in(m_matrix.index2_data()[j]);
+                            p_out(i) = l_sum;
+                        }
+                    }
+                
+                private :
+                
+                    /** matrix **/
+                    const ublas::compressed_matrix<T>& m_matrix;
+            };
+        
+        
+            template<typename T> static T orthogonalize( const ublas::matrix<T, ublas::column_major>&, const std::size_t&, ublas::vector<T>&, ublas::vector<T>& );
+            template<typename T> static void setRandomBasisVector( ublas::matrix<T, ublas::column_major>&, const std::size_t& );
+        
+    };
+    
+    
+    
+    /** orthogonalize a vector against the first basis vectors with classical Gram-Schmidt, which is
+     * run twice for numerical stability
+     * @param p_basis basis matrix (every column is a orthonormal vector)
+     * @param p_count number of basis vectors
+     * @param p_vec vector, that is orthogonalized
+     * @param p_coefficient projection coefficients of the vector on the basis
+     * @return norm of the orthogonalized vector
+     **/
+    template<typename T> inline T lanczos::orthogonalize( const ublas::matrix<T, ublas::column_major>& p_basis, const std::size_t& p_count, ublas::vector<T>& p_vec, ublas::vector<T>& p_coefficient )
+    {
+        // the basis is column-major, so every basis vector is a contiguous array
+        const std::size_t l_size = p_basis.size1();
+        const T* l_basis         = p_basis.data().begin();
+        
+        p_coefficient = ublas::zero_vector<T>( p_count );
+        ublas::vector<T> l_projection( p_count );
+        
+        for(std::size_t n=0; n < 2; ++n) {
+            
+            #pragma omp parallel for shared(l_projection)
+            for(std::size_t i=0; i < p_count; ++i) {
+                const T* l_column = l_basis + i*l_size;
+                T l_sum = 0;
+                for(std::size_t j=0; j < l_size; ++j)
+                    l_sum += l_column[j] * p_vec(j);
+                l_projection(i) = l_sum;
+            }
+            
+            #pragma omp parallel for shared(p_vec)
+            for(std::size_t j=0; j < l_size; ++j) {
+                T l_sum = 0;
+                for(std::size_t i=0; i < p_count; ++i)
+                    l_sum += l_basis[i*l_size + j] * l_projection(i);
+                p_vec(j) -= l_sum;
+            }
+            
+            p_coefficient += l_projection;
+        }
+        
+        return ublas::norm_2(p_vec);
+    }
+    
+    
+    
+    /** sets a basis vector to a random vector, that is orthonormal to the previous basis vectors (used if
+     * the Krylov subspace is invariant)
+     * @param p_basis basis matrix
+     * @param p_index index of the basis vector
+     **/
+    template<typename T> inline void lanczos::setRandomBasisVector( ublas::matrix<T, ublas::column_major>& p_basis, const std::size_t& p_index )
+    {
+        ublas::vector<T> l_coefficient;
+        
+        for(;;) {
+            ublas::vector<T> l_vec = vector::random<T>( p_basis.size1() ) - ublas::scalar_vector<T>( p_basis.size1(), static_cast<T>(0.5) );
+            const T l_norm = orthogonalize( p_basis, p_index, l_vec, l_coefficient );
+            
+            if (l_norm > std::sqrt(std::numeric_limits<T>::epsilon())) {
+                ublas::column(p_basis, p_index) = l_vec / l_norm;
+                return;
+            }
+        }
+    }
+    
+    
+    
+    /** calculates the k largest or smallest eigenvalues and eigenvectors of a symmetric matrix, that is
+     * given by the matrix-vector product. The template parameter must be set on the call, because it
+     * can not be deduced from the function object
+     * @param p_product function object, that calculates the product of the matrix and the first argument and writes it into the second argument
+     * @param p_size number of rows / columns of the matrix
+     * @param p_eigval blas vector for eigenvalues (largest first or smallest first) [initialisation is not needed]
+     * @param p_eigvec blas matrix for orthonormal eigenvectors (every column is a eigenvector) [initialisation is not needed]
+     * @param p_count number of eigenpairs
+     * @param p_which largest or smallest part of the spectrum
+     * @param p_tolerance residual tolerance ||A*x - lambda*x|| relative to the largest absolute eigenvalue
+     * @param p_restarts maximum number of restarts
+     * @param p_basissize size of the Krylov subspace (zero determines the size by the number of eigenpairs)
+     * @return true if all eigenpairs are converged
+     **/
+    template<typename T> inline bool lanczos::eigen( const boost::function<void (const ublas::vector<T>&, ublas::vector<T>&)>& p_product, const std::size_t& p_size, ublas::vector<T>& p_eigval, ublas::matrix<T>& p_eigvec, const std::size_t& p_count, const lapack::spectrum& p_which, const T& p_tolerance, const std::size_t& p_restarts, const std::size_t& p_basissize )
+    {
+        if (p_count == 0)
+            throw exception::runtime(_("number of eigenpairs must be greater than zero"));
+        if (p_count > p_size)
+            throw exception::runtime(_("number of eigenpairs must be less or equal than the matrix size"));
+        if (p_tolerance <= 0)
+            throw exception::runtime(_("tolerance must be greater than zero"));
+        
+        if ((p_basissize != 0) && (p_basissize <= p_count) && (p_count < p_size))
+            throw exception::runtime(_("size of the Krylov subspace must be greater than the number of eigenpairs"));
+        
+        // size of the Krylov subspace and number of Ritz vectors, that are kept on a restart
+        const std::size_t l_basissize = std::min( p_size, (p_basissize == 0) ? std::max(2*p_count, p_count+20) : p_basissize );
+        const std::size_t l_keep      = std::min( l_basissize-1, p_count + (l_basissize-p_count)/2 );
+        
+        ublas::matrix<T, ublas::column_major> l_basis( p_size, l_basissize );
+        ublas::matrix<T> l_projection( l_basissize, l_basissize, 0 );
+        ublas::vector<T> l_vec( p_size );
+        ublas::vector<T> l_residual( p_size );
+        ublas::vector<T> l_coefficient;
+        ublas::vector<T> l_ritzval;
+        ublas::matrix<T> l_ritzvec;
+        
+        setRandomBasisVector( l_basis, 0 );
+        
+        std::size_t l_start = 0;
+        T l_beta            = 0;
+        bool l_converged    = false;
+        
+        for(std::size_t n=0; ; ++n) {
+            
+            // extend the Krylov basis, the projection A*v_j is orthogonalized against all basis vectors
+            for(std::size_t j=l_start; j < l_basissize; ++j) {
+                l_vec = ublas::column(l_basis, j);
+                p_product( l_vec, l_residual );
+                if (l_residual.size() != p_size)
+                    throw exception::runtime(_("size of the matrix-vector product is not equal to the matrix size"));
+                
+                l_beta = orthogonalize( l_basis, j+1, l_residual, l_coefficient );
+                for(std::size_t i=0; i <= j; ++i)
+                    l_projection(i, j) = l_projection(j, i) = l_coefficient(i);
+                
+                if (j+1 < l_basissize) {
+                    if (l_beta > std::numeric_limits<T>::epsilon() * std::max( static_cast<T>(1), ublas::norm_inf(l_coefficient) ))
+                        ublas::column(l_basis, j+1) = l_residual / l_beta;
+                    else
+                        setRandomBasisVector( l_basis, j+1 );
+                }
+            }
+            
+            
+            // Ritz pairs of the projected matrix (wanted pairs first), the residual norm of a Ritz pair is |beta * s(last,i)|
+            lapack::eigensymmetric( l_projection, l_ritzval, l_ritzvec, 0, p_which );
+            const T l_norm = std::max( std::fabs(l_ritzval(0)), std::fabs(l_ritzval(l_ritzval.size()-1)) );
+            
+            l_converged = true;
+            for(std::size_t i=0; (i < p_count) && l_converged; ++i)
+                l_converged = std::fabs(l_beta * l_ritzvec(l_basissize-1, i)) <= p_tolerance * l_norm;
+            
+            if (l_converged || (n+1 >= p_restarts))
+                break;
+            
+            
+            // thick restart: the basis is set to the best Ritz vectors and the residual vector, so the projected
+            // matrix is the diagonal of the Ritz values and the coupling to the residual is calculated on the next step
+            const ublas::matrix<T> l_kept = ublas::prod( l_basis, ublas::subrange(l_ritzvec, 0, l_basissize, 0, l_keep) );
+            ublas::subrange(l_basis, 0, p_size, 0, l_keep) = l_kept;
+            
+            if (l_beta > std::numeric_limits<T>::epsilon() * std::max(static_cast<T>(1), l_norm))
+                ublas::column(l_basis, l_keep) = l_residual / l_beta;
+            else
+                setRandomBasisVector( l_basis, l_keep );
+            
+            l_projection = ublas::zero_matrix<T>( l_basissize, l_basissize );
+            for(std::size_t i=0; i < l_keep; ++i)
+                l_projection(i, i) = l_ritzval(i);
+            
+            l_start = l_keep;
+        }
+        
+        
+        p_eigval = ublas::subrange( l_ritzval, static_cast<std::size_t>(0), p_count );
+        p_eigvec = ublas::prod( l_basis, ublas::subrange(l_ritzvec, 0, l_basissize, 0, p_count) );
+        
+        return l_converged;
+    }
+    
+    
+    
+    /** calculates the k largest or smallest eigenvalues and eigenvectors of a symmetric sparse matrix
+     * @param p_matrix symmetric sparse matrix
+     * @param p_eigval blas vector for eigenvalues (largest first or smallest first) [initialisation is not needed]
+     * @param p_eigvec blas matrix for orthonormal eigenvectors (every column is a eigenvector) [initialisation is not needed]
+     * @param p_count number of eigenpairs
+     * @param p_which largest or smallest part of the spectrum
+     * @param p_tolerance residual tolerance ||A*x - lambda*x|| relative to the largest absolute eigenvalue
+     * @param p_restarts maximum number of restarts
+     * @param p_basissize size of the Krylov subspace (zero determines the size by the number of eigenpairs)
+     * @return true if all eigenpairs are converged
+     **/
+    template<typename T> inline bool lanczos::eigen( const ublas::compressed_matrix<T>& p_matrix, ublas::vector<T>& p_eigval, ublas::matrix<T>& p_eigvec, const std::size_t& p_count, const lapack::spectrum& p_which, const T& p_tolerance, const std::size_t& p_restarts, const std::size_t& p_basissize )
+    {
+        if (p_matrix.size1() != p_matrix.size2())
+            throw exception::runtime(_("matrix must be square"));
+        
+        return eigen<T>( sparseproduct<T>(p_matrix), p_matrix.size1(), p_eigval, p_eigvec, p_count, p_which, p_tolerance, p_restarts, p_basissize );
+    }
+    
+    
+    
+    /** calculates the k largest or smallest eigenvalues and eigenvectors of a symmetric dense matrix
+     * @param p_matrix symmetric matrix
+     * @param p_eigval blas vector for eigenvalues (largest first or smallest first) [initialisation is not needed]
+     * @param p_eigvec blas matrix for orthonormal eigenvectors (every column is a eigenvector) [initialisation is not needed]
+     * @param p_count number of eigenpairs
+     * @param p_which largest or smallest part of the spectrum
+     * @param p_tolerance residual tolerance ||A*x - lambda*x|| relative to the largest absolute eigenvalue
+     * @param p_restarts maximum number of restarts
+     * @param p_basissize size of the Krylov subspace (zero determines the size by the number of eigenpairs)
+     * @return true if all eigenpairs are converged
+     **/
+    template<typename T> inline bool lanczos::eigen( const ublas::matrix<T>& p_matrix, ublas::vector<T>& p_eigval, ublas::matrix<T>& p_eigvec, const std::size_t& p_count, const lapack::spectrum& p_which, const T& p_tolerance, const std::size_t& p_restarts, const std::size_t& p_basissize )
+    {
+        if (p_matrix.size1() != p_matrix.size2())
+            throw exception::runtime(_("matrix must be square"));
+        
+        return eigen<T>( denseproduct<T>(p_matrix), p_matrix.size1(), p_eigval, p_eigvec, p_count, p_which, p_tolerance, p_restarts, p_basissize );
+    }
+    
+}}
+#endif
@@ -25,20 +25,33 @@
 #ifndef __MACHINELEARNING_TOOLS_LAPACK_HPP
 #define __MACHINELEARNING_TOOLS_LAPACK_HPP
 
+#include <cmath>
+#include <limits>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/vector_proxy.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/ublas/symmetric.hpp>
 #include <boost/numeric/bindings/blas.hpp>
+#include <boost/numeric/bindings/trans.hpp>
 #include <boost/numeric/bindings/ublas/vector.hpp>
 #include <boost/numeric/bindings/ublas/matrix.hpp>
+#include <boost/numeric/bindings/ublas/symmetric.hpp>
 #include <boost/numeric/bindings/lapack/driver/geev.hpp>
 #include <boost/numeric/bindings/lapack/driver/ggev.hpp>
 #include <boost/numeric/bindings/lapack/driver/gesv.hpp> 
 #include <boost/numeric/bindings/lapack/driver/gesvd.hpp>
+#include <boost/numeric/bindings/lapack/driver/gesdd.hpp>
+#include <boost/numeric/bindings/lapack/driver/syevr.hpp>
 #include <boost/numeric/bindings/lapack/computational/hseqr.hpp>
+#include <boost/numeric/bindings/lapack/computational/geqrf.hpp>
+#include <boost/numeric/bindings/lapack/computational/orgqr.hpp>
 
 
 #include "../errorhandling/exception.hpp"
 #include "language/language.h"
+#include "matrix.hpp"
+#include "rowblocks.hpp"
 
 
 namespace machinelearning { namespace tools {
@@ -47,6 +60,7 @@ namespace machinelearning { namespace tools {
     namespace ublas     = boost::numeric::ublas;
     namespace blas      = boost::numeric::bindings::blas;
     namespace linalg    = boost::numeric::bindings::lapack;
+    namespace bind      = boost::numeric::bindings;
     #endif
     
     
@@ -69,15 +83,34 @@ namespace machinelearning { namespace tools {
         
         public :
         
+            /** part of the spectrum of the symmetric eigen decomposition **/
+            enum spectrum
+            {
+                largest,
+                smallest
+            };
+        
+        
             template<typename T> static void eigen( const ublas::matrix<T>&, ublas::vector<T>&, ublas::matrix<T>&, const bool& = true );
+            template<typename T> static void eigensymmetric( const ublas::matrix<T>&, ublas::vector<T>&, ublas::matrix<T>&, const std::size_t& = 0, const spectrum& = largest );
             template<typename T> static void eigen( const ublas::matrix<T>&, const ublas::matrix<T>&, ublas::vector<T>&, ublas::matrix<T>&, const bool& = true );
             template<typename T> static void svd( const ublas::matrix<T>&, ublas::vector<T>&, ublas::matrix<T>&, ublas::matrix<T>&, const bool& = true );
+            template<typename T> static void randomizedsvd( const ublas::matrix<T>&, ublas::vector<T>&, ublas::matrix<T>&, ublas::matrix<T>&, const std::size_t&, const std::size_t& = 1, const std::size_t& = 10 );
+            template<typename T> static void randomizedsvd( const rowblocks<T>&, ublas::vector<T>&, ublas::matrix<T>&, const std::size_t&, const std::size_t& = 1, const std::size_t& = 10, const ublas::vector<T>& = ublas::vector<T>(), const std::size_t& = 4096 );
             template<typename T> static void solve( const ublas::matrix<T>&, const ublas::vector<T>&, ublas::vector<T>& );
             //template<typename T> static ublas::matrix<T> expm( const ublas::matrix<T>& );
             template<typename T> static ublas::vector<T> perronfrobenius( const ublas::matrix<T>&, const std::size_t& );
             template<typename T> static ublas::vector<T> perronfrobenius( const ublas::matrix<T>&, const std::size_t&, const ublas::vector<T>& );
             template<typename T> static ublas::matrix<T> unnormalizedGraphLaplacian( const ublas::matrix<T>& );
             template<typename T> static ublas::matrix<T> normalizedGraphLaplacian( const ublas::matrix<T>& );
+            template<typename T> static ublas::matrix<T> symmetricGraphLaplacian( const ublas::matrix<T>& );
+        
+        
+        private :
+        
+            template<typename T> static void orthonormalize( ublas::matrix<T>& );
+            template<typename T> static ublas::matrix<T> getRows( const rowblocks<T>&, const std::size_t&, const std::size_t&, const ublas::vector<T>& );
+            template<typename T> static void prodGram( const rowblocks<T>&, const ublas::matrix<T>&, ublas::matrix<T>&, ublas::matrix<T>&, const ublas::vector<T>&, const std::size_t& );
         
     };
 
@@ -166,6 +199,56 @@ namespace machinelearning { namespace tools {
     }
     
     
+    /** calculates from a symmetric NxN matrix the k largest or smallest eigenvalues and eigenvectors with
+     * the relatively robust representation (syevr). Only the upper triangle of the matrix is used and
+     * only the requested eigenvectors are calculated, so the call is much faster than the general
+     * eigen decomposition and needs only N x k memory for the eigenvectors
+     * @param p_matrix symmetric input matrix
+     * @param p_eigval blas vector for eigenvalues (largest first or smallest first) [initialisation is not needed]
+     * @param p_eigvec blas matrix for orthonormal eigenvectors (every column is a eigenvector) [initialisation is not needed]
+     * @param p_count number of eigenpairs (zero calculates all)
+     * @param p_which largest or smallest part of the spectrum
+     **/
+    template<typename T> inline void lapack::eigensymmetric( const ublas::matrix<T>& p_matrix, ublas::vector<T>& p_eigval, ublas::matrix<T>& p_eigvec, const std::size_t& p_count, const spectrum& p_which )
+    {
+        if (p_matrix.size1() != p_matrix.size2())
+            throw exception::runtime(_("matrix must be square"));
+        if (p_matrix.size1() == 0)
+            throw exception::runtime(_("matrix must not be empty"));
+        if (p_count > p_matrix.size1())
+            throw exception::runtime(_("number of eigenpairs must be less or equal than the matrix size"));
+        
+        const std::size_t l_size  = p_matrix.size1();
+        const std::size_t l_count = (p_count == 0) ? l_size : p_count;
+        
+        // copy matrix for LAPACK
+        ublas::matrix<T, ublas::column_major> l_matrix(p_matrix);
+        ublas::symmetric_adaptor< ublas::matrix<T, ublas::column_major>, ublas::upper > l_symmetric(l_matrix);
+        
+        // create result structures, LAPACK sorts the eigenvalues ascending and uses one-based indices
+        ublas::vector<T> l_eigval(l_size);
+        ublas::matrix<T, ublas::column_major> l_eigvec(l_size, l_count);
+        ublas::vector<fortran_int_t> l_support(2*l_count);
+        fortran_int_t l_found = 0;
+        
+        const fortran_int_t l_first = static_cast<fortran_int_t>( (p_which == largest) ? l_size-l_count+1 : 1 );
+        const fortran_int_t l_last  = static_cast<fortran_int_t>( (p_which == largest) ? l_size : l_count );
+        
+        if (linalg::syevr( 'V', (l_count == l_size) ? 'A' : 'I', l_symmetric, static_cast<T>(0), static_cast<T>(0), l_first, l_last, static_cast<T>(0), l_found, l_eigval, l_eigvec, l_support, linalg::optimal_workspace() ) != 0)
+            throw exception::runtime(_("symmetric eigen decomposition does not converge"));
+        
+        // copy the pairs, so that the first pair is the largest / smallest
+        p_eigval.resize(l_count, false);
+        p_eigvec.resize(l_size, l_count, false);
+        for(std::size_t i=0; i < l_count; ++i) {
+            const std::size_t l_idx = (p_which == largest) ? l_count-i-1 : i;
+            
+            p_eigval(i) = l_eigval(l_idx);
+            ublas::column(p_eigvec, i) = ublas::column(l_eigvec, l_idx);
+        }
+    }
+    
+    
     /** singular value decomposition
      * @param p_matrix input matrix
      * @param p_svdval blas vector for eigenvalues [initialisation is not needed]
@@ -205,6 +288,205 @@ namespace machinelearning { namespace tools {
     }
     
     
+    /** truncated singular value decomposition with a randomized range finder. The
+     * range of the matrix is approximated by a random subspace, that is improved
+     * by power iterations, so only k + oversampling vectors are stored. The left
+     * singular vectors are Q * U' with the left singular vectors U' of the small
+     * matrix B = Q^T * A, so they are orthonormal without a further pass over A
+     * @see Halko, Martinsson & Tropp, Finding Structure with Randomness, SIAM Review 53(2), 2011
+     * @param p_matrix input matrix
+     * @param p_svdval blas vector for the k largest singular values (largest first) [initialisation is not needed]
+     * @param p_svdvec1 blas matrix for the left singular vectors (every column is a vector) [initialisation is not needed]
+     * @param p_svdvec2 blas matrix for the right singular vectors (every column is a vector) [initialisation is not needed]
+     * @param p_count number of singular values
+     * @param p_iterations number of power iterations
+     * @param p_oversampling number of additional random vectors
+     **/
+    template<typename T> inline void lapack::randomizedsvd( const ublas::matrix<T>& p_matrix, ublas::vector<T>& p_svdval, ublas::matrix<T>& p_svdvec1, ublas::matrix<T>& p_svdvec2, const std::size_t& p_count, const std::size_t& p_iterations, const std::size_t& p_oversampling )
+    {
+        if ((p_matrix.size1() == 0) || (p_matrix.size2() == 0))
+            throw exception::runtime(_("matrix must not be empty"));
+        if ((p_count == 0) || (p_count > std::min(p_matrix.size1(), p_matrix.size2())))
+            throw exception::runtime(_("number of singular values must be greater than zero and less or equal than the matrix size"));
+        
+        const std::size_t l_sample = std::min( p_count+p_oversampling, std::min(p_matrix.size1(), p_matrix.size2()) );
+        
+        // sample the range of A with Q = orth(A * Omega) and improve it with Q = orth(A * orth(A^T * Q))
+        ublas::matrix<T> l_basis = tools::matrix::random<T>( p_matrix.size2(), l_sample, tools::random::normal );
+        ublas::matrix<T> l_range( p_matrix.size1(), l_sample );
+        
+        blas::gemm( static_cast<T>(1), p_matrix, l_basis, static_cast<T>(0), l_range );
+        orthonormalize( l_range );
+        
+        for(std::size_t n=0; n < p_iterations; ++n) {
+            blas::gemm( static_cast<T>(1), bind::trans(p_matrix), l_range, static_cast<T>(0), l_basis );
+            orthonormalize( l_basis );
+            
+            blas::gemm( static_cast<T>(1), p_matrix, l_basis, static_cast<T>(0), l_range );
+            orthonormalize( l_range );
+        }
+        
+        // B^T = A^T * Q = V * S * U'^T, so the left singular vectors of B^T are the right singular vectors of A
+        blas::gemm( static_cast<T>(1), bind::trans(p_matrix), l_range, static_cast<T>(0), l_basis );
+        
+        ublas::matrix<T, ublas::column_major> l_small( l_basis );
+        ublas::vector<T> l_svdval( l_sample );
+        ublas::matrix<T, ublas::column_major> l_svdvec1( p_matrix.size2(), l_sample );
+        ublas::matrix<T, ublas::column_major> l_svdvec2( l_sample, l_sample );
+        
+        if (linalg::gesdd( 'S', l_small, l_svdval, l_svdvec1, l_svdvec2, linalg::optimal_workspace() ) != 0)
+            throw exception::runtime(_("singular value decomposition does not converge"));
+        
+        p_svdval  = ublas::subrange( l_svdval, 0, p_count );
+        p_svdvec2 = ublas::subrange( l_svdvec1, 0, p_matrix.size2(), 0, p_count );
+        
+        // left singular vectors are Q * U'
+        const ublas::matrix<T> l_left = ublas::trans( ublas::subrange(l_svdvec2, 0, p_count, 0, l_sample) );
+        p_svdvec1.resize( p_matrix.size1(), p_count, false );
+        blas::gemm( static_cast<T>(1), l_range, l_left, static_cast<T>(0), p_svdvec1 );
+    }
+    
+    
+    /** truncated singular value decomposition with a randomized range finder of a data
+     * matrix, that is read in row blocks. Only the basis V of the row space is stored, the
+     * range Q = A * V * R^-1 is never held in memory: each pass over the data calculates
+     * the Gram matrix G = (A * V)^T * (A * V) and A^T * A * V together. The power
+     * iterations orthonormalize A^T * A * V with a QR decomposition and after the last pass
+     * B^T = A^T * Q = A^T * A * V * W * S^-1 is taken from the eigen decomposition
+     * G = W * S^2 * W^T. The data is read (iterations + 1) times, the memory is
+     * 2 * columns * (k + oversampling) and does not depend on the number of rows. Because the
+     * Gram matrix squares the singular values, directions of A * V with a singular value below
+     * sqrt(epsilon) of the largest one are treated as zero, and only the right singular vectors are returned
+     * @param p_data row blocks of the input matrix
+     * @param p_svdval blas vector for the k largest singular values (largest first) [initialisation is not needed]
+     * @param p_svdvec blas matrix for the right singular vectors (every column is a vector) [initialisation is not needed]
+     * @param p_count number of singular values
+     * @param p_iterations number of power iterations
+     * @param p_oversampling number of additional random vectors
+     * @param p_center vector, that is subtracted from every row (empty vector for no centering)
+     * @param p_blocksize number of rows, that are read at once
+     **/
+    template<typename T> inline void lapack::randomizedsvd( const rowblocks<T>& p_data, ublas::vector<T>& p_svdval, ublas::matrix<T>& p_svdvec, const std::size_t& p_count, const std::size_t& p_iterations, const std::size_t& p_oversampling, const ublas::vector<T>& p_center, const std::size_t& p_blocksize )
+    {
+        const std::size_t l_rows    = p_data.size1();
+        const std::size_t l_columns = p_data.size2();
+        
+        if ((l_rows == 0) || (l_columns == 0))
+            throw exception::runtime(_("matrix must not be empty"));
+        if ((p_count == 0) || (p_count > std::min(l_rows, l_columns)))
+            throw exception::runtime(_("number of singular values must be greater than zero and less or equal than the matrix size"));
+        if ((!p_center.empty()) && (p_center.size() != l_columns))
+            throw exception::runtime(_("center vector size must be equal to the number of columns"));
+        if (p_blocksize == 0)
+            throw exception::runtime(_("block size must be greater than zero"));
+        
+        const std::size_t l_sample = std::min( p_count+p_oversampling, std::min(l_rows, l_columns) );
+        
+        // sample the row space with V = orth(Omega) and improve it with V = orth(A^T * A * V)
+        ublas::matrix<T> l_basis = tools::matrix::random<T>( l_columns, l_sample, tools::random::normal );
+        ublas::matrix<T> l_gram;
+        ublas::matrix<T> l_normal;
+        
+        orthonormalize( l_basis );
+        prodGram( p_data, l_basis, l_gram, l_normal, p_center, p_blocksize );
+        
+        for(std::size_t n=0; n < p_iterations; ++n) {
+            l_basis = l_normal;
+            orthonormalize( l_basis );
+            prodGram( p_data, l_basis, l_gram, l_normal, p_center, p_blocksize );
+        }
+        
+        // G = W * S^2 * W^T, so Q = A * V * W * S^-1 and B^T = A^T * A * V * W * S^-1
+        ublas::vector<T> l_eigval;
+        ublas::matrix<T> l_eigvec;
+        eigensymmetric( l_gram, l_eigval, l_eigvec );
+        
+        const T l_tolerance = std::numeric_limits<T>::epsilon() * l_sample * l_eigval(0);
+        for(std::size_t i=0; i < l_sample; ++i)
+            if ((l_eigval(i) > l_tolerance) && (l_eigval(i) > 0))
+                ublas::column(l_eigvec, i) /= std::sqrt( l_eigval(i) );
+            else
+                ublas::column(l_eigvec, i) = ublas::zero_vector<T>( l_sample );
+        
+        // the left singular vectors of B^T are the right singular vectors of A
+        ublas::matrix<T, ublas::column_major> l_small( l_columns, l_sample );
+        blas::gemm( static_cast<T>(1), l_normal, l_eigvec, static_cast<T>(0), l_small );
+        
+        ublas::vector<T> l_svdval( l_sample );
+        ublas::matrix<T, ublas::column_major> l_svdvec1( l_columns, l_sample );
+        ublas::matrix<T, ublas::column_major> l_svdvec2( l_sample, l_sample );
+        
+        if (linalg::gesdd( 'S', l_small, l_svdval, l_svdvec1, l_svdvec2, linalg::optimal_workspace() ) != 0)
+            throw exception::runtime(_("singular value decomposition does not converge"));
+        
+        p_svdval = ublas::subrange( l_svdval, 0, p_count );
+        p_svdvec = ublas::subrange( l_svdvec1, 0, l_columns, 0, p_count );
+    }
+    
+    
+    /** orthonormalize the columns of a matrix with a QR decomposition
+     * @param p_matrix matrix (rows must be greater or equal than columns), that is replaced by Q
+     **/
+    template<typename T> inline void lapack::orthonormalize( ublas::matrix<T>& p_matrix )
+    {
+        // copy matrix for LAPACK
+        ublas::matrix<T, ublas::column_major> l_matrix(p_matrix);
+        ublas::vector<T> l_tau( l_matrix.size2() );
+        
+        if ((linalg::geqrf( l_matrix, l_tau, linalg::optimal_workspace() ) != 0) || (linalg::orgqr( l_matrix, l_tau, linalg::optimal_workspace() ) != 0))
+            throw exception::runtime(_("QR decomposition can not be calculated"));
+        
+        p_matrix = l_matrix;
+    }
+    
+    
+    /** reads a block of rows and subtracts the center vector
+     * @param p_data row blocks
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @param p_center center vector (empty vector for no centering)
+     * @return block matrix
+     **/
+    template<typename T> inline ublas::matrix<T> lapack::getRows( const rowblocks<T>& p_data, const std::size_t& p_row, const std::size_t& p_rows, const ublas::vector<T>& p_center )
+    {
+        ublas::matrix<T> l_block = p_data.getRows( p_row, p_rows );
+        if (l_block.size2() != p_data.size2())
+            throw exception::runtime(_("number of columns of the row block is not equal to the matrix"));
+        
+        if (!p_center.empty())
+            for(std::size_t i=0; i < l_block.size1(); ++i)
+                ublas::row(l_block, i) -= p_center;
+        
+        return l_block;
+    }
+    
+    
+    /** multiplies the row blocks with a matrix B and calculates in the same pass the Gram
+     * matrix (A * B)^T * (A * B) and the product A^T * A * B, so A * B is only held block by block
+     * @param p_data row blocks of A
+     * @param p_matrix matrix B
+     * @param p_gram result Gram matrix with the size columns(B) x columns(B)
+     * @param p_normal result matrix A^T * A * B with the size columns(A) x columns(B)
+     * @param p_center center vector (empty vector for no centering)
+     * @param p_blocksize number of rows, that are read at once
+     **/
+    template<typename T> inline void lapack::prodGram( const rowblocks<T>& p_data, const ublas::matrix<T>& p_matrix, ublas::matrix<T>& p_gram, ublas::matrix<T>& p_normal, const ublas::vector<T>& p_center, const std::size_t& p_blocksize )
+    {
+        p_gram   = ublas::zero_matrix<T>( p_matrix.size2(), p_matrix.size2() );
+        p_normal = ublas::zero_matrix<T>( p_data.size2(), p_matrix.size2() );
+        ublas::matrix<T> l_product;
+        
+        for(std::size_t i=0; i < p_data.size1(); i += p_blocksize) {
+            const ublas::matrix<T> l_block = getRows( p_data, i, p_blocksize, p_center );
+            
+            l_product.resize( l_block.size1(), p_matrix.size2(), false );
+            blas::gemm( static_cast<T>(1), l_block, p_matrix, static_cast<T>(0), l_product );
+            blas::gemm( static_cast<T>(1), bind::trans(l_product), l_product, static_cast<T>(1), p_gram );
+            blas::gemm( static_cast<T>(1), bind::trans(l_block), l_product, static_cast<T>(1), p_normal );
+        }
+    }
+    
+    
     /** solve a lineare equation system like Ax=b
      * @param p_matrix left side matrix
      * @param p_vec right side vector
@@ -303,6 +585,31 @@ namespace machinelearning { namespace tools {
         // degree matrix is a diagnomal matrix, so invert the elements and do a matrix product
         return ublas::prod( matrix::invert(l_degree), l_unnormlaplacian );
     }
+    
+    
+    /** creates the symmetric normalized graph laplacian I - D^-0.5 * A * D^-0.5 of a distance matrix. The
+     * eigenvalues are equal to the normalized graph laplacian and an eigenvector v of it is D^-0.5 * u for the
+     * eigenvector u of the symmetric laplacian, so the symmetric eigen decomposition can be used
+     * @param p_adjacency adjacency matrix
+     * @return symmetric normalized graph laplacian
+     **/
+    template<typename T> inline ublas::matrix<T> lapack::symmetricGraphLaplacian( const ublas::matrix<T>& p_adjacency )
+    {
+        if (p_adjacency.size1() != p_adjacency.size2())
+            throw exception::runtime(_("matrix must be square"));
+        
+        // inverted square root of the vertex degree, a vertex without edges is set to zero
+        ublas::vector<T> l_vertexdegree = matrix::sum(p_adjacency);
+        for(std::size_t i=0; i < l_vertexdegree.size(); ++i)
+            l_vertexdegree(i) = (l_vertexdegree(i) > 0) ? static_cast<T>(1) / std::sqrt(l_vertexdegree(i)) : 0;
+        
+        ublas::matrix<T> l_laplacian( p_adjacency.size1(), p_adjacency.size2() );
+        for(std::size_t i=0; i < l_laplacian.size1(); ++i)
+            for(std::size_t j=0; j < l_laplacian.size2(); ++j)
+                l_laplacian(i,j) = ((i==j) ? static_cast<T>(1) : static_cast<T>(0)) - l_vertexdegree(i) * p_adjacency(i,j) * l_vertexdegree(j);
+        
+        return l_laplacian;
+    }
 
 }}
 #endif
@@ -66,6 +66,7 @@ namespace machinelearning { namespace tools {
             template<typename T> static ublas::matrix<T> pow( const ublas::matrix<T>&, const T& );
             template<typename T> static ublas::vector<T> max( const ublas::matrix<T>&, const rowtype& = row );
             template<typename T> static ublas::vector<T> min( const ublas::matrix<T>&, const rowtype& = row );
+            template<typename T> static ublas::indirect_array<> argmin( const ublas::matrix<T>&, const rowtype& = row );
             template<typename T> static ublas::vector<T> mean( const ublas::matrix<T>&, const rowtype& = row );
             template<typename T> static ublas::vector<T> variance( const ublas::matrix<T>&, const rowtype& = row );
             template<typename T> static ublas::vector<T> sum( const ublas::matrix<T>&, const rowtype& = row );
@@ -191,6 +192,33 @@ namespace machinelearning { namespace tools {
         
         return l_min;
     }
+    
+    
+    /** creates an index array in which every element hold the position of the minimum of the row / column elements of the matrix
+     * @param p_matrix blas matrix
+     * @param p_which row / column option (default row)
+     * @return index array with the positions of the minimum elements
+     **/
+    template<typename T> inline ublas::indirect_array<> matrix::argmin( const ublas::matrix<T>& p_matrix, const rowtype& p_which )
+    {
+        ublas::indirect_array<> l_idx( (p_which==row) ? p_matrix.size1() : p_matrix.size2() );
+        
+        switch (p_which) {                
+            case row :
+                #pragma omp parallel for shared(l_idx)
+                for(std::size_t i=0; i < p_matrix.size1(); ++i)
+                    l_idx(i) = tools::vector::argmin( ublas::row(p_matrix, i) );
+                break;
+                
+            case column :
+                #pragma omp parallel for shared(l_idx)
+                for(std::size_t i=0; i < p_matrix.size2(); ++i)
+                    l_idx(i) = tools::vector::argmin( ublas::column(p_matrix, i) );
+                break;
+        }
+        
+        return l_idx;
+    }
 
     
     /** calulates from a blas matrix the mean values on the rows or columns
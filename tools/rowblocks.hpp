@@ -0,0 +1,233 @@
+/** 
+ @cond
+ ############################################################################
+ # LGPL License                                                             #
+ #                                                                          #
+ # This file is part of the Machine Learning Framework.                     #
+ # Copyright (c) 2010-2012, Philipp Kraus, <philipp.kraus@flashpixx.de>     #
+ # This program is free software: you can redistribute it and/or modify     #
+ # it under the terms of the GNU Lesser General Public License as           #
+ # published by the Free Software Foundation, either version 3 of the       #
+ # License, or (at your option) any later version.                          #
+ #                                                                          #
+ # This program is distributed in the hope that it will be useful,          #
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of           #
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            #
+ # GNU Lesser General Public License for more details.                      #
+ #                                                                          #
+ # You should have received a copy of the GNU Lesser General Public License #
+ # along with this program. If not, see <http://www.gnu.org/licenses/>.     #
+ ############################################################################
+ @endcond
+ **/
+
+
+
+#ifndef __MACHINELEARNING_TOOLS_ROWBLOCKS_HPP
+#define __MACHINELEARNING_TOOLS_ROWBLOCKS_HPP
+
+#include <algorithm>
+#include <string>
+
+#include <boost/static_assert.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+
+#include "../errorhandling/exception.hpp"
+#include "language/language.h"
+
+#if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+#include "files/hdf.hpp"
+#endif
+
+
+
+namespace machinelearning { namespace tools {
+    
+    #ifndef SWIG
+    namespace ublas = boost::numeric::ublas;
+    #endif
+    
+    
+    /** abstract class for a data matrix (every row is a datapoint), which
+     * is not held in memory. The rows are read in blocks, so algorithms,
+     * that pass over the data, can use large datasets
+     **/
+    template<typename T> class rowblocks
+    {
+        #ifndef SWIG
+        BOOST_STATIC_ASSERT( !boost::is_integral<T>::value );
+        #endif
+        
+        
+        public :
+            
+            /** returns the number of rows **/
+            virtual std::size_t size1( void ) const = 0;
+            
+            /** returns the number of columns **/
+            virtual std::size_t size2( void ) const = 0;
+            
+            /** returns a block of rows (start row, number of rows) **/
+            virtual ublas::matrix<T> getRows( const std::size_t&, const std::size_t& ) const = 0;
+            
+            virtual ~rowblocks( void ) {};
+        
+    };
+    
+    
+    
+    /** row blocks of a matrix, that is held in memory **/
+    template<typename T> class matrixrowblocks : public rowblocks<T>
+    {
+        
+        public :
+            
+            matrixrowblocks( const ublas::matrix<T>& );
+            std::size_t size1( void ) const;
+            std::size_t size2( void ) const;
+            ublas::matrix<T> getRows( const std::size_t&, const std::size_t& ) const;
+        
+        
+        private :
+            
+            /** reference to the matrix **/
+            const ublas::matrix<T>& m_matrix;
+        
+    };
+    
+    
+    
+    #if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+    
+    /** row blocks of a matrix dataset within a HDF file. Only the
+     * selected rows are read from the file
+     **/
+    template<typename T> class hdfrowblocks : public rowblocks<T>
+    {
+        
+        public :
+            
+            hdfrowblocks( const files::hdf&, const std::string&, const files::hdf::datatype& = files::hdf::NATIVE_DOUBLE );
+            std::size_t size1( void ) const;
+            std::size_t size2( void ) const;
+            ublas::matrix<T> getRows( const std::size_t&, const std::size_t& ) const;
+        
+        
+        private :
+            
+            /** HDF file reference **/
+            const files::hdf& m_file;
+            /** dataset path **/
+            const std::string m_path;
+            /** datatype for reading **/
+            const files::hdf::datatype m_datatype;
+            /** number of rows **/
+            std::size_t m_rows;
+            /** number of columns **/
+            std::size_t m_columns;
+        
+    };
+    
+    #endif
+    
+    
+    
+    
+    /** constructor
+     * @param p_matrix data matrix (the matrix must exist during the lifetime of the object)
+     **/
+    template<typename T> inline matrixrowblocks<T>::matrixrowblocks( const ublas::matrix<T>& p_matrix ) :
+        m_matrix( p_matrix )
+    {}
+    
+    
+    /** returns the number of rows
+     * @return number of rows
+     **/
+    template<typename T> inline std::size_t matrixrowblocks<T>::size1( void ) const
+    {
+        return m_matrix.size1();
+    }
+    
+    
+    /** returns the number of columns
+     * @return number of columns
+     **/
+    template<typename T> inline std::size_t matrixrowblocks<T>::size2( void ) const
+    {
+        return m_matrix.size2();
+    }
+    
+    
+    /** returns a block of rows, the block is cut at the end of the matrix
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @return block matrix
+     **/
+    template<typename T> inline ublas::matrix<T> matrixrowblocks<T>::getRows( const std::size_t& p_row, const std::size_t& p_rows ) const
+    {
+        if (p_row >= m_matrix.size1())
+            throw exception::runtime(_("row index is out of range"), *this);
+        
+        return ublas::subrange( m_matrix, p_row, std::min(p_row+p_rows, m_matrix.size1()), 0, m_matrix.size2() );
+    }
+    
+    
+    
+    
+    #if defined(MACHINELEARNING_FILES) && defined(MACHINELEARNING_FILES_HDF)
+    
+    /** constructor
+     * @param p_file HDF object (the object must exist during the lifetime of the row blocks)
+     * @param p_path dataset path
+     * @param p_datatype datatype for reading
+     **/
+    template<typename T> inline hdfrowblocks<T>::hdfrowblocks( const files::hdf& p_file, const std::string& p_path, const files::hdf::datatype& p_datatype ) :
+        m_file( p_file ),
+        m_path( p_path ),
+        m_datatype( p_datatype ),
+        m_rows( 0 ),
+        m_columns( 0 )
+    {
+        const std::pair<std::size_t, std::size_t> l_size = m_file.getMatrixSize( m_path );
+        m_rows    = l_size.first;
+        m_columns = l_size.second;
+    }
+    
+    
+    /** returns the number of rows
+     * @return number of rows
+     **/
+    template<typename T> inline std::size_t hdfrowblocks<T>::size1( void ) const
+    {
+        return m_rows;
+    }
+    
+    
+    /** returns the number of columns
+     * @return number of columns
+     **/
+    template<typename T> inline std::size_t hdfrowblocks<T>::size2( void ) const
+    {
+        return m_columns;
+    }
+    
+    
+    /** returns a block of rows, the block is cut at the end of the dataset
+     * @param p_row start row
+     * @param p_rows number of rows
+     * @return block matrix
+     **/
+    template<typename T> inline ublas::matrix<T> hdfrowblocks<T>::getRows( const std::size_t& p_row, const std::size_t& p_rows ) const
+    {
+        if (p_row >= m_rows)
+            throw exception::runtime(_("row index is out of range"), *this);
+        
+        return m_file.readBlasMatrix<T>( m_path, m_datatype, p_row, p_rows );
+    }
+    
+    #endif
+    
+}}
+#endif
@@ -39,7 +39,9 @@ namespace machinelearning {
 #include "function.hpp"
 #include "matrix.hpp"
 #include "vector.hpp"
+#include "rowblocks.hpp"
 #include "lapack.hpp"
+#include "lanczos.hpp"
 #include "logger.hpp"
 #include "sources/sources.h"
 #include "files/files.h"
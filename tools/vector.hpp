@@ -95,6 +95,10 @@ namespace machinelearning { namespace tools {
             template<typename T> static ublas::vector<std::size_t> rank( ublas::vector<T>& );
             template<typename T> static ublas::vector<std::size_t> rankIndexVector( ublas::vector<T>& );
             template<typename T> static ublas::indirect_array<> rankIndex( ublas::vector<T>& );
+            template<typename T> static ublas::indirect_array<> rankIndex( ublas::vector<T>&, const std::size_t& );
+            #ifndef SWIG
+            template<typename E> static std::size_t argmin( const ublas::vector_expression<E>& );
+            #endif
             template<typename T> static ublas::vector<T> setNumericalZero( const ublas::vector<T>&, const T& = 0 );
             #ifndef SWIG
             static ublas::indirect_array<> toIndirectArray( const std::vector<std::size_t>& );
@@ -293,6 +297,48 @@ namespace machinelearning { namespace tools {
     }
     
     
+    /** returns the index array of the k smallest elements, the first element is the
+     * smallest, second the next greater element and so on. Only the first k elements
+     * are sorted, so the call runs in O(n + k log k) and not O(n log n) like the full ranking
+     * @param p_vec vector with elements
+     * @param p_k number of smallest elements
+     * @return index array with k elements
+     **/
+    template<typename T> inline ublas::indirect_array<> vector::rankIndex( ublas::vector<T>& p_vec, const std::size_t& p_k )
+    {
+        if (p_k > p_vec.size())
+            throw exception::runtime(_("number of elements must be less or equal than vector size"));
+        
+        std::vector<std::size_t> l_temp(boost::counting_iterator<std::size_t>(0), boost::counting_iterator<std::size_t>(p_vec.size()));
+        if (p_k < l_temp.size())
+            std::nth_element( l_temp.begin(), l_temp.begin()+p_k, l_temp.end(), lam::var(p_vec)[lam::_1] < lam::var(p_vec)[lam::_2]);
+        std::sort( l_temp.begin(), l_temp.begin()+p_k, lam::var(p_vec)[lam::_1] < lam::var(p_vec)[lam::_2]);
+        l_temp.resize(p_k);
+        
+        return toIndirectArray(l_temp);
+    }
+    
+    
+    /** returns the index of the smallest element. The vector expression is read directly,
+     * so row and column proxies can be passed without copying them into a vector
+     * @param p_vec vector expression
+     * @return index of the smallest element (first index on equal values)
+     **/
+    template<typename E> inline std::size_t vector::argmin( const ublas::vector_expression<E>& p_vec )
+    {
+        const E& l_vec = p_vec();
+        if (l_vec.size() == 0)
+            throw exception::runtime(_("vector must have one or more elements"));
+        
+        std::size_t l_idx = 0;
+        for(std::size_t i=1; i < l_vec.size(); ++i)
+            if (l_vec(i) < l_vec(l_idx))
+                l_idx = i;
+        
+        return l_idx;
+    }
+    
+    
     /** changes numerical zero / datatype limit to a fixed value
      * @param p_vec input vector
      * @param p_val fixed vakue